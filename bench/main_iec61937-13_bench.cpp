@@ -0,0 +1,1367 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// system includes
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// project includes
+#include "iec61937_dec.h"
+#include "iec61937_enc.h"
+#include "mhas_generator.h"
+#include "perf_counters.h"
+
+/*
+ * Measures the throughput of the public encoder and decoder API on synthetic MPEG-H frames, so no
+ * input files or external libraries are needed. Every combination of rate factor, IEC frame length
+ * and MPEG-H frame size distribution is encoded with iec61937_encode_process(),
+ * iec61937_encode_process_batch() and iec61937_encode_process_parallel() and decoded with several
+ * feed chunk sizes. Results are printed as CSV:
+ *   benchmark,api,rate_factor,frame_length,au_sizes,chunk_size,num_aus,stream_bytes,ns_per_au,
+ *   mb_per_s,aus_per_s
+ * mb_per_s refers to the IEC61937-13 stream in both directions, chunk_size is 0 for the encoder.
+ *
+ * With -v every configuration is checked before it is measured: the MPEG-H frames have to survive
+ * the encoder/decoder round trip bit-exact with consistent PCM offsets (for both packing policies,
+ * all encoder APIs and a 32-bit PCM container), and the decoder has to resync after corruption of
+ * the stream. With -b the throughput is compared to a previous CSV output; a result which is
+ * slower than the baseline by more than the tolerance (-t) counts as a regression if it stays
+ * slower when measured again (for up to MAX_REMEASURE_SECONDS); the baseline has to be recorded
+ * on the same machine. The exit code is non-zero if a check fails, a regression is found or the
+ * baseline does not match any result.
+ *
+ * With -p the throughput measurement is replaced by hardware performance counters, which are read
+ * around every API call so the operations are separated: encode (iec61937_encode_process()), feed
+ * (iec61937_decode_feed()), extract (iec61937_decode_process() on the IEC61937-13 stream) and sync
+ * (iec61937_decode_process() on noise without sync preamble, i.e. the sync search alone). The
+ * results are printed as CSV:
+ *   operation,rate_factor,frame_length,au_sizes,chunk_size,calls,bytes,ns_per_byte,
+ *   cycles_per_byte,instructions_per_byte,cache_misses_per_call,dtlb_misses_per_call,
+ *   branch_misses_per_call
+ * bytes are the IEC61937-13 stream bytes written or consumed by the operation. Counters which the
+ * system does not provide (e.g. in virtual machines and containers) are printed as n/a.
+ *
+ * With -l the end-to-end latency of every MPEG-H frame through the encoder, a simulated link and
+ * the decoder is measured with the default and the low latency encoder (see measureLatency()).
+ * The IEC frame length 768 is measured in addition, where one MPEG-H frame can complete several
+ * IEC frames.
+ * The percentiles are printed in audio samples and in microseconds as CSV:
+ *   mode,rate_factor,frame_length,au_sizes,num_aus,max_latency,samples_p50,samples_p99,
+ *   samples_p999,samples_max,us_p50,us_p99,us_p999,us_max
+ * max_latency is the worst-case latency reported by iec61937_encode_get_max_latency().
+ */
+
+// Each measurement is repeated and the fastest run is reported to suppress system noise.
+#define NUM_RUNS 5
+
+// A measurement which is a regression compared to the baseline is repeated for up to this time in
+// seconds, so a transient slowdown of the machine is not reported as a regression.
+#define MAX_REMEASURE_SECONDS 2.0
+
+// Duration of the synthetic MPEG-H frames in audio samples.
+#define AU_DURATION 1024
+
+// Default size of the IEC61937-13 stream of one configuration.
+#define DEFAULT_STREAM_BYTES (4 * 1024 * 1024)
+
+// Largest chunk which the decoder accepts after all complete IEC frames have been processed.
+#define MAX_FEED_CHUNK_SIZE (WORKBUFFER_SIZE_BYTES - 2 * MAX_IEC61937_FRAME_SIZE_BYTES)
+
+// Size limit of the MPEG-H frames which span several IEC frames.
+#define MAX_SPAN_AU_SIZE 60000
+
+// Default tolerance of the throughput compared to the baseline.
+#define DEFAULT_TOLERANCE 0.4
+
+// Sample rate which converts the simulated link of the -l mode into wall time.
+#define LATENCY_SAMPLE_RATE 48000
+
+enum EAuSizes {
+  AU_SIZES_SMALL,
+  AU_SIZES_CBR,
+  AU_SIZES_VBR,
+  AU_SIZES_IPF,
+  AU_SIZES_SPAN,
+  AU_SIZES_MHAS
+};
+
+static const char* auSizesName(EAuSizes auSizes) {
+  switch (auSizes) {
+    case AU_SIZES_SMALL:
+      return "small";
+    case AU_SIZES_CBR:
+      return "cbr";
+    case AU_SIZES_VBR:
+      return "vbr";
+    case AU_SIZES_IPF:
+      return "ipf";
+    case AU_SIZES_SPAN:
+      return "span";
+    case AU_SIZES_MHAS:
+      return "mhas";
+  }
+  return "unknown";
+}
+
+struct SBenchConfig {
+  uint8_t rateFactor;
+  uint32_t frameLength;
+  EAuSizes auSizes;
+};
+
+struct SBenchInput {
+  std::vector<std::vector<uint8_t>> frames;
+  std::vector<IEC61937_ENC_AU> aus;
+  uint64_t auBytes;
+  std::vector<uint8_t> stream;
+  uint32_t frameSize;       /* IEC frame size of the stream */
+  uint32_t payloadCapacity; /* payload bytes of an IEC frame */
+};
+
+// MPEG-H frame as obtained by a player from the decoder.
+struct SDecodedAu {
+  std::vector<uint8_t> data;
+  int64_t pts;
+};
+
+// Throughput (mb_per_s) of a previous run, indexed by the first six CSV columns.
+static std::map<std::string, double> g_baseline;
+static bool g_useBaseline = false;
+static double g_tolerance = DEFAULT_TOLERANCE;
+static uint32_t g_numRegressions = 0;
+static uint32_t g_numBaselineMatches = 0; /* results which have been compared to the baseline */
+
+// Small deterministic generator, so all runs and machines measure the same input.
+static uint32_t nextRandom(uint32_t& state) {
+  state = state * 1664525u + 1013904223u;
+  return state >> 8;
+}
+
+static HANDLE_IEC61937_ENCODER openEncoder(
+    const SBenchConfig& config, IECENC_PACKING packing = IECENC_PACKING_GREEDY,
+    IEC61937_PCM_FORMAT outputFormat = IEC61937_PCM_FORMAT_S16_BE, bool lowLatency = false,
+    uint32_t maxAuSize = 0) {
+  IEC61937_ENC_CONFIG encoderConfig;
+  iec61937_encode_config_init(&encoderConfig);
+  encoderConfig.rateFactor = config.rateFactor;
+  encoderConfig.audioFrameLength = config.frameLength;
+  encoderConfig.maxAuSize = maxAuSize;
+  encoderConfig.packing = packing;
+  encoderConfig.outputFormat = outputFormat;
+  encoderConfig.lowLatency = lowLatency;
+  return iec61937_encode_open_config(&encoderConfig);
+}
+
+// Encodes all frames with iec61937_encode_process() and flushes the encoder. Returns the number of
+// bytes written into output or 0 on error.
+static uint64_t encodeStream(HANDLE_IEC61937_ENCODER encoder, const SBenchInput& input,
+                             std::vector<uint8_t>& output) {
+  uint64_t written = 0;
+  uint32_t frameSize = iec61937_encode_get_frame_size(encoder);
+  for (const IEC61937_ENC_AU& au : input.aus) {
+    bool processed = false;
+    while (!processed) {
+      if (output.size() - written < frameSize) {
+        return 0;
+      }
+      uint32_t length = frameSize;
+      if (iec61937_encode_process(encoder, au.data, au.length, &processed, au.duration,
+                                  output.data() + written, &length) != IECENC_OK) {
+        return 0;
+      }
+      written += length;
+    }
+  }
+  while (true) {
+    if (output.size() - written < frameSize) {
+      return 0;
+    }
+    uint32_t length = frameSize;
+    if (iec61937_encode_flush(encoder, output.data() + written, &length) != IECENC_OK) {
+      return 0;
+    }
+    if (length == 0) {
+      break;
+    }
+    written += length;
+  }
+  return written;
+}
+
+// Encodes all frames with iec61937_encode_process_batch() or iec61937_encode_process_parallel().
+static uint64_t encodeStreamBatch(HANDLE_IEC61937_ENCODER encoder, const SBenchInput& input,
+                                  std::vector<uint8_t>& output, bool parallel) {
+  uint64_t written = 0;
+  uint32_t frameSize = iec61937_encode_get_frame_size(encoder);
+  uint32_t numAusConsumed = 0;
+  while (numAusConsumed < input.aus.size()) {
+    uint64_t capacity = std::min<uint64_t>(output.size() - written, UINT32_MAX / 2);
+    uint32_t consumed = 0;
+    uint32_t numBursts = UINT32_MAX;
+    IECENC_RESULT err;
+    if (parallel) {
+      err = iec61937_encode_process_parallel(
+          encoder, input.aus.data() + numAusConsumed, input.aus.size() - numAusConsumed, &consumed,
+          output.data() + written, (uint32_t)capacity, NULL, &numBursts, 0);
+    } else {
+      err = iec61937_encode_process_batch(
+          encoder, input.aus.data() + numAusConsumed, input.aus.size() - numAusConsumed, &consumed,
+          output.data() + written, (uint32_t)capacity, NULL, &numBursts);
+    }
+    if (err != IECENC_OK || (consumed == 0 && numBursts == 0)) {
+      return 0;
+    }
+    numAusConsumed += consumed;
+    written += (uint64_t)numBursts * frameSize;
+  }
+  while (true) {
+    if (output.size() - written < frameSize) {
+      return 0;
+    }
+    uint32_t length = frameSize;
+    if (iec61937_encode_flush(encoder, output.data() + written, &length) != IECENC_OK) {
+      return 0;
+    }
+    if (length == 0) {
+      break;
+    }
+    written += length;
+  }
+  return written;
+}
+
+// Decodes the stream fed in chunks of chunkSize bytes. Returns the number of decoded MPEG-H frames
+// and their total size in auBytes or -1 on error.
+static int64_t decodeStream(HANDLE_IEC61937_DECODER decoder, const std::vector<uint8_t>& stream,
+                            uint32_t chunkSize, std::vector<uint8_t>& auBuffer,
+                            uint64_t& auBytes) {
+  int64_t numAus = 0;
+  auBytes = 0;
+  size_t position = 0;
+  while (position < stream.size()) {
+    uint32_t length = (uint32_t)std::min<size_t>(chunkSize, stream.size() - position);
+    if (iec61937_decode_feed(decoder, stream.data() + position, length) != IECDEC_OK) {
+      return -1;
+    }
+    position += length;
+
+    while (true) {
+      uint32_t auLength = (uint32_t)auBuffer.size();
+      int32_t pcmOffset = 0;
+      uint32_t iecFrameLength = 0;
+      bool iecFrameProcessed = false;
+      IECDEC_RESULT err = iec61937_decode_process(decoder, auBuffer.data(), &auLength, &pcmOffset,
+                                                  &iecFrameLength, &iecFrameProcessed);
+      if (err == IECDEC_FEED_MORE_DATA) {
+        break;
+      }
+      if (err != IECDEC_OK) {
+        return -1;
+      }
+      if (auLength > 0) {
+        numAus++;
+        auBytes += auLength;
+      }
+    }
+  }
+  return numAus;
+}
+
+// Creates the MPEG-H frames for one configuration and the IEC61937-13 stream used as decoder
+// input. The frame sizes are relative to the capacity of an IEC frame, so every configuration
+// uses the same share of its bit rate. The "mhas" frames are MHAS packet sequences of the MHAS
+// generator instead of random bytes.
+static bool createInput(const SBenchConfig& config, uint64_t streamBytes, SBenchInput& input) {
+  HANDLE_IEC61937_ENCODER encoder = openEncoder(config);
+  if (encoder == NULL) {
+    return false;
+  }
+  uint32_t frameSize = iec61937_encode_get_frame_size(encoder);
+  // IEC frames shorter than an MPEG-H frame carry at most one MPEG-H frame
+  uint32_t ausPerFrame = std::max<uint32_t>(1, config.frameLength / AU_DURATION);
+  uint32_t payloadHeaderSize = config.rateFactor == 1 ? 6 : 8;
+  uint32_t payloadCapacity = frameSize - 16 - (ausPerFrame + 1) * payloadHeaderSize;
+  uint32_t capacity = payloadCapacity / ausPerFrame;
+  uint64_t numAus = std::max<uint64_t>(16, streamBytes / frameSize * ausPerFrame);
+  input.frameSize = frameSize;
+  input.payloadCapacity = payloadCapacity;
+
+  uint32_t state = 0x1EC61937u + config.rateFactor * 31 + config.frameLength + config.auSizes;
+  HANDLE_MHAS_GENERATOR generator = NULL;
+  if (config.auSizes == AU_SIZES_MHAS) {
+    // MHAS packets with exponentially distributed sizes and RAP frames of twice the size
+    MHAS_GEN_CONFIG generatorConfig;
+    mhas_generator_config_init(&generatorConfig);
+    generatorConfig.bitrate = (uint32_t)((uint64_t)capacity * 3 / 10 * 8 * 48000 / AU_DURATION);
+    generatorConfig.sizes = MHAS_GEN_SIZES_EXPONENTIAL;
+    generatorConfig.maxAuSize = capacity * 9 / 10;
+    generatorConfig.rapSizeFactor = 200;
+    generatorConfig.frameDurations[0] = AU_DURATION;
+    generatorConfig.seed = state;
+    generator = mhas_generator_open(&generatorConfig);
+    if (generator == NULL) {
+      iec61937_encode_close(encoder);
+      return false;
+    }
+  }
+  input.frames.resize(numAus);
+  input.aus.resize(numAus);
+  input.auBytes = 0;
+  for (uint64_t i = 0; i < numAus; i++) {
+    uint32_t length = 0;
+    switch (config.auSizes) {
+      case AU_SIZES_SMALL:
+        length = 64;
+        break;
+      case AU_SIZES_CBR:
+        length = capacity / 2;
+        break;
+      case AU_SIZES_VBR:
+        length = capacity / 20 + nextRandom(state) % (capacity * 9 / 10);
+        break;
+      case AU_SIZES_IPF:
+        length = i % 32 == 0 ? capacity * 9 / 10 : capacity * 3 / 10;
+        break;
+      case AU_SIZES_SPAN:
+        // the last frame is completed by an IEC frame without payload headers when flushing
+        length = i % 8 == 0 || i == numAus - 1
+                     ? std::min<uint32_t>(capacity * 3 / 2 + 3, MAX_SPAN_AU_SIZE)
+                     : capacity * 3 / 10;
+        break;
+      case AU_SIZES_MHAS: {
+        input.frames[i].resize(MHAS_MAX_AU_SIZE);
+        length = MHAS_MAX_AU_SIZE;
+        uint32_t duration = 0;
+        bool isRap = false;
+        mhas_generator_process(generator, input.frames[i].data(), &length, &duration, &isRap);
+        break;
+      }
+    }
+    input.frames[i].resize(length);
+    for (uint32_t k = 0; k < length && generator == NULL; k++) {
+      input.frames[i][k] = (uint8_t)nextRandom(state);
+    }
+    input.aus[i].data = input.frames[i].data();
+    input.aus[i].length = length;
+    input.aus[i].duration = AU_DURATION;
+    input.auBytes += length;
+  }
+
+  mhas_generator_close(generator);
+
+  uint64_t numIecFrames = std::max<uint64_t>(
+      numAus, (numAus * AU_DURATION + config.frameLength - 1) / config.frameLength);
+  input.stream.resize((numIecFrames + 4) * frameSize);
+  uint64_t written = encodeStream(encoder, input, input.stream);
+  iec61937_encode_close(encoder);
+  input.stream.resize(written);
+  return written > 0;
+}
+
+// Returns the CSV prefix of a throughput result, which is the key of its baseline.
+static std::string resultKey(const char* benchmark, const char* api, const SBenchConfig& config,
+                             uint32_t chunkSize) {
+  char key[128];
+  snprintf(key, sizeof(key), "%s,%s,%u,%u,%s,%u", benchmark, api, config.rateFactor,
+           config.frameLength, auSizesName(config.auSizes), chunkSize);
+  return key;
+}
+
+// Returns true if another run is needed: NUM_RUNS runs are always measured, further runs for up
+// to MAX_REMEASURE_SECONDS as long as the fastest one is slower than the baseline allows.
+static bool needsRun(const std::string& key, uint64_t streamBytes, uint32_t run, double seconds,
+                     std::chrono::steady_clock::time_point start) {
+  if (run < NUM_RUNS) {
+    return true;
+  }
+  std::map<std::string, double>::const_iterator baseline = g_baseline.find(key);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() < MAX_REMEASURE_SECONDS && baseline != g_baseline.end() &&
+         streamBytes / seconds / 1e6 < baseline->second * (1.0 - g_tolerance);
+}
+
+static void printResult(const char* benchmark, const char* api, const SBenchConfig& config,
+                        uint32_t chunkSize, uint64_t numAus, uint64_t streamBytes,
+                        double seconds) {
+  std::string keyString = resultKey(benchmark, api, config, chunkSize);
+  const char* key = keyString.c_str();
+  double mbPerSecond = streamBytes / seconds / 1e6;
+  printf("%s,%llu,%llu,%.1f,%.1f,%.1f\n", key, (unsigned long long)numAus,
+         (unsigned long long)streamBytes, seconds * 1e9 / numAus, mbPerSecond, numAus / seconds);
+
+  std::map<std::string, double>::const_iterator baseline = g_baseline.find(key);
+  if (baseline != g_baseline.end()) {
+    g_numBaselineMatches++;
+  }
+  if (baseline != g_baseline.end() && mbPerSecond < baseline->second * (1.0 - g_tolerance)) {
+    fprintf(stderr, "regression,%s: %.1f MB/s, baseline %.1f MB/s\n", key, mbPerSecond,
+            baseline->second);
+    g_numRegressions++;
+  }
+}
+
+// Reads the mb_per_s column of a previous CSV output. Fails for lines which are not throughput
+// results, e.g. of a -p or -l output, instead of comparing nothing.
+static bool readBaseline(const char* filename) {
+  std::ifstream file(filename);
+  if (!file) {
+    return false;
+  }
+  std::string line;
+  uint32_t lineNumber = 0;
+  while (std::getline(file, line)) {
+    lineNumber++;
+    if (line.empty() || line.compare(0, 10, "benchmark,") == 0) {
+      continue;
+    }
+    std::vector<std::string> columns;
+    std::stringstream stream(line);
+    std::string column;
+    while (std::getline(stream, column, ',')) {
+      columns.push_back(column);
+    }
+    if (columns.size() != 11) {
+      fprintf(stderr, "%s:%u: expected 11 columns, found %zu\n", filename, lineNumber,
+              columns.size());
+      return false;
+    }
+    std::string key = columns[0];
+    for (uint32_t i = 1; i < 6; i++) {
+      key += "," + columns[i];
+    }
+    g_baseline[key] = strtod(columns[9].c_str(), NULL);
+  }
+  return !g_baseline.empty();
+}
+
+static bool benchEncode(const SBenchConfig& config, const SBenchInput& input, const char* api) {
+  HANDLE_IEC61937_ENCODER encoder = openEncoder(config);
+  if (encoder == NULL) {
+    return false;
+  }
+  std::vector<uint8_t> output(input.stream.size() + 4 * iec61937_encode_get_frame_size(encoder));
+  // page in the output buffer
+  memset(output.data(), 0, output.size());
+
+  std::string key = resultKey("encode", api, config, 0);
+  double seconds = 0;
+  bool ok = true;
+  auto measureStart = std::chrono::steady_clock::now();
+  for (uint32_t run = 0; ok && needsRun(key, input.stream.size(), run, seconds, measureStart);
+       run++) {
+    iec61937_encode_reset(encoder);
+    auto start = std::chrono::steady_clock::now();
+    uint64_t written;
+    if (strcmp(api, "process") == 0) {
+      written = encodeStream(encoder, input, output);
+    } else {
+      written = encodeStreamBatch(encoder, input, output, strcmp(api, "parallel") == 0);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (run == 0 || elapsed.count() < seconds) {
+      seconds = elapsed.count();
+    }
+    ok = written == input.stream.size();
+  }
+  iec61937_encode_close(encoder);
+
+  if (!ok) {
+    fprintf(stderr, "encode,%s: unexpected output size\n", api);
+    return false;
+  }
+  printResult("encode", api, config, 0, input.aus.size(), input.stream.size(), seconds);
+  return true;
+}
+
+static bool benchDecode(const SBenchConfig& config, const SBenchInput& input, uint32_t chunkSize) {
+  std::vector<uint8_t> auBuffer(MAX_IEC61937_FRAME_SIZE_BYTES);
+  std::string key = resultKey("decode", "feed", config, chunkSize);
+  double seconds = 0;
+  bool ok = true;
+  auto measureStart = std::chrono::steady_clock::now();
+  for (uint32_t run = 0; ok && needsRun(key, input.stream.size(), run, seconds, measureStart);
+       run++) {
+    HANDLE_IEC61937_DECODER decoder = iec61937_decode_open();
+    if (decoder == NULL) {
+      return false;
+    }
+    uint64_t auBytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    int64_t numAus = decodeStream(decoder, input.stream, chunkSize, auBuffer, auBytes);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    iec61937_decode_close(decoder);
+    if (run == 0 || elapsed.count() < seconds) {
+      seconds = elapsed.count();
+    }
+    ok = numAus == (int64_t)input.aus.size() && auBytes == input.auBytes;
+  }
+
+  if (!ok) {
+    fprintf(stderr, "decode,%u: unexpected MPEG-H frames\n", chunkSize);
+    return false;
+  }
+  printResult("decode", "feed", config, chunkSize, input.aus.size(), input.stream.size(),
+              seconds);
+  return true;
+}
+
+// Prints one operation of the -p mode: time, cycles and instructions per stream byte, misses per
+// API call.
+static void printPerfResult(const char* operation, const SBenchConfig& config, uint32_t chunkSize,
+                            uint64_t bytes, const CPerfCounters& counters) {
+  printf("%s,%u,%u,%s,%u,%llu,%llu,%.3f", operation, config.rateFactor, config.frameLength,
+         auSizesName(config.auSizes), chunkSize, (unsigned long long)counters.numSections(),
+         (unsigned long long)bytes, counters.nanoseconds() / bytes);
+  for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+    EPerfCounter counter = (EPerfCounter)i;
+    if (!counters.isAvailable(counter)) {
+      printf(",n/a");
+    } else if (counter == PERF_COUNTER_CYCLES || counter == PERF_COUNTER_INSTRUCTIONS) {
+      printf(",%.3f", counters.value(counter) / bytes);
+    } else {
+      printf(",%.3f", counters.value(counter) / counters.numSections());
+    }
+  }
+  printf("\n");
+}
+
+// The first of the NUM_RUNS runs warms up caches and branch predictors, the counters of the other
+// runs are accumulated.
+static bool perfEncode(const SBenchConfig& config, const SBenchInput& input,
+                       CPerfCounters& counters) {
+  HANDLE_IEC61937_ENCODER encoder = openEncoder(config);
+  if (encoder == NULL) {
+    return false;
+  }
+  uint32_t frameSize = iec61937_encode_get_frame_size(encoder);
+  std::vector<uint8_t> output(input.stream.size() + 4 * frameSize);
+  memset(output.data(), 0, output.size());
+
+  uint64_t bytes = 0;
+  bool ok = true;
+  for (uint32_t run = 0; run < NUM_RUNS && ok; run++) {
+    if (run == 1) {
+      counters.clear();
+      bytes = 0;
+    }
+    iec61937_encode_reset(encoder);
+    uint64_t written = 0;
+    for (size_t i = 0; i < input.aus.size() && ok; i++) {
+      const IEC61937_ENC_AU& au = input.aus[i];
+      bool processed = false;
+      while (!processed && ok) {
+        uint32_t length = frameSize;
+        counters.start();
+        IECENC_RESULT err = iec61937_encode_process(encoder, au.data, au.length, &processed,
+                                                    au.duration, output.data() + written, &length);
+        counters.stop();
+        ok = err == IECENC_OK && output.size() - written - length >= frameSize;
+        written += length;
+      }
+    }
+    bytes += written;
+  }
+  iec61937_encode_close(encoder);
+
+  if (!ok) {
+    fprintf(stderr, "encode: encoding failed\n");
+    return false;
+  }
+  printPerfResult("encode", config, 0, bytes, counters);
+  return true;
+}
+
+// Decodes the stream with separate counters for feeding and extracting the MPEG-H frames.
+static bool perfDecode(const SBenchConfig& config, const SBenchInput& input, uint32_t chunkSize,
+                       bool printFeed, bool printExtract, CPerfCounters& feedCounters,
+                       CPerfCounters& extractCounters) {
+  std::vector<uint8_t> auBuffer(MAX_IEC61937_FRAME_SIZE_BYTES);
+  uint64_t bytes = 0;
+  bool ok = true;
+  for (uint32_t run = 0; run < NUM_RUNS && ok; run++) {
+    if (run == 1) {
+      feedCounters.clear();
+      extractCounters.clear();
+      bytes = 0;
+    }
+    HANDLE_IEC61937_DECODER decoder = iec61937_decode_open();
+    if (decoder == NULL) {
+      return false;
+    }
+    uint64_t numAus = 0;
+    size_t position = 0;
+    while (position < input.stream.size() && ok) {
+      uint32_t length = (uint32_t)std::min<size_t>(chunkSize, input.stream.size() - position);
+      feedCounters.start();
+      IECDEC_RESULT err = iec61937_decode_feed(decoder, input.stream.data() + position, length);
+      feedCounters.stop();
+      ok = err == IECDEC_OK;
+      position += length;
+
+      while (ok) {
+        uint32_t auLength = (uint32_t)auBuffer.size();
+        int32_t pcmOffset = 0;
+        uint32_t iecFrameLength = 0;
+        bool iecFrameProcessed = false;
+        extractCounters.start();
+        err = iec61937_decode_process(decoder, auBuffer.data(), &auLength, &pcmOffset,
+                                      &iecFrameLength, &iecFrameProcessed);
+        extractCounters.stop();
+        if (err == IECDEC_FEED_MORE_DATA) {
+          break;
+        }
+        ok = err == IECDEC_OK;
+        if (auLength > 0) {
+          numAus++;
+        }
+      }
+    }
+    iec61937_decode_close(decoder);
+    ok = ok && numAus == input.aus.size();
+    bytes += position;
+  }
+
+  if (!ok) {
+    fprintf(stderr, "feed/extract,%u: unexpected MPEG-H frames\n", chunkSize);
+    return false;
+  }
+  if (printFeed) {
+    printPerfResult("feed", config, chunkSize, bytes, feedCounters);
+  }
+  if (printExtract) {
+    printPerfResult("extract", config, chunkSize, bytes, extractCounters);
+  }
+  return true;
+}
+
+// Decodes noise of the size of the stream, so iec61937_decode_process() only searches for the sync
+// preamble. 0xF8 is removed from the noise, as it starts the preamble in every byte order.
+static bool perfSync(const SBenchConfig& config, const SBenchInput& input, uint32_t chunkSize,
+                     CPerfCounters& counters) {
+  std::vector<uint8_t> noise(input.stream.size());
+  uint32_t state = 0x5eed;
+  for (uint8_t& byte : noise) {
+    byte = (uint8_t)nextRandom(state);
+    if (byte == 0xF8) {
+      byte = 0;
+    }
+  }
+
+  std::vector<uint8_t> auBuffer(MAX_IEC61937_FRAME_SIZE_BYTES);
+  uint64_t bytes = 0;
+  bool ok = true;
+  for (uint32_t run = 0; run < NUM_RUNS && ok; run++) {
+    if (run == 1) {
+      counters.clear();
+      bytes = 0;
+    }
+    HANDLE_IEC61937_DECODER decoder = iec61937_decode_open();
+    if (decoder == NULL) {
+      return false;
+    }
+    size_t position = 0;
+    while (position < noise.size() && ok) {
+      uint32_t length = (uint32_t)std::min<size_t>(chunkSize, noise.size() - position);
+      ok = iec61937_decode_feed(decoder, noise.data() + position, length) == IECDEC_OK;
+      position += length;
+
+      uint32_t auLength = (uint32_t)auBuffer.size();
+      int32_t pcmOffset = 0;
+      uint32_t iecFrameLength = 0;
+      bool iecFrameProcessed = false;
+      counters.start();
+      IECDEC_RESULT err = iec61937_decode_process(decoder, auBuffer.data(), &auLength, &pcmOffset,
+                                                  &iecFrameLength, &iecFrameProcessed);
+      counters.stop();
+      ok = ok && err == IECDEC_FEED_MORE_DATA;
+    }
+    iec61937_decode_close(decoder);
+    bytes += position;
+  }
+
+  if (!ok) {
+    fprintf(stderr, "sync,%u: sync found in noise\n", chunkSize);
+    return false;
+  }
+  printPerfResult("sync", config, chunkSize, bytes, counters);
+  return true;
+}
+
+// IEC frame on the simulated link of the -l mode
+struct SLinkFrame {
+  uint64_t offset;  /* position in the encoder output */
+  uint32_t length;
+  uint64_t arrival; /* sample time at which the frame has been received completely */
+  bool flushed;     /* written by iec61937_encode_flush() */
+};
+
+// Returns the percentile p (0 - 1) of sorted values.
+static double percentile(const std::vector<double>& sorted, double p) {
+  size_t index = (size_t)(p * sorted.size() + 0.5);
+  return sorted[std::min(std::max<size_t>(index, 1), sorted.size()) - 1];
+}
+
+// Measures the latency of every MPEG-H frame from the entry of iec61937_encode_process() to the
+// exit of the iec61937_decode_process() call which returns it (-l).
+//
+// The encoder and the decoder are connected by a simulated link in the sample domain: MPEG-H frame
+// i enters the encoder at the sum of the durations of the frames before it, an IEC frame is sent
+// as soon as it has been written and the previous one has been sent, and it takes one IEC frame
+// length to arrive at the decoder, which is fed the complete IEC frame. The sample latency is the
+// arrival time of the IEC frame after which the decoder returns the MPEG-H frame minus its entry
+// time. The wall time latency adds the measured duration of the API calls: the calls are executed
+// at their sample time converted with LATENCY_SAMPLE_RATE on a virtual CPU, which is busy for the
+// measured duration of each call, so processing time delays later calls like in a real-time
+// system. MPEG-H frames which are only completed by flushing the encoder are not measured.
+static bool measureLatency(const SBenchConfig& config, const SBenchInput& input, bool lowLatency) {
+  uint32_t maxAuSize = 0;
+  for (const IEC61937_ENC_AU& au : input.aus) {
+    maxAuSize = std::max(maxAuSize, au.length);
+  }
+  HANDLE_IEC61937_ENCODER encoder = openEncoder(config, IECENC_PACKING_GREEDY,
+                                                IEC61937_PCM_FORMAT_S16_BE, lowLatency, maxAuSize);
+  HANDLE_IEC61937_DECODER decoder = iec61937_decode_open();
+  if (encoder == NULL || decoder == NULL) {
+    iec61937_encode_close(encoder);
+    iec61937_decode_close(decoder);
+    return false;
+  }
+  uint32_t frameSize = iec61937_encode_get_frame_size(encoder);
+  uint32_t maxLatency = iec61937_encode_get_max_latency(encoder);
+  std::vector<uint8_t> output(input.stream.size() + 4 * frameSize);
+  std::vector<uint8_t> auBuffer(MAX_IEC61937_FRAME_SIZE_BYTES);
+  std::vector<SLinkFrame> link;
+  size_t numFramesReceived = 0;
+  uint64_t written = 0;
+  uint64_t linkFree = 0; /* sample time at which the link can send the next IEC frame */
+  double cpuFree = 0;    /* wall time in ns at which the virtual CPU can execute the next call */
+  std::vector<uint64_t> entrySamples(input.aus.size());
+  std::vector<double> entryNs(input.aus.size());
+  std::vector<double> latencySamples;
+  std::vector<double> latencyNs;
+  size_t numAusDecoded = 0;
+  bool ok = true;
+
+  // Converts sample time to wall time on the virtual CPU.
+  auto startCall = [&cpuFree](uint64_t samples) {
+    cpuFree = std::max(cpuFree, samples * 1e9 / LATENCY_SAMPLE_RATE);
+    return std::chrono::steady_clock::now();
+  };
+  auto endCall = [&cpuFree](std::chrono::steady_clock::time_point start) {
+    cpuFree += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start)
+                   .count();
+  };
+  auto sendFrame = [&](uint64_t samples, uint32_t length, bool flushed) {
+    linkFree = std::max(linkFree, samples) + config.frameLength;
+    SLinkFrame frame = {written, length, linkFree, flushed};
+    link.push_back(frame);
+    written += length;
+  };
+  // Feeds all IEC frames which have arrived up to sample time samples into the decoder.
+  auto receiveFrames = [&](uint64_t samples) {
+    while (numFramesReceived < link.size() && link[numFramesReceived].arrival <= samples && ok) {
+      const SLinkFrame& frame = link[numFramesReceived++];
+      std::chrono::steady_clock::time_point start = startCall(frame.arrival);
+      ok = iec61937_decode_feed(decoder, output.data() + frame.offset, frame.length) == IECDEC_OK;
+      endCall(start);
+      while (ok) {
+        uint32_t auLength = (uint32_t)auBuffer.size();
+        int32_t pcmOffset = 0;
+        uint32_t iecFrameLength = 0;
+        bool iecFrameProcessed = false;
+        start = startCall(frame.arrival);
+        IECDEC_RESULT err = iec61937_decode_process(decoder, auBuffer.data(), &auLength,
+                                                    &pcmOffset, &iecFrameLength,
+                                                    &iecFrameProcessed);
+        endCall(start);
+        if (err == IECDEC_FEED_MORE_DATA) {
+          break;
+        }
+        ok = err == IECDEC_OK && (auLength == 0 || numAusDecoded < input.aus.size());
+        if (ok && auLength > 0) {
+          if (!frame.flushed) {
+            latencySamples.push_back((double)(frame.arrival - entrySamples[numAusDecoded]));
+            latencyNs.push_back(cpuFree - entryNs[numAusDecoded]);
+          }
+          numAusDecoded++;
+        }
+      }
+    }
+  };
+
+  uint64_t samples = 0;
+  for (size_t i = 0; i < input.aus.size() && ok; i++) {
+    const IEC61937_ENC_AU& au = input.aus[i];
+    receiveFrames(samples);
+    entrySamples[i] = samples;
+    entryNs[i] = std::max(cpuFree, samples * 1e9 / LATENCY_SAMPLE_RATE);
+    bool processed = false;
+    while (!processed && ok) {
+      // the low latency encoder may write several IEC frames at once
+      uint32_t length = (uint32_t)(output.size() - written);
+      std::chrono::steady_clock::time_point start = startCall(samples);
+      ok = iec61937_encode_process(encoder, au.data, au.length, &processed, au.duration,
+                                   output.data() + written, &length) == IECENC_OK &&
+           output.size() - written - length >= frameSize;
+      endCall(start);
+      for (uint32_t offset = 0; ok && offset < length; offset += frameSize) {
+        sendFrame(samples, frameSize, false);
+      }
+    }
+    samples += au.duration;
+  }
+  while (ok) {
+    uint32_t length = frameSize;
+    ok = iec61937_encode_flush(encoder, output.data() + written, &length) == IECENC_OK &&
+         output.size() - written - length >= frameSize;
+    if (length == 0) {
+      break;
+    }
+    sendFrame(samples, length, true);
+  }
+  receiveFrames(UINT64_MAX);
+  iec61937_encode_close(encoder);
+  iec61937_decode_close(decoder);
+
+  if (!ok || numAusDecoded != input.aus.size() || latencySamples.empty()) {
+    fprintf(stderr, "latency,%u,%u,%s: unexpected MPEG-H frames\n", config.rateFactor,
+            config.frameLength, auSizesName(config.auSizes));
+    return false;
+  }
+  std::sort(latencySamples.begin(), latencySamples.end());
+  std::sort(latencyNs.begin(), latencyNs.end());
+  printf("%s,%u,%u,%s,%zu,%u", lowLatency ? "low_latency" : "default", config.rateFactor,
+         config.frameLength, auSizesName(config.auSizes), latencySamples.size(), maxLatency);
+  for (double p : {0.5, 0.99, 0.999, 1.0}) {
+    printf(",%.0f", percentile(latencySamples, p));
+  }
+  for (double p : {0.5, 0.99, 0.999, 1.0}) {
+    printf(",%.1f", percentile(latencyNs, p) / 1000);
+  }
+  printf("\n");
+  return true;
+}
+
+// Decodes the stream like a player: the PTS of an MPEG-H frame is the start of the current IEC
+// frame plus its PCM offset. IECDEC_PENDINGDATA_ERROR is counted in numErrors and decoding
+// continues, every other error aborts decoding.
+static bool decodeFrames(const std::vector<uint8_t>& stream, uint32_t chunkSize,
+                         IEC61937_PCM_FORMAT inputFormat, std::vector<SDecodedAu>& aus,
+                         uint32_t& numErrors) {
+  HANDLE_IEC61937_DECODER decoder = iec61937_decode_open();
+  if (decoder == NULL) {
+    return false;
+  }
+  std::vector<uint8_t> auBuffer(MAX_MPEGH_FRAME_SIZE);
+  int64_t iecFrameStart = 0;
+  bool ok = true;
+  aus.clear();
+  numErrors = 0;
+
+  size_t position = 0;
+  while (ok && position < stream.size()) {
+    uint32_t length = (uint32_t)std::min<size_t>(chunkSize, stream.size() - position);
+    if (iec61937_decode_feed_format(decoder, stream.data() + position, length, inputFormat) !=
+        IECDEC_OK) {
+      fprintf(stderr, "  feeding %u bytes at %zu failed\n", length, position);
+      ok = false;
+      break;
+    }
+    position += length;
+
+    // each call consumes at least one payload header or IEC frame, so a decoder which does not
+    // request more data within this limit does not make progress
+    for (uint32_t numCalls = 0;; numCalls++) {
+      if (numCalls > WORKBUFFER_SIZE_BYTES) {
+        fprintf(stderr, "  decoder does not make progress at %zu\n", position);
+        ok = false;
+        break;
+      }
+      uint32_t auLength = (uint32_t)auBuffer.size();
+      int32_t pcmOffset = 0;
+      uint32_t iecFrameLength = 0;
+      bool iecFrameProcessed = false;
+      IECDEC_RESULT err = iec61937_decode_process(decoder, auBuffer.data(), &auLength, &pcmOffset,
+                                                  &iecFrameLength, &iecFrameProcessed);
+      if (err == IECDEC_FEED_MORE_DATA) {
+        break;
+      }
+      if (err == IECDEC_PENDINGDATA_ERROR) {
+        numErrors++;
+        continue;
+      }
+      if (err != IECDEC_OK) {
+        fprintf(stderr, "  decoding failed with error %d at %zu\n", err, position);
+        ok = false;
+        break;
+      }
+      if (auLength > 0) {
+        SDecodedAu au;
+        au.data.assign(auBuffer.begin(), auBuffer.begin() + auLength);
+        au.pts = iecFrameStart + pcmOffset;
+        aus.push_back(au);
+      }
+      if (iecFrameProcessed) {
+        iecFrameStart += iecFrameLength;
+      }
+    }
+  }
+  iec61937_decode_close(decoder);
+  return ok;
+}
+
+// Compares numAus decoded MPEG-H frames starting at decodedIndex with the input frames starting at
+// inputIndex. The PTS of the decoded frames has to advance with the frame durations.
+static bool compareFrames(const SBenchInput& input, size_t inputIndex,
+                          const std::vector<SDecodedAu>& decoded, size_t decodedIndex,
+                          size_t numAus) {
+  for (size_t i = 0; i < numAus; i++) {
+    const IEC61937_ENC_AU& expected = input.aus[inputIndex + i];
+    const SDecodedAu& au = decoded[decodedIndex + i];
+    if (au.data.size() != expected.length ||
+        memcmp(au.data.data(), expected.data, expected.length) != 0) {
+      fprintf(stderr, "  MPEG-H frame %zu differs\n", inputIndex + i);
+      return false;
+    }
+    int64_t expectedPts = decoded[decodedIndex].pts + (int64_t)i * AU_DURATION;
+    if (au.pts != expectedPts) {
+      fprintf(stderr, "  MPEG-H frame %zu has PTS %lld instead of %lld\n", inputIndex + i,
+              (long long)au.pts, (long long)expectedPts);
+      return false;
+    }
+  }
+  return true;
+}
+
+// Checks that all MPEG-H frames survive the round trip bit-exact with consistent PCM offsets.
+static bool verifyRoundTrip(const SBenchConfig& config, const SBenchInput& input,
+                            IECENC_PACKING packing, IEC61937_PCM_FORMAT format,
+                            uint32_t chunkSize) {
+  HANDLE_IEC61937_ENCODER encoder = openEncoder(config, packing, format);
+  if (encoder == NULL) {
+    fprintf(stderr, "  cannot open encoder\n");
+    return false;
+  }
+  std::vector<uint8_t> stream((input.aus.size() + 4) * iec61937_encode_get_frame_size(encoder));
+  uint64_t written = encodeStream(encoder, input, stream);
+  IEC61937_ENC_STATS stats;
+  iec61937_encode_get_stats(encoder, &stats);
+  iec61937_encode_close(encoder);
+  if (written == 0) {
+    fprintf(stderr, "  encoding failed\n");
+    return false;
+  }
+  stream.resize(written);
+
+  // MPEG-H frames larger than the IEC frame payload can only be transmitted split
+  bool oversized = false;
+  for (const IEC61937_ENC_AU& au : input.aus) {
+    oversized |= au.length > input.payloadCapacity;
+  }
+  if (oversized && stats.numSplitAus == 0) {
+    fprintf(stderr, "  no split MPEG-H frames\n");
+    return false;
+  }
+
+  std::vector<SDecodedAu> decoded;
+  uint32_t numErrors = 0;
+  if (!decodeFrames(stream, chunkSize, format, decoded, numErrors)) {
+    return false;
+  }
+  if (numErrors > 0) {
+    fprintf(stderr, "  %u decoder errors\n", numErrors);
+    return false;
+  }
+  if (decoded.size() != input.aus.size()) {
+    fprintf(stderr, "  %zu MPEG-H frames decoded instead of %zu\n", decoded.size(),
+            input.aus.size());
+    return false;
+  }
+  if (decoded[0].pts < 0) {
+    fprintf(stderr, "  negative PTS of the first MPEG-H frame\n");
+    return false;
+  }
+  return compareFrames(input, 0, decoded, 0, decoded.size());
+}
+
+// Checks that the batch and parallel encoder APIs produce the same stream as
+// iec61937_encode_process().
+static bool verifyEncoderApis(const SBenchConfig& config, const SBenchInput& input) {
+  for (uint32_t parallel = 0; parallel < 2; parallel++) {
+    HANDLE_IEC61937_ENCODER encoder = openEncoder(config);
+    if (encoder == NULL) {
+      fprintf(stderr, "  cannot open encoder\n");
+      return false;
+    }
+    std::vector<uint8_t> stream(input.stream.size() + 4 * input.frameSize);
+    uint64_t written = encodeStreamBatch(encoder, input, stream, parallel == 1);
+    iec61937_encode_close(encoder);
+    stream.resize(written);
+    if (stream != input.stream) {
+      fprintf(stderr, "  %s output differs from iec61937_encode_process()\n",
+              parallel ? "parallel" : "batch");
+      return false;
+    }
+  }
+  return true;
+}
+
+// Checks that the decoder resyncs after a lost sync word, lost bytes and inserted garbage. The
+// stream is damaged within its first five eighths, the MPEG-H frames of the last eighth have to be
+// decoded bit-exact again.
+static bool verifyRecovery(const SBenchInput& input) {
+  size_t numFrames = input.stream.size() / input.frameSize;
+  if (numFrames < 8) {
+    return true;
+  }
+  std::vector<uint8_t> stream = input.stream;
+  // garbage which starts like an MPEG-H IEC frame (sync words, data type 25, 16 bytes payload)
+  // but carries invalid payload headers
+  std::vector<uint8_t> garbage(36, 0xFF);
+  const uint8_t garbageHeader[] = {0xF8, 0x72, 0x4E, 0x1F, 0x00, 25, 0x00, 16};
+  memcpy(garbage.data(), garbageHeader, sizeof(garbageHeader));
+  stream.insert(stream.begin() + numFrames * 5 / 8 * input.frameSize, garbage.begin(),
+                garbage.end());
+  // drop bytes within an IEC frame
+  size_t dropPosition = numFrames / 2 * input.frameSize + input.frameSize / 3 / 2 * 2;
+  stream.erase(stream.begin() + dropPosition, stream.begin() + dropPosition + 1002);
+  // destroy a sync word
+  memset(&stream[numFrames / 4 * input.frameSize], 0, 4);
+
+  std::vector<SDecodedAu> decoded;
+  uint32_t numErrors = 0;
+  if (!decodeFrames(stream, 4096, IEC61937_PCM_FORMAT_S16_BE, decoded, numErrors)) {
+    return false;
+  }
+  size_t numTail = std::max<size_t>(1, input.aus.size() / 8);
+  if (decoded.size() < numTail) {
+    fprintf(stderr, "  only %zu MPEG-H frames decoded after corruption\n", decoded.size());
+    return false;
+  }
+  return compareFrames(input, input.aus.size() - numTail, decoded, decoded.size() - numTail,
+                       numTail);
+}
+
+static bool verifyConfiguration(const SBenchConfig& config, const SBenchInput& input) {
+  const char* check = "round trip greedy S16_BE";
+  bool ok = verifyRoundTrip(config, input, IECENC_PACKING_GREEDY, IEC61937_PCM_FORMAT_S16_BE, 61);
+  if (ok) {
+    check = "round trip lookahead S32_LE";
+    ok = verifyRoundTrip(config, input, IECENC_PACKING_LOOKAHEAD, IEC61937_PCM_FORMAT_S32_LE,
+                         4096);
+  }
+  if (ok) {
+    check = "encoder APIs";
+    ok = verifyEncoderApis(config, input);
+  }
+  if (ok) {
+    check = "recovery";
+    ok = verifyRecovery(input);
+  }
+  if (!ok) {
+    fprintf(stderr, "verify,%u,%u,%s: %s failed\n", config.rateFactor, config.frameLength,
+            auSizesName(config.auSizes), check);
+  }
+  return ok;
+}
+
+static void printUsage(const char* name) {
+  fprintf(stderr,
+          "Usage: %s [-v] [-p | -l] [-b baseline] [-t tolerance] [stream bytes] [filter]\n", name);
+  fprintf(stderr, "  -v           : verify each configuration before measuring it\n");
+  fprintf(stderr, "  -p           : report performance counters per operation instead of the\n");
+  fprintf(stderr, "                 throughput\n");
+  fprintf(stderr, "  -l           : report the end-to-end latency percentiles instead of the\n");
+  fprintf(stderr, "                 throughput\n");
+  fprintf(stderr, "  -b baseline  : compare mb_per_s with the CSV output of a previous run\n");
+  fprintf(stderr, "  -t tolerance : allowed relative slowdown (default %.1f)\n", DEFAULT_TOLERANCE);
+  fprintf(stderr, "  stream bytes : stream size per configuration (default %u)\n",
+          DEFAULT_STREAM_BYTES);
+  fprintf(stderr, "  filter       : only run benchmarks whose CSV prefix contains this string,\n");
+  fprintf(stderr, "                 e.g. \"decode\" or \"encode,batch,16,1024\"\n");
+  fprintf(stderr, "                 (with -p e.g. \"sync\" or \"extract,4,1024\", with -l e.g.\n");
+  fprintf(stderr, "                 \"low_latency\" or \"default,16,2048,span\")\n");
+}
+
+// Reports the counters which are not available, the affected CSV columns are n/a.
+static void printPerfAvailability(const CPerfCounters& counters) {
+  static const char* names[PERF_NUM_COUNTERS] = {"cycles", "instructions", "cache misses",
+                                                 "dTLB misses", "branch misses"};
+  std::string unavailable;
+  for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+    if (!counters.isAvailable((EPerfCounter)i)) {
+      unavailable += unavailable.empty() ? names[i] : std::string(", ") + names[i];
+    }
+  }
+  if (!unavailable.empty()) {
+    fprintf(stderr, "Performance counters not available (%s): %s\n", strerror(counters.error()),
+            unavailable.c_str());
+  }
+}
+
+int main(int argc, char* argv[]) {
+  bool verify = false;
+  bool perf = false;
+  bool latency = false;
+  uint64_t streamBytes = DEFAULT_STREAM_BYTES;
+  const char* filter = NULL;
+  uint32_t numPositional = 0;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-v") {
+      verify = true;
+    } else if (arg == "-p") {
+      perf = true;
+    } else if (arg == "-l") {
+      latency = true;
+    } else if (arg == "-b" && i + 1 < argc) {
+      if (!readBaseline(argv[++i])) {
+        fprintf(stderr, "Cannot read baseline %s\n", argv[i]);
+        return 1;
+      }
+      g_useBaseline = true;
+    } else if (arg == "-t" && i + 1 < argc) {
+      g_tolerance = strtod(argv[++i], NULL);
+    } else if (numPositional == 0 && arg[0] != '-') {
+      streamBytes = strtoull(argv[i], NULL, 10);
+      numPositional++;
+    } else if (numPositional == 1 && arg[0] != '-') {
+      filter = argv[i];
+      numPositional++;
+    } else {
+      streamBytes = 0;
+    }
+  }
+  if (streamBytes == 0 || g_tolerance <= 0 || g_tolerance >= 1 || (perf && latency)) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  static const uint8_t rateFactors[] = {1, 4, 16};
+  static const uint32_t frameLengths[] = {1024, 2048};
+  // IEC frames shorter than the MPEG-H frames show the effect of the low latency mode
+  static const uint32_t latencyFrameLengths[] = {768, 1024, 2048};
+  static const EAuSizes auSizes[] = {AU_SIZES_SMALL, AU_SIZES_CBR, AU_SIZES_VBR, AU_SIZES_IPF,
+                                     AU_SIZES_SPAN, AU_SIZES_MHAS};
+  static const char* encodeApis[] = {"process", "batch", "parallel"};
+  static const uint32_t chunkSizes[] = {1, 61, 4096, 65536, MAX_FEED_CHUNK_SIZE};
+  // smaller chunks would mostly measure the cost of reading the counters
+  static const uint32_t perfChunkSizes[] = {4096, 65536};
+  static const char* perfDecodeOperations[] = {"feed", "extract", "sync"};
+  static const char* latencyModes[] = {"default", "low_latency"};
+
+  CPerfCounters encodeCounters, feedCounters, extractCounters, syncCounters;
+  if (perf) {
+    printPerfAvailability(encodeCounters);
+    printf(
+        "operation,rate_factor,frame_length,au_sizes,chunk_size,calls,bytes,ns_per_byte,"
+        "cycles_per_byte,instructions_per_byte,cache_misses_per_call,dtlb_misses_per_call,"
+        "branch_misses_per_call\n");
+  } else if (latency) {
+    printf(
+        "mode,rate_factor,frame_length,au_sizes,num_aus,max_latency,samples_p50,samples_p99,"
+        "samples_p999,samples_max,us_p50,us_p99,us_p999,us_max\n");
+  } else {
+    printf(
+        "benchmark,api,rate_factor,frame_length,au_sizes,chunk_size,num_aus,stream_bytes,"
+        "ns_per_au,mb_per_s,aus_per_s\n");
+  }
+  std::vector<uint32_t> configFrameLengths(std::begin(frameLengths), std::end(frameLengths));
+  if (latency) {
+    configFrameLengths.assign(std::begin(latencyFrameLengths), std::end(latencyFrameLengths));
+  }
+  uint32_t numVerified = 0;
+  uint32_t numFailed = 0;
+  for (uint8_t rateFactor : rateFactors) {
+    for (uint32_t frameLength : configFrameLengths) {
+      for (EAuSizes sizes : auSizes) {
+        SBenchConfig config = {rateFactor, frameLength, sizes};
+        char prefix[64];
+        snprintf(prefix, sizeof(prefix), "%u,%u,%s", rateFactor, frameLength, auSizesName(sizes));
+
+        std::vector<std::string> names;
+        if (perf) {
+          names.push_back(std::string("encode,") + prefix + ",0");
+          for (uint32_t chunkSize : perfChunkSizes) {
+            for (const char* operation : perfDecodeOperations) {
+              names.push_back(std::string(operation) + "," + prefix + "," +
+                              std::to_string(chunkSize));
+            }
+          }
+        } else if (latency) {
+          for (const char* mode : latencyModes) {
+            names.push_back(std::string(mode) + "," + prefix);
+          }
+        } else {
+          for (const char* api : encodeApis) {
+            names.push_back(std::string("encode,") + api + "," + prefix + ",0");
+          }
+          for (uint32_t chunkSize : chunkSizes) {
+            names.push_back(std::string("decode,feed,") + prefix + "," +
+                            std::to_string(chunkSize));
+          }
+        }
+        bool selected = false;
+        for (const std::string& name : names) {
+          selected |= filter == NULL || name.find(filter) != std::string::npos;
+        }
+        if (!selected) {
+          continue;
+        }
+
+        SBenchInput input;
+        if (!createInput(config, streamBytes, input)) {
+          fprintf(stderr, "cannot create input for %s\n", prefix);
+          return 1;
+        }
+        if (verify) {
+          numVerified++;
+          if (!verifyConfiguration(config, input)) {
+            numFailed++;
+            continue;
+          }
+        }
+
+        if (perf) {
+          std::vector<bool> run(names.size());
+          for (uint32_t i = 0; i < names.size(); i++) {
+            run[i] = filter == NULL || names[i].find(filter) != std::string::npos;
+          }
+          bool ok = !run[0] || perfEncode(config, input, encodeCounters);
+          for (uint32_t i = 0; i < sizeof(perfChunkSizes) / sizeof(perfChunkSizes[0]) && ok; i++) {
+            // feed, extract and sync of one chunk size
+            const uint32_t index = 1 + 3 * i;
+            if (run[index] || run[index + 1]) {
+              ok = perfDecode(config, input, perfChunkSizes[i], run[index], run[index + 1],
+                              feedCounters, extractCounters);
+            }
+            if (ok && run[index + 2]) {
+              ok = perfSync(config, input, perfChunkSizes[i], syncCounters);
+            }
+          }
+          if (!ok) {
+            return 1;
+          }
+          continue;
+        }
+        for (uint32_t i = 0; i < names.size(); i++) {
+          if (filter && names[i].find(filter) == std::string::npos) {
+            continue;
+          }
+          if (latency) {
+            if (!measureLatency(config, input, i == 1)) {
+              return 1;
+            }
+            continue;
+          }
+          bool ok = i < 3 ? benchEncode(config, input, encodeApis[i])
+                          : benchDecode(config, input, chunkSizes[i - 3]);
+          if (!ok) {
+            return 1;
+          }
+        }
+      }
+    }
+  }
+
+  if (verify) {
+    fprintf(stderr, "%u of %u configurations verified\n", numVerified - numFailed, numVerified);
+  }
+  if (g_useBaseline) {
+    fprintf(stderr, "%u regressions in %u compared results (tolerance %.2f)\n", g_numRegressions,
+            g_numBaselineMatches, g_tolerance);
+    if (g_numBaselineMatches == 0) {
+      fprintf(stderr, "The baseline does not match any result\n");
+      return 2;
+    }
+  }
+  return numFailed > 0 || g_numRegressions > 0 ? 2 : 0;
+}
@@ -0,0 +1,276 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// system includes
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// project includes
+#include "iec61937_core.h"
+
+/*
+ * Compares the compile-time specialized IEC frame core (CIecFrameTraits) with the generic core
+ * (CIecFrameRuntimeTraits) for writing IEC frames and parsing payload headers.
+ * Results are printed as CSV:
+ *   benchmark,audio_mode,rate_factor_code,frame_length,variant,ns_per_frame,mb_per_s
+ */
+
+// Each measurement is repeated and the fastest run is reported to suppress system noise.
+#define NUM_RUNS 5
+
+// Prevents the runtime traits from being constant-folded.
+static volatile uint8_t g_runtimeValues[3];
+
+struct SBenchInput {
+  std::vector<std::vector<uint8_t>> frames;
+  std::vector<const uint8_t*> frameData;
+  std::vector<uint32_t> frameLength;
+  std::vector<uint32_t> frameDuration;
+  iec61937::SIecFramePayload payload;
+};
+
+// Fills one IEC frame with numFrames MPEG-H frames of equal size.
+template <class Traits>
+static void createInput(const Traits& traits, uint32_t numFrames, SBenchInput& input) {
+  uint32_t numAvailableBytes = traits.burstRepetitionPeriod() - IEC_HEADER_SIZE_BYTES -
+                               IEC_BURST_SPACING_SIZE_BYTES -
+                               (numFrames + 1) * traits.payloadHeaderSize();
+  uint32_t frameSize = numAvailableBytes / numFrames;
+  if (traits.audioMode() == 0 && frameSize > 0xFFFF) {
+    frameSize = 0xFFFF;
+  }
+
+  input.frames.assign(numFrames, std::vector<uint8_t>(frameSize));
+  input.frameData.clear();
+  input.frameLength.clear();
+  input.frameDuration.clear();
+  for (uint32_t i = 0; i < numFrames; i++) {
+    for (uint32_t k = 0; k < frameSize; k++) {
+      input.frames[i][k] = (uint8_t)(i + k);
+    }
+    input.frameData.push_back(input.frames[i].data());
+    input.frameLength.push_back(frameSize);
+    input.frameDuration.push_back(traits.audioFrameLength() / numFrames);
+  }
+
+  input.payload.frameData = input.frameData.data();
+  input.payload.frameLength = input.frameLength.data();
+  input.payload.frameDuration = input.frameDuration.data();
+  input.payload.numBuffersToWrite = numFrames;
+  input.payload.auPending = false;
+  input.payload.payloadLength = frameSize * numFrames;
+  input.payload.numAvailableBytes = numAvailableBytes;
+}
+
+static void printResult(const char* benchmark, uint8_t audioMode, uint8_t rateFactorCode,
+                        uint32_t audioFrameLength, const char* variant, double seconds,
+                        uint32_t iterations, uint32_t bytesPerIteration) {
+  double nsPerFrame = seconds * 1e9 / iterations;
+  double mbPerSecond = (double)bytesPerIteration * iterations / seconds / 1e6;
+  printf("%s,%u,%u,%u,%s,%.1f,%.1f\n", benchmark, audioMode, rateFactorCode, audioFrameLength,
+         variant, nsPerFrame, mbPerSecond);
+}
+
+// Writers are called through a function pointer like in the encoder to avoid benchmark specific
+// inlining into the measurement loop.
+template <class Traits>
+static uint32_t writeFrame(const Traits& traits, uint8_t* outputBuffer,
+                           const iec61937::SIecFramePayload& payload, int32_t* pPcmOffset) {
+  return iec61937::writeIecFrame(traits, outputBuffer, payload, pPcmOffset);
+}
+
+template <class Traits>
+static void benchWrite(const Traits& traits, const SBenchInput& input, const char* variant,
+                       uint32_t iterations) {
+  std::vector<uint8_t> output(traits.burstRepetitionPeriod());
+  uint32_t checksum = 0;
+  uint32_t (*volatile writer)(const Traits&, uint8_t*, const iec61937::SIecFramePayload&,
+                              int32_t*) = writeFrame<Traits>;
+
+  // warm up caches and page in the output buffer
+  for (uint32_t i = 0; i < iterations / 10 + 1; i++) {
+    int32_t pcmOffset = 0;
+    checksum += writer(traits, output.data(), input.payload, &pcmOffset);
+  }
+
+  double seconds = 0;
+  for (uint32_t run = 0; run < NUM_RUNS; run++) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+      int32_t pcmOffset = 0;
+      checksum += writer(traits, output.data(), input.payload, &pcmOffset);
+      checksum += output[IEC_HEADER_SIZE_BYTES];
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (run == 0 || elapsed.count() < seconds) {
+      seconds = elapsed.count();
+    }
+  }
+
+  printResult("write", traits.audioMode(), traits.rateFactorCode(), traits.audioFrameLength(),
+              variant, seconds, iterations, traits.burstRepetitionPeriod());
+  if (checksum == 0) {
+    fprintf(stderr, "unexpected checksum\n");
+  }
+}
+
+template <class Traits>
+static void benchParse(const Traits& traits, const SBenchInput& input, const char* variant,
+                       uint32_t iterations) {
+  std::vector<uint8_t> frame(traits.burstRepetitionPeriod());
+  int32_t pcmOffset = 0;
+  iec61937::writeIecFrame(traits, frame.data(), input.payload, &pcmOffset);
+  uint32_t checksum = 0;
+
+  double seconds = 0;
+  for (uint32_t run = 0; run < NUM_RUNS; run++) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+      const uint8_t* header = frame.data() + IEC_HEADER_SIZE_BYTES;
+      while (true) {
+        uint32_t dataOffset = 0;
+        uint32_t dataLength = 0;
+        int32_t headerPcmOffset = 0;
+        iec61937::parsePayloadHeader(traits, header, &dataOffset, &dataLength, &headerPcmOffset);
+        header += traits.payloadHeaderSize();
+        if (dataLength == 0) {
+          break;
+        }
+        checksum += dataOffset + (uint32_t)headerPcmOffset;
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (run == 0 || elapsed.count() < seconds) {
+      seconds = elapsed.count();
+    }
+  }
+
+  uint32_t headerBytes = (input.payload.numBuffersToWrite + 1) * traits.payloadHeaderSize();
+  printResult("parse", traits.audioMode(), traits.rateFactorCode(), traits.audioFrameLength(),
+              variant, seconds, iterations, headerBytes);
+  if (checksum == 0) {
+    fprintf(stderr, "unexpected checksum\n");
+  }
+}
+
+template <uint8_t AudioMode, uint8_t RateFactorCode, uint8_t FrameLengthCode>
+static void benchConfiguration(uint32_t numFrames, uint32_t iterations) {
+  iec61937::CIecFrameTraits<AudioMode, RateFactorCode, FrameLengthCode> fixedTraits;
+
+  g_runtimeValues[0] = AudioMode;
+  g_runtimeValues[1] = RateFactorCode;
+  g_runtimeValues[2] = FrameLengthCode;
+  iec61937::CIecFrameRuntimeTraits runtimeTraits;
+  runtimeTraits.m_audioMode = g_runtimeValues[0];
+  runtimeTraits.m_rateFactorCode = g_runtimeValues[1];
+  runtimeTraits.m_frameLengthCode = g_runtimeValues[2];
+
+  SBenchInput input;
+  createInput(fixedTraits, numFrames, input);
+
+  benchWrite(runtimeTraits, input, "generic", iterations);
+  benchWrite(fixedTraits, input, "specialized", iterations);
+  benchParse(runtimeTraits, input, "generic", iterations * 16);
+  benchParse(fixedTraits, input, "specialized", iterations * 16);
+}
+
+int main(int argc, char* argv[]) {
+  uint32_t iterations = 20000;
+  if (argc > 1) {
+    iterations = (uint32_t)strtoul(argv[1], NULL, 10);
+  }
+  if (iterations == 0) {
+    fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+    return 1;
+  }
+
+  printf("benchmark,audio_mode,rate_factor_code,frame_length,variant,ns_per_frame,mb_per_s\n");
+  benchConfiguration<0, 0, 0>(1, iterations);
+  benchConfiguration<0, 0, 4>(2, iterations);
+  benchConfiguration<1, 0, 0>(2, iterations);
+  benchConfiguration<1, 1, 0>(4, iterations);
+  benchConfiguration<1, 3, 0>(4, iterations);
+  benchConfiguration<1, 3, 2>(8, iterations);
+  return 0;
+}
@@ -0,0 +1,568 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// system includes
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+// project includes
+#include "iec61937_dec.h"
+#include "iec61937_enc.h"
+#include "iec61937_link_sim.h"
+#include "mhas_generator.h"
+
+/*
+ * Measures how the decoder recovers from link impairments. A synthetic MHAS stream (see
+ * mhas_generator.h) is encoded once and transmitted burst by burst over the link simulator (see
+ * iec61937_link_sim.h) with one impairment per scenario; the received chunks are decoded. Each
+ * scenario is printed as CSV:
+ *   impairment,events,aus,aus_lost,aus_corrupted,aus_duplicated,decoder_errors,sync_lost,
+ *   resync_mean_ms,resync_max_ms,ns_per_byte
+ * aus_lost counts the sent MPEG-H frames which were never received intact, aus_corrupted the
+ * received MPEG-H frames which differ from all sent ones (IEC61937-13 has no checksum, so e.g. bit
+ * flips in the payload pass the decoder) and aus_duplicated the sent MPEG-H frames received more
+ * than once. The resync time runs from an impairment to the end of the received chunk after which
+ * the decoder returns the first intact MPEG-H frame sent in a later burst; impairments before that
+ * belong to the same resync. It is converted to ms at 48 kHz. ns_per_byte is the decoder time
+ * (iec61937_decode_feed() and iec61937_decode_process()) per received byte.
+ *
+ * By default the impairments occur once per event interval on average and the chunks of the
+ * receiver have random sizes like the periods of a capture driver. With the impairment options a
+ * single custom scenario is run instead, e.g. to reproduce a field problem.
+ */
+
+// Sample rate used to convert the resync time into ms.
+#define LINK_SIM_SAMPLE_RATE 48000
+
+// Default number of MPEG-H frames per scenario.
+#define DEFAULT_NUM_AUS 5000
+
+// Default mean number of IEC frames between two impairments.
+#define DEFAULT_EVENT_INTERVAL 50
+
+// Clock deviation of the drift scenarios in ppm.
+#define DRIFT_PPM 100
+
+// Chunk sizes of the receiver: capture driver periods, and arbitrary sizes for "chunking".
+#define MIN_CHUNK_SIZE 1024
+#define MAX_CHUNK_SIZE 8192
+#define MAX_ARBITRARY_CHUNK_SIZE 65536
+
+struct SScenario {
+  std::string name;
+  IEC61937_LINK_CONFIG config;
+};
+
+// Sent stream: the MPEG-H frames and the IEC frames (bursts) carrying them.
+struct SSentStream {
+  std::vector<std::vector<uint8_t>> aus;
+  std::map<uint64_t, size_t> auIndex;  /* MPEG-H frame index by hash */
+  std::vector<uint8_t> stream;
+  std::vector<uint32_t> burstOffsets;  /* start of every burst in stream */
+  std::vector<uint32_t> auBursts;      /* burst after which the decoder returns the MPEG-H frame */
+  uint32_t frameSize;
+  uint32_t frameLength;
+};
+
+// Resync measurement, updated by the impairment callback.
+struct SResync {
+  uint64_t numEvents;
+  size_t burstIndex;  /* burst being fed */
+  bool pending;
+  size_t pendingBurst;
+  uint64_t pendingOffset;
+  uint64_t numResyncs;
+  uint64_t sumBytes;
+  uint64_t maxBytes;
+};
+
+static void onImpairment(void* userData, IECLINK_IMPAIRMENT impairment, uint64_t offset) {
+  (void)impairment;
+  SResync* resync = (SResync*)userData;
+  resync->numEvents++;
+  if (!resync->pending) {
+    resync->pending = true;
+    resync->pendingOffset = offset;
+  }
+  resync->pendingBurst = resync->burstIndex;
+}
+
+// FNV-1a hash identifying the MPEG-H frames.
+static uint64_t hashAu(const uint8_t* data, uint32_t length) {
+  uint64_t hash = 14695981039346656037ull;
+  for (uint32_t i = 0; i < length; i++) {
+    hash = (hash ^ data[i]) * 1099511628211ull;
+  }
+  return hash;
+}
+
+// Creates the MPEG-H frames with exponentially distributed sizes at 30% of the capacity of the
+// IEC frames and encodes them.
+static bool createStream(uint8_t rateFactor, uint32_t frameLength, uint32_t numAus,
+                         uint32_t seed, SSentStream& sent) {
+  IEC61937_ENC_CONFIG encoderConfig;
+  iec61937_encode_config_init(&encoderConfig);
+  encoderConfig.rateFactor = rateFactor;
+  encoderConfig.audioFrameLength = frameLength;
+  HANDLE_IEC61937_ENCODER encoder = iec61937_encode_open_config(&encoderConfig);
+  if (encoder == NULL) {
+    return false;
+  }
+  sent.frameSize = iec61937_encode_get_frame_size(encoder);
+  sent.frameLength = frameLength;
+
+  MHAS_GEN_CONFIG generatorConfig;
+  mhas_generator_config_init(&generatorConfig);
+  generatorConfig.bitrate =
+      (uint32_t)((uint64_t)sent.frameSize * 3 / 10 * 8 * LINK_SIM_SAMPLE_RATE / frameLength);
+  generatorConfig.sizes = MHAS_GEN_SIZES_EXPONENTIAL;
+  generatorConfig.maxAuSize = std::min<uint32_t>(sent.frameSize * 8 / 10, MHAS_MAX_AU_SIZE);
+  generatorConfig.seed = seed;
+  HANDLE_MHAS_GENERATOR generator = mhas_generator_open(&generatorConfig);
+  if (generator == NULL) {
+    iec61937_encode_close(encoder);
+    return false;
+  }
+
+  std::vector<uint8_t> frame(sent.frameSize);
+  bool ok = true;
+  for (uint32_t i = 0; i < numAus && ok; i++) {
+    std::vector<uint8_t> au(MHAS_MAX_AU_SIZE);
+    uint32_t length = (uint32_t)au.size();
+    uint32_t duration = 0;
+    bool isRap = false;
+    ok = mhas_generator_process(generator, au.data(), &length, &duration, &isRap) == MHAS_OK;
+    au.resize(length);
+
+    bool processed = false;
+    while (!processed && ok) {
+      uint32_t frameBytes = (uint32_t)frame.size();
+      ok = iec61937_encode_process(encoder, au.data(), length, &processed, duration, frame.data(),
+                                   &frameBytes) == IECENC_OK;
+      if (frameBytes > 0) {
+        sent.burstOffsets.push_back((uint32_t)sent.stream.size());
+        sent.stream.insert(sent.stream.end(), frame.begin(), frame.begin() + frameBytes);
+      }
+    }
+    sent.auIndex[hashAu(au.data(), length)] = sent.aus.size();
+    sent.aus.push_back(au);
+  }
+  while (ok) {
+    uint32_t frameBytes = (uint32_t)frame.size();
+    ok = iec61937_encode_flush(encoder, frame.data(), &frameBytes) == IECENC_OK;
+    if (frameBytes == 0) {
+      break;
+    }
+    sent.burstOffsets.push_back((uint32_t)sent.stream.size());
+    sent.stream.insert(sent.stream.end(), frame.begin(), frame.begin() + frameBytes);
+  }
+  mhas_generator_close(generator);
+  iec61937_encode_close(encoder);
+  return ok && sent.auIndex.size() == sent.aus.size();
+}
+
+// Decodes the sent stream burst by burst to find the burst after which each MPEG-H frame is
+// returned.
+static bool mapAusToBursts(SSentStream& sent) {
+  HANDLE_IEC61937_DECODER decoder = iec61937_decode_open();
+  if (decoder == NULL) {
+    return false;
+  }
+  std::vector<uint8_t> auBuffer(MAX_MPEGH_FRAME_SIZE);
+  bool ok = true;
+  for (size_t k = 0; k < sent.burstOffsets.size() && ok; k++) {
+    uint32_t end = k + 1 < sent.burstOffsets.size() ? sent.burstOffsets[k + 1]
+                                                    : (uint32_t)sent.stream.size();
+    ok = iec61937_decode_feed(decoder, sent.stream.data() + sent.burstOffsets[k],
+                              end - sent.burstOffsets[k]) == IECDEC_OK;
+    while (ok) {
+      uint32_t auLength = (uint32_t)auBuffer.size();
+      int32_t pcmOffset = 0;
+      uint32_t iecFrameLength = 0;
+      bool iecFrameProcessed = false;
+      IECDEC_RESULT err = iec61937_decode_process(decoder, auBuffer.data(), &auLength, &pcmOffset,
+                                                  &iecFrameLength, &iecFrameProcessed);
+      if (err == IECDEC_FEED_MORE_DATA) {
+        break;
+      }
+      ok = err == IECDEC_OK;
+      if (auLength > 0) {
+        sent.auBursts.push_back((uint32_t)k);
+      }
+    }
+  }
+  iec61937_decode_close(decoder);
+  return ok && sent.auBursts.size() == sent.aus.size();
+}
+
+// Counters of the received MPEG-H frames of one scenario.
+struct SReceived {
+  std::vector<uint32_t> numReceived; /* per sent MPEG-H frame */
+  uint64_t numCorrupted;
+  uint64_t numDecoderErrors;
+  uint64_t bytesDecoded;
+  double decodeNs;
+};
+
+// Feeds a received chunk into the decoder and checks the obtained MPEG-H frames.
+static bool decodeChunk(HANDLE_IEC61937_DECODER decoder, const uint8_t* chunk, uint32_t length,
+                        const SSentStream& sent, std::vector<uint8_t>& auBuffer,
+                        SReceived& received, SResync& resync) {
+  auto start = std::chrono::steady_clock::now();
+  IECDEC_RESULT err = iec61937_decode_feed(decoder, chunk, length);
+  received.decodeNs +=
+      std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  if (err != IECDEC_OK) {
+    fprintf(stderr, "feeding %u bytes failed\n", length);
+    return false;
+  }
+  received.bytesDecoded += length;
+  while (true) {
+    uint32_t auLength = (uint32_t)auBuffer.size();
+    int32_t pcmOffset = 0;
+    uint32_t iecFrameLength = 0;
+    bool iecFrameProcessed = false;
+    start = std::chrono::steady_clock::now();
+    err = iec61937_decode_process(decoder, auBuffer.data(), &auLength, &pcmOffset, &iecFrameLength,
+                                  &iecFrameProcessed);
+    received.decodeNs +=
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    if (err == IECDEC_FEED_MORE_DATA) {
+      break;
+    }
+    if (err != IECDEC_OK) {
+      // e.g. IECDEC_PENDINGDATA_ERROR, decoding continues with the next IEC frame
+      received.numDecoderErrors++;
+      if (err != IECDEC_PENDINGDATA_ERROR) {
+        break;
+      }
+      continue;
+    }
+    if (auLength == 0) {
+      continue;
+    }
+    std::map<uint64_t, size_t>::const_iterator au =
+        sent.auIndex.find(hashAu(auBuffer.data(), auLength));
+    if (au == sent.auIndex.end() || sent.aus[au->second].size() != auLength ||
+        memcmp(sent.aus[au->second].data(), auBuffer.data(), auLength) != 0) {
+      received.numCorrupted++;
+      continue;
+    }
+    received.numReceived[au->second]++;
+    if (resync.pending && sent.auBursts[au->second] > resync.pendingBurst) {
+      uint64_t bytes = received.bytesDecoded - resync.pendingOffset;
+      resync.numResyncs++;
+      resync.sumBytes += bytes;
+      resync.maxBytes = std::max(resync.maxBytes, bytes);
+      resync.pending = false;
+    }
+  }
+  return true;
+}
+
+static bool runScenario(const SSentStream& sent, const SScenario& scenario) {
+  SResync resync;
+  memset(&resync, 0, sizeof(resync));
+  IEC61937_LINK_CONFIG linkConfig = scenario.config;
+  linkConfig.impairmentCallback = onImpairment;
+  linkConfig.impairmentUserData = &resync;
+  HANDLE_IEC61937_LINK link = iec61937_link_open(&linkConfig);
+  HANDLE_IEC61937_DECODER decoder = iec61937_decode_open();
+  if (link == NULL || decoder == NULL) {
+    fprintf(stderr, "%s: invalid configuration\n", scenario.name.c_str());
+    iec61937_link_close(link);
+    iec61937_decode_close(decoder);
+    return false;
+  }
+
+  SReceived received;
+  received.numReceived.resize(sent.aus.size());
+  received.numCorrupted = 0;
+  received.numDecoderErrors = 0;
+  received.bytesDecoded = 0;
+  received.decodeNs = 0;
+  std::vector<uint8_t> auBuffer(MAX_MPEGH_FRAME_SIZE);
+  std::vector<uint8_t> chunk(IEC61937_LINK_MAX_FEED_SIZE * 2);
+  bool ok = true;
+  for (size_t k = 0; k < sent.burstOffsets.size() && ok; k++) {
+    uint32_t end = k + 1 < sent.burstOffsets.size() ? sent.burstOffsets[k + 1]
+                                                    : (uint32_t)sent.stream.size();
+    resync.burstIndex = k;
+    ok = iec61937_link_feed(link, sent.stream.data() + sent.burstOffsets[k],
+                            end - sent.burstOffsets[k]) == IECLINK_OK;
+    while (ok) {
+      uint32_t length = (uint32_t)chunk.size();
+      IECLINK_RESULT err = iec61937_link_process(link, chunk.data(), &length);
+      if (err == IECLINK_FEED_MORE_DATA) {
+        break;
+      }
+      ok = err == IECLINK_OK &&
+           decodeChunk(decoder, chunk.data(), length, sent, auBuffer, received, resync);
+    }
+  }
+  uint32_t length = (uint32_t)chunk.size();
+  ok = ok && iec61937_link_flush(link, chunk.data(), &length) == IECLINK_OK;
+  if (ok && length > 0) {
+    ok = decodeChunk(decoder, chunk.data(), length, sent, auBuffer, received, resync);
+  }
+  IEC61937_DEC_STATS decoderStats;
+  iec61937_decode_get_stats(decoder, &decoderStats);
+  iec61937_link_close(link);
+  iec61937_decode_close(decoder);
+  if (!ok) {
+    fprintf(stderr, "%s: transmission failed\n", scenario.name.c_str());
+    return false;
+  }
+
+  uint64_t numLost = 0;
+  uint64_t numDuplicated = 0;
+  for (uint32_t numReceived : received.numReceived) {
+    numLost += numReceived == 0;
+    numDuplicated += numReceived > 1;
+  }
+  printf("%s,%llu,%zu,%llu,%llu,%llu,%llu,%llu", scenario.name.c_str(),
+         (unsigned long long)resync.numEvents, sent.aus.size(), (unsigned long long)numLost,
+         (unsigned long long)received.numCorrupted, (unsigned long long)numDuplicated,
+         (unsigned long long)received.numDecoderErrors,
+         (unsigned long long)decoderStats.numSyncLost);
+  if (resync.numResyncs > 0) {
+    // received bytes to samples to ms
+    double msPerByte =
+        (double)sent.frameLength / sent.frameSize * 1000.0 / LINK_SIM_SAMPLE_RATE;
+    printf(",%.2f,%.2f", resync.sumBytes * msPerByte / resync.numResyncs,
+           resync.maxBytes * msPerByte);
+  } else {
+    printf(",n/a,n/a");
+  }
+  printf(",%.3f\n", received.decodeNs / std::max<uint64_t>(received.bytesDecoded, 1));
+  return true;
+}
+
+static void printUsage(const char* name) {
+  fprintf(stderr, "Usage: %s [options]\n", name);
+  fprintf(stderr, "  -r rate factor              : rate factor of the stream (default 4)\n");
+  fprintf(stderr, "  -f frame length             : IEC frame length in samples (default 1024)\n");
+  fprintf(stderr, "  -n frames                   : MPEG-H frames per scenario (default %u)\n",
+          DEFAULT_NUM_AUS);
+  fprintf(stderr, "  -e interval                 : mean IEC frames between impairments\n");
+  fprintf(stderr, "                                (default %u)\n", DEFAULT_EVENT_INTERVAL);
+  fprintf(stderr, "  -s seed                     : seed of the stream and the impairments\n");
+  fprintf(stderr, "Impairment options, which run a single custom scenario instead:\n");
+  fprintf(stderr, "  -bits interval              : mean bits between bit flips\n");
+  fprintf(stderr, "  -slips interval             : mean bytes between byte slips\n");
+  fprintf(stderr, "  -dropouts interval:length   : mean bytes between dropouts of length bytes\n");
+  fprintf(stderr, "  -duplicates interval        : mean bursts between duplicated bursts\n");
+  fprintf(stderr, "  -drift ppm                  : clock deviation of the receiver\n");
+  fprintf(stderr, "  -chunks min:max             : sizes of the received chunks (default %u:%u)\n",
+          MIN_CHUNK_SIZE, MAX_CHUNK_SIZE);
+}
+
+int main(int argc, char* argv[]) {
+  uint32_t rateFactor = 4;
+  uint32_t frameLength = 1024;
+  uint32_t numAus = DEFAULT_NUM_AUS;
+  uint32_t eventInterval = DEFAULT_EVENT_INTERVAL;
+  uint32_t seed = 0;
+  IEC61937_LINK_CONFIG custom;
+  iec61937_link_config_init(&custom);
+  custom.minChunkSize = MIN_CHUNK_SIZE;
+  custom.maxChunkSize = MAX_CHUNK_SIZE;
+  bool useCustom = false;
+  bool ok = true;
+  for (int i = 1; i < argc && ok; i++) {
+    std::string arg = argv[i];
+    if (i + 1 >= argc) {
+      ok = false;
+      break;
+    }
+    const char* value = argv[++i];
+    if (arg == "-r") {
+      rateFactor = (uint32_t)strtoul(value, NULL, 10);
+    } else if (arg == "-f") {
+      frameLength = (uint32_t)strtoul(value, NULL, 10);
+    } else if (arg == "-n") {
+      numAus = (uint32_t)strtoul(value, NULL, 10);
+    } else if (arg == "-e") {
+      eventInterval = (uint32_t)strtoul(value, NULL, 10);
+    } else if (arg == "-s") {
+      seed = (uint32_t)strtoul(value, NULL, 10);
+    } else if (arg == "-bits") {
+      custom.bitErrorInterval = strtoull(value, NULL, 10);
+      useCustom = true;
+    } else if (arg == "-slips") {
+      custom.slipInterval = (uint32_t)strtoul(value, NULL, 10);
+      useCustom = true;
+    } else if (arg == "-dropouts") {
+      ok = sscanf(value, "%u:%u", &custom.dropoutInterval, &custom.dropoutLength) == 2;
+      useCustom = true;
+    } else if (arg == "-duplicates") {
+      custom.duplicateInterval = (uint32_t)strtoul(value, NULL, 10);
+      useCustom = true;
+    } else if (arg == "-drift") {
+      custom.clockDrift = (int32_t)strtol(value, NULL, 10);
+      useCustom = true;
+    } else if (arg == "-chunks") {
+      ok = sscanf(value, "%u:%u", &custom.minChunkSize, &custom.maxChunkSize) == 2;
+      useCustom = true;
+    } else {
+      ok = false;
+    }
+  }
+  if (!ok || rateFactor == 0 || rateFactor > 255 || numAus == 0 || eventInterval == 0) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  SSentStream sent;
+  if (!createStream((uint8_t)rateFactor, frameLength, numAus, seed, sent) ||
+      !mapAusToBursts(sent)) {
+    fprintf(stderr, "Cannot create the stream\n");
+    return 1;
+  }
+
+  // PCM sample frames of two channels or of the eight channels of HBR
+  uint32_t sampleFrameSize = rateFactor >= 8 ? 16 : 4;
+  uint32_t eventBytes = eventInterval * sent.frameSize;
+  std::vector<SScenario> scenarios;
+  IEC61937_LINK_CONFIG config;
+  iec61937_link_config_init(&config);
+  config.sampleFrameSize = sampleFrameSize;
+  config.minChunkSize = MIN_CHUNK_SIZE;
+  config.maxChunkSize = MAX_CHUNK_SIZE;
+  config.seed = seed;
+  if (useCustom) {
+    custom.sampleFrameSize = sampleFrameSize;
+    custom.seed = seed;
+    scenarios.push_back({"custom", custom});
+  } else {
+    scenarios.push_back({"none", config});
+    SScenario scenario = {"chunking", config};
+    scenario.config.minChunkSize = 1;
+    scenario.config.maxChunkSize = MAX_ARBITRARY_CHUNK_SIZE;
+    scenarios.push_back(scenario);
+    scenario = {"bit_flips", config};
+    scenario.config.bitErrorInterval = (uint64_t)eventBytes * 8;
+    scenarios.push_back(scenario);
+    scenario = {"byte_slips", config};
+    scenario.config.slipInterval = eventBytes;
+    scenarios.push_back(scenario);
+    scenario = {"dropouts", config};
+    scenario.config.dropoutInterval = eventBytes;
+    scenario.config.dropoutLength = sent.frameSize / 4;
+    scenarios.push_back(scenario);
+    scenario = {"duplicates", config};
+    scenario.config.duplicateInterval = eventInterval;
+    scenarios.push_back(scenario);
+    scenario = {"drift_fast", config};
+    scenario.config.clockDrift = DRIFT_PPM;
+    scenarios.push_back(scenario);
+    scenario = {"drift_slow", config};
+    scenario.config.clockDrift = -DRIFT_PPM;
+    scenarios.push_back(scenario);
+    scenario = {"all", config};
+    scenario.config.minChunkSize = 1;
+    scenario.config.maxChunkSize = MAX_ARBITRARY_CHUNK_SIZE;
+    scenario.config.bitErrorInterval = (uint64_t)eventBytes * 8;
+    scenario.config.slipInterval = eventBytes;
+    scenario.config.dropoutInterval = eventBytes;
+    scenario.config.dropoutLength = sent.frameSize / 4;
+    scenario.config.duplicateInterval = eventInterval;
+    scenario.config.clockDrift = DRIFT_PPM;
+    scenarios.push_back(scenario);
+  }
+
+  printf(
+      "impairment,events,aus,aus_lost,aus_corrupted,aus_duplicated,decoder_errors,sync_lost,"
+      "resync_mean_ms,resync_max_ms,ns_per_byte\n");
+  for (const SScenario& scenario : scenarios) {
+    if (!runScenario(sent, scenario)) {
+      return 1;
+    }
+  }
+  return 0;
+}
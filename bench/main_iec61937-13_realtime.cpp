@@ -0,0 +1,513 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// system includes
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+// project includes
+#include "iec61937_dec.h"
+#include "iec61937_enc.h"
+#include "mhas_generator.h"
+
+/*
+ * Checks the real-time properties of the process calls (see iec61937_enc.h and iec61937_dec.h): a
+ * synthetic MHAS stream (see mhas_generator.h) is encoded AU by AU, by the encoder in the default
+ * and in the low latency mode (with an output buffer of one IEC frame, i.e. the further IEC frames
+ * are written by the following calls), and decoded chunk by chunk like in an audio
+ * callback, while malloc(), calloc(), realloc() and free() are intercepted and the time of every
+ * call is measured. The decoder runs in the default mode (iec61937_decode_process() is called
+ * until IECDEC_FEED_MORE_DATA) and in the real-time mode (a sync search budget is set with
+ * iec61937_decode_set_realtime() and at most a fixed number of process calls is made per callback)
+ * on the clean stream and on a stream with stretches of noise containing IEC headers, which makes
+ * the decoder search for the sync. Each measurement is printed as CSV:
+ *   operation,mode,scenario,calls,aus,allocations,p50,p99,max,unit
+ * decode_callback is the feed and all process calls of one callback. aus is the number of
+ * obtained MPEG-H frames, which is the same in both modes. allocations counts the intercepted
+ * calls during the measured calls (n/a if the interception is not supported by the C library).
+ * The times are TSC cycles on x86 and nanoseconds otherwise. Each stream is processed twice by
+ * the same instances and only the second pass is measured, so the first touch of the instance
+ * memory (page faults) is excluded like in an application which prefaults its memory. Preemptions
+ * show up in the maxima, so these are only meaningful with a real-time priority on an isolated CPU
+ * (e.g. chrt -f 80 taskset -c 3 iec61937-13_realtime).
+ *
+ * The program exits with an error if an allocation was intercepted.
+ */
+
+// Default number of MPEG-H frames of the stream.
+#define DEFAULT_NUM_AUS 2000
+
+// Default number of bytes fed per callback.
+#define DEFAULT_CHUNK_SIZE 16384
+
+// Default sync search budget of the real-time mode in bytes per process call.
+#define DEFAULT_BUDGET 16384
+
+// Default maximum number of process calls per callback in the real-time mode.
+#define DEFAULT_CALLS_PER_CALLBACK 4
+
+// Noise scenario: IEC frames between two stretches of noise, and their length in IEC frames.
+#define NOISE_INTERVAL 50
+#define NOISE_LENGTH 10
+
+// Sample rate used to derive the bit rate of the synthetic MPEG-H frames.
+#define REALTIME_SAMPLE_RATE 48000
+
+// Allocation interception: the definitions below replace those of the C library for the whole
+// program, including the libraries, and count the calls while armed.
+static volatile bool g_allocationsArmed = false;
+static uint64_t g_numAllocations = 0;
+
+#if defined(__GLIBC__)
+#define ALLOCATION_HOOKS_AVAILABLE 1
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void __libc_free(void* pointer);
+
+void* malloc(size_t size) noexcept {
+  if (g_allocationsArmed) {
+    g_numAllocations++;
+  }
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+  if (g_allocationsArmed) {
+    g_numAllocations++;
+  }
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) noexcept {
+  if (g_allocationsArmed) {
+    g_numAllocations++;
+  }
+  return __libc_realloc(pointer, size);
+}
+
+void free(void* pointer) noexcept {
+  if (g_allocationsArmed && pointer != NULL) {
+    g_numAllocations++;
+  }
+  __libc_free(pointer);
+}
+}
+#else
+#define ALLOCATION_HOOKS_AVAILABLE 0
+#endif
+
+// Returns a time stamp: TSC cycles on x86, otherwise nanoseconds.
+static inline uint64_t readTimer() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define TIMER_UNIT "cycles"
+#else
+#define TIMER_UNIT "ns"
+#endif
+
+// Times and intercepted allocations of the measured calls of one operation.
+struct SCallStats {
+  std::vector<uint64_t> times;
+  uint64_t numAllocations;
+};
+
+// Measures one call of an operation: arms the allocation interception around it.
+template <class Call>
+static auto measureCall(SCallStats* stats, Call call) -> decltype(call()) {
+  uint64_t numAllocations = g_numAllocations;
+  uint64_t start = readTimer();
+  g_allocationsArmed = true;
+  auto result = call();
+  g_allocationsArmed = false;
+  uint64_t time = readTimer() - start;
+  if (stats != NULL) {
+    stats->times.push_back(time);
+    stats->numAllocations += g_numAllocations - numAllocations;
+  }
+  return result;
+}
+
+// Returns the percentile p (0 - 1) of sorted values.
+static uint64_t percentile(const std::vector<uint64_t>& sorted, double p) {
+  size_t index = (size_t)(p * sorted.size() + 0.5);
+  return sorted[std::min(std::max<size_t>(index, 1), sorted.size()) - 1];
+}
+
+static uint64_t g_totalAllocations = 0;
+
+static void printCallStats(const char* operation, const char* mode, const char* scenario,
+                           uint64_t numAus, SCallStats& stats) {
+  std::sort(stats.times.begin(), stats.times.end());
+  g_totalAllocations += stats.numAllocations;
+  std::string allocations =
+      ALLOCATION_HOOKS_AVAILABLE ? std::to_string(stats.numAllocations) : std::string("n/a");
+  if (stats.times.empty()) {
+    printf("%s,%s,%s,0,%llu,%s,n/a,n/a,n/a,%s\n", operation, mode, scenario,
+           (unsigned long long)numAus, allocations.c_str(), TIMER_UNIT);
+    return;
+  }
+  printf("%s,%s,%s,%zu,%llu,%s,%llu,%llu,%llu,%s\n", operation, mode, scenario,
+         stats.times.size(), (unsigned long long)numAus, allocations.c_str(),
+         (unsigned long long)percentile(stats.times, 0.5),
+         (unsigned long long)percentile(stats.times, 0.99),
+         (unsigned long long)stats.times.back(), TIMER_UNIT);
+}
+
+// Creates the MPEG-H frames with exponentially distributed sizes at 50% of the capacity of the
+// IEC frames.
+static bool createAus(uint32_t frameSize, uint32_t frameLength, uint32_t numAus, uint32_t seed,
+                      std::vector<std::vector<uint8_t>>& aus, std::vector<uint32_t>& durations) {
+  MHAS_GEN_CONFIG generatorConfig;
+  mhas_generator_config_init(&generatorConfig);
+  generatorConfig.bitrate =
+      (uint32_t)((uint64_t)frameSize / 2 * 8 * REALTIME_SAMPLE_RATE / frameLength);
+  generatorConfig.sizes = MHAS_GEN_SIZES_EXPONENTIAL;
+  generatorConfig.maxAuSize = std::min<uint32_t>(frameSize * 8 / 10, MHAS_MAX_AU_SIZE);
+  generatorConfig.seed = seed;
+  HANDLE_MHAS_GENERATOR generator = mhas_generator_open(&generatorConfig);
+  if (generator == NULL) {
+    return false;
+  }
+  bool ok = true;
+  for (uint32_t i = 0; i < numAus && ok; i++) {
+    std::vector<uint8_t> au(MHAS_MAX_AU_SIZE);
+    uint32_t length = (uint32_t)au.size();
+    uint32_t duration = 0;
+    bool isRap = false;
+    ok = mhas_generator_process(generator, au.data(), &length, &duration, &isRap) == MHAS_OK;
+    au.resize(length);
+    aus.push_back(au);
+    durations.push_back(duration);
+  }
+  mhas_generator_close(generator);
+  return ok;
+}
+
+// Encodes the MPEG-H frames twice with one encoder instance and measures the process calls of the
+// second pass, whose output is the stream.
+static bool measureEncode(HANDLE_IEC61937_ENCODER encoder,
+                          const std::vector<std::vector<uint8_t>>& aus,
+                          const std::vector<uint32_t>& durations, std::vector<uint8_t>& stream,
+                          SCallStats& process) {
+  std::vector<uint8_t> frame(iec61937_encode_get_frame_size(encoder));
+  for (int pass = 0; pass < 2; pass++) {
+    for (size_t i = 0; i < aus.size(); i++) {
+      bool processed = false;
+      while (!processed) {
+        uint32_t frameBytes = (uint32_t)frame.size();
+        IECENC_RESULT err = measureCall(pass == 1 ? &process : NULL, [&]() {
+          return iec61937_encode_process(encoder, aus[i].data(), (uint32_t)aus[i].size(),
+                                         &processed, durations[i], frame.data(), &frameBytes);
+        });
+        if (err != IECENC_OK) {
+          fprintf(stderr, "encoding failed (%d)\n", err);
+          return false;
+        }
+        if (pass == 1) {
+          stream.insert(stream.end(), frame.begin(), frame.begin() + frameBytes);
+        }
+      }
+    }
+  }
+  return true;
+}
+
+// Inserts stretches of random data after every NOISE_INTERVAL IEC frames. The noise contains
+// copies of the IEC header of the previous IEC frame, so the decoder also checks sync candidates.
+static std::vector<uint8_t> addNoise(const std::vector<uint8_t>& stream, uint32_t frameSize,
+                                     uint32_t seed) {
+  std::vector<uint8_t> noisy;
+  uint32_t state = seed * 2654435761u + 1;
+  for (size_t offset = 0; offset < stream.size(); offset += frameSize) {
+    size_t end = std::min(offset + frameSize, stream.size());
+    noisy.insert(noisy.end(), stream.begin() + offset, stream.begin() + end);
+    if ((offset / frameSize) % NOISE_INTERVAL != NOISE_INTERVAL - 1) {
+      continue;
+    }
+    size_t noiseStart = noisy.size();
+    for (uint32_t i = 0; i < NOISE_LENGTH * frameSize; i++) {
+      state = state * 1664525u + 1013904223u;
+      noisy.push_back((uint8_t)(state >> 24));
+    }
+    for (size_t i = noiseStart; i + 8 <= noisy.size(); i += frameSize / 4) {
+      std::copy(stream.begin() + offset, stream.begin() + offset + 8, noisy.begin() + i);
+    }
+  }
+  return noisy;
+}
+
+// Decodes the stream twice with one decoder instance in callbacks of chunkSize bytes and measures
+// the calls of the second pass. A budget of 0 selects the default mode.
+static bool measureDecode(const std::vector<uint8_t>& stream, uint32_t chunkSize, uint32_t budget,
+                          uint32_t callsPerCallback, SCallStats& feed, SCallStats& process,
+                          SCallStats& callback, uint64_t* numAus) {
+  HANDLE_IEC61937_DECODER decoder = iec61937_decode_open();
+  if (decoder == NULL) {
+    return false;
+  }
+  iec61937_decode_set_realtime(decoder, budget);
+  std::vector<uint8_t> auBuffer(MAX_MPEGH_FRAME_SIZE);
+  *numAus = 0;
+  bool ok = true;
+  for (int pass = 0; pass < 2 && ok; pass++) {
+    for (size_t offset = 0; offset < stream.size() && ok; offset += chunkSize) {
+      uint32_t length = (uint32_t)std::min<size_t>(chunkSize, stream.size() - offset);
+      uint64_t callbackStart = readTimer();
+      IECDEC_RESULT err = measureCall(pass == 1 ? &feed : NULL, [&]() {
+        return iec61937_decode_feed(decoder, stream.data() + offset, length);
+      });
+      if (err != IECDEC_OK) {
+        fprintf(stderr, "feeding failed (%d), the decoder falls behind\n", err);
+        ok = false;
+        break;
+      }
+      for (uint32_t call = 0; budget == 0 || call < callsPerCallback; call++) {
+        uint32_t auLength = (uint32_t)auBuffer.size();
+        int32_t pcmOffset = 0;
+        uint32_t iecFrameLength = 0;
+        bool iecFrameProcessed = false;
+        err = measureCall(pass == 1 ? &process : NULL, [&]() {
+          return iec61937_decode_process(decoder, auBuffer.data(), &auLength, &pcmOffset,
+                                         &iecFrameLength, &iecFrameProcessed);
+        });
+        if (err == IECDEC_FEED_MORE_DATA) {
+          break;
+        }
+        if (err != IECDEC_OK && err != IECDEC_PENDINGDATA_ERROR &&
+            err != IECDEC_BUDGET_EXHAUSTED) {
+          fprintf(stderr, "decoding failed (%d)\n", err);
+          ok = false;
+          break;
+        }
+        if (pass == 1 && auLength > 0) {
+          (*numAus)++;
+        }
+      }
+      if (pass == 1) {
+        callback.times.push_back(readTimer() - callbackStart);
+      }
+    }
+  }
+  callback.numAllocations = feed.numAllocations + process.numAllocations;
+  iec61937_decode_close(decoder);
+  return ok;
+}
+
+static void printUsage(const char* name) {
+  fprintf(stderr, "Usage: %s [options]\n", name);
+  fprintf(stderr, "  -r rate factor              : rate factor of the stream (default 16)\n");
+  fprintf(stderr, "  -f frame length             : IEC frame length in samples (default 1024)\n");
+  fprintf(stderr, "  -n frames                   : MPEG-H frames of the stream (default %u)\n",
+          DEFAULT_NUM_AUS);
+  fprintf(stderr, "  -c chunk size               : bytes fed per callback (default %u)\n",
+          DEFAULT_CHUNK_SIZE);
+  fprintf(stderr, "  -b budget                   : sync search budget of the real-time mode in\n");
+  fprintf(stderr, "                                bytes per process call (default %u)\n",
+          DEFAULT_BUDGET);
+  fprintf(stderr, "  -k calls                    : process calls per callback in the real-time\n");
+  fprintf(stderr, "                                mode (default %u)\n",
+          DEFAULT_CALLS_PER_CALLBACK);
+  fprintf(stderr, "  -s seed                     : seed of the stream and the noise\n");
+}
+
+int main(int argc, char* argv[]) {
+  uint32_t rateFactor = 16;
+  uint32_t frameLength = 1024;
+  uint32_t numAus = DEFAULT_NUM_AUS;
+  uint32_t chunkSize = DEFAULT_CHUNK_SIZE;
+  uint32_t budget = DEFAULT_BUDGET;
+  uint32_t callsPerCallback = DEFAULT_CALLS_PER_CALLBACK;
+  uint32_t seed = 0;
+  bool ok = true;
+  for (int i = 1; i < argc && ok; i++) {
+    std::string arg = argv[i];
+    if (i + 1 >= argc) {
+      ok = false;
+      break;
+    }
+    uint32_t value = (uint32_t)strtoul(argv[++i], NULL, 10);
+    if (arg == "-r") {
+      rateFactor = value;
+    } else if (arg == "-f") {
+      frameLength = value;
+    } else if (arg == "-n") {
+      numAus = value;
+    } else if (arg == "-c") {
+      chunkSize = value;
+    } else if (arg == "-b") {
+      budget = value;
+    } else if (arg == "-k") {
+      callsPerCallback = value;
+    } else if (arg == "-s") {
+      seed = value;
+    } else {
+      ok = false;
+    }
+  }
+  if (!ok || rateFactor == 0 || rateFactor > 255 || numAus == 0 || chunkSize == 0 ||
+      budget == 0 || callsPerCallback == 0) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  IEC61937_ENC_CONFIG encoderConfig;
+  iec61937_encode_config_init(&encoderConfig);
+  encoderConfig.rateFactor = (uint8_t)rateFactor;
+  encoderConfig.audioFrameLength = frameLength;
+  HANDLE_IEC61937_ENCODER encoder = iec61937_encode_open_config(&encoderConfig);
+  encoderConfig.lowLatency = true;
+  HANDLE_IEC61937_ENCODER lowLatencyEncoder = iec61937_encode_open_config(&encoderConfig);
+  if (encoder == NULL || lowLatencyEncoder == NULL) {
+    fprintf(stderr, "Cannot open the encoder\n");
+    iec61937_encode_close(encoder);
+    iec61937_encode_close(lowLatencyEncoder);
+    return 1;
+  }
+  uint32_t frameSize = iec61937_encode_get_frame_size(encoder);
+  std::vector<std::vector<uint8_t>> aus;
+  std::vector<uint32_t> durations;
+  std::vector<uint8_t> stream;
+  std::vector<uint8_t> lowLatencyStream;
+  SCallStats encodeProcess = SCallStats();
+  SCallStats lowLatencyProcess = SCallStats();
+  ok = createAus(frameSize, frameLength, numAus, seed, aus, durations) &&
+       measureEncode(encoder, aus, durations, stream, encodeProcess) &&
+       measureEncode(lowLatencyEncoder, aus, durations, lowLatencyStream, lowLatencyProcess);
+  iec61937_encode_close(encoder);
+  iec61937_encode_close(lowLatencyEncoder);
+  if (!ok) {
+    fprintf(stderr, "Cannot create the stream\n");
+    return 1;
+  }
+
+  printf("operation,mode,scenario,calls,aus,allocations,p50,p99,max,unit\n");
+  printCallStats("encode_process", "default", "clean", numAus, encodeProcess);
+  printCallStats("encode_process", "low_latency", "clean", numAus, lowLatencyProcess);
+
+  const char* scenarios[] = {"clean", "noise"};
+  for (int s = 0; s < 2 && ok; s++) {
+    std::vector<uint8_t> input = (s == 0) ? stream : addNoise(stream, frameSize, seed);
+    for (int realtime = 0; realtime < 2 && ok; realtime++) {
+      const char* mode = realtime ? "realtime" : "default";
+      SCallStats feed = SCallStats();
+      SCallStats process = SCallStats();
+      SCallStats callback = SCallStats();
+      uint64_t numDecodedAus = 0;
+      ok = measureDecode(input, chunkSize, realtime ? budget : 0, callsPerCallback, feed, process,
+                         callback, &numDecodedAus);
+      if (ok) {
+        printCallStats("decode_feed", mode, scenarios[s], numDecodedAus, feed);
+        printCallStats("decode_process", mode, scenarios[s], numDecodedAus, process);
+        printCallStats("decode_callback", mode, scenarios[s], numDecodedAus, callback);
+      }
+      fflush(stdout);
+    }
+  }
+  if (!ok) {
+    return 1;
+  }
+  if (g_totalAllocations > 0) {
+    fprintf(stderr, "%llu allocations in the measured calls\n",
+            (unsigned long long)g_totalAllocations);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,266 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+#if !defined(PERF_COUNTERS_H)
+#define PERF_COUNTERS_H
+
+/**
+ * @file   perf_counters.h
+ * @brief  Hardware performance counters of the calling thread for the benchmark.
+ *
+ * The counters are opened with perf_event_open() and count user space only, so the benchmark runs
+ * with the default perf_event_paranoid setting. Each counter is opened on its own: a counter which
+ * the CPU, the hypervisor or the container does not provide is reported as unavailable while the
+ * others keep counting. On other systems than Linux all counters are unavailable. The elapsed time
+ * is taken from the monotonic clock and is always available.
+ *
+ * A measured section is enclosed by start() and stop(), which read the counters. The cost of the
+ * reads is measured once and subtracted, so short sections like a single API call can be measured.
+ */
+
+// system includes
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+enum EPerfCounter {
+  PERF_COUNTER_CYCLES,
+  PERF_COUNTER_INSTRUCTIONS,
+  PERF_COUNTER_CACHE_MISSES, /* last level cache */
+  PERF_COUNTER_DTLB_MISSES,  /* data TLB read misses */
+  PERF_COUNTER_BRANCH_MISSES,
+  PERF_NUM_COUNTERS
+};
+
+// Number of empty sections used to measure the cost of start() and stop()
+#define PERF_COUNTERS_NUM_CALIBRATIONS 1000
+
+class CPerfCounters {
+ private:
+  typedef std::chrono::steady_clock Clock;
+
+  int m_fd[PERF_NUM_COUNTERS];
+  int m_error; /* errno of the first counter which could not be opened */
+  uint64_t m_numSections;
+  double m_start[PERF_NUM_COUNTERS];
+  double m_total[PERF_NUM_COUNTERS];
+  double m_overhead[PERF_NUM_COUNTERS]; /* per section */
+  Clock::time_point m_startTime;
+  double m_totalNs;
+  double m_overheadNs; /* per section */
+
+  // Reads all available counters. Values of multiplexed counters are scaled to the full time.
+  void readCounters(double* values) const {
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+      values[i] = 0;
+#if defined(__linux__)
+      uint64_t data[3]; /* value, time enabled, time running */
+      if (m_fd[i] >= 0 && read(m_fd[i], data, sizeof(data)) == (ssize_t)sizeof(data)) {
+        values[i] = (double)data[0];
+        if (data[2] > 0 && data[2] < data[1]) {
+          values[i] *= (double)data[1] / data[2];
+        }
+      }
+#endif
+    }
+  }
+
+  void openCounter(EPerfCounter counter, uint32_t type, uint64_t config) {
+    m_fd[counter] = -1;
+#if defined(__linux__)
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    m_fd[counter] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+    if (m_fd[counter] < 0 && m_error == 0) {
+      m_error = errno;
+    }
+#else
+    (void)type;
+    (void)config;
+    m_error = ENOSYS;
+#endif
+  }
+
+ public:
+  CPerfCounters() : m_error(0) {
+#if defined(__linux__)
+    openCounter(PERF_COUNTER_CYCLES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    openCounter(PERF_COUNTER_INSTRUCTIONS, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    openCounter(PERF_COUNTER_CACHE_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    openCounter(PERF_COUNTER_DTLB_MISSES, PERF_TYPE_HW_CACHE,
+                PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                    (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    openCounter(PERF_COUNTER_BRANCH_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#else
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+      openCounter((EPerfCounter)i, 0, 0);
+    }
+#endif
+
+    // measure the cost of an empty section
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+      m_overhead[i] = 0;
+    }
+    m_overheadNs = 0;
+    clear();
+    for (int i = 0; i < PERF_COUNTERS_NUM_CALIBRATIONS; i++) {
+      start();
+      stop();
+    }
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+      m_overhead[i] = m_total[i] / PERF_COUNTERS_NUM_CALIBRATIONS;
+    }
+    m_overheadNs = m_totalNs / PERF_COUNTERS_NUM_CALIBRATIONS;
+    clear();
+  }
+
+  ~CPerfCounters() {
+#if defined(__linux__)
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+      if (m_fd[i] >= 0) {
+        close(m_fd[i]);
+      }
+    }
+#endif
+  }
+
+  CPerfCounters(const CPerfCounters&) = delete;
+  CPerfCounters& operator=(const CPerfCounters&) = delete;
+
+  bool isAvailable(EPerfCounter counter) const { return m_fd[counter] >= 0; }
+
+  // errno of the first counter which could not be opened or 0 if all counters are available
+  int error() const { return m_error; }
+
+  void clear() {
+    m_numSections = 0;
+    m_totalNs = 0;
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+      m_total[i] = 0;
+    }
+  }
+
+  void start() {
+    readCounters(m_start);
+    m_startTime = Clock::now();
+  }
+
+  void stop() {
+    Clock::time_point stopTime = Clock::now();
+    double values[PERF_NUM_COUNTERS];
+    readCounters(values);
+    m_totalNs += std::chrono::duration<double, std::nano>(stopTime - m_startTime).count();
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+      m_total[i] += values[i] - m_start[i];
+    }
+    m_numSections++;
+  }
+
+  uint64_t numSections() const { return m_numSections; }
+
+  // Sum of all sections since clear() without the cost of start() and stop()
+  double value(EPerfCounter counter) const {
+    double value = m_total[counter] - m_numSections * m_overhead[counter];
+    return value > 0 ? value : 0;
+  }
+
+  // Elapsed time of all sections since clear() in ns
+  double nanoseconds() const {
+    double value = m_totalNs - m_numSections * m_overheadNs;
+    return value > 0 ? value : 0;
+  }
+};
+
+#endif /* !defined(PERF_COUNTERS_H) */
@@ -233,13 +233,10 @@ class CProcessor {
       uint64_t inputDataRead = m_inFile.gcount();
       inputBuffer.resize(inputDataRead);
 
-      if (m_swapBytes) {
-        // Reorder Bytes
-        for (uint64_t i = 0; i < inputDataRead; i += 2) {
-          std::swap(inputBuffer.at(i), inputBuffer.at(i + 1));
-        }
-      }
-      err = iec61937_decode_feed(m_decoder, inputBuffer.data(), inputDataRead);
+      // the decoder swaps the byte order while copying into its work buffer
+      err = iec61937_decode_feed_format(
+          m_decoder, inputBuffer.data(), inputDataRead,
+          m_swapBytes ? IEC61937_PCM_FORMAT_S16_LE : IEC61937_PCM_FORMAT_S16_BE);
       if (err != IECDEC_OK) {
         throw std::runtime_error("ERROR: Unable to feed data to the IEC decoder!");
       }
@@ -83,6 +83,12 @@ amm-info@iis.fraunhofer.de
 // system includes
 #include <string>
 #include <iostream>
+#include <memory>
+#include <cstdio>
+#if defined(__unix__) || defined(__APPLE__)
+#include <errno.h>
+#include <unistd.h>
+#endif
 
 // external includes
 #include "ilo/memory.h"
@@ -95,52 +101,252 @@ amm-info@iis.fraunhofer.de
 
 // project includes
 #include "iec61937_enc.h"
+#include "mhas_framer.h"
+#include "paced_output.h"
+#include "sparse_file_writer.h"
 
 using namespace mmt::isobmff;
 
+// Size of the chunks read from a raw MHAS input
+#define MHAS_READ_CHUNK_SIZE 4096
+
+// Reads up to length bytes; returns as soon as some data is available, so data arriving through a
+// pipe is processed without waiting for a complete chunk. Returns 0 at the end of the input.
+static size_t readInput(FILE* input, uint8_t* data, size_t length) {
+#if defined(__unix__) || defined(__APPLE__)
+  while (true) {
+    ssize_t bytesRead = ::read(fileno(input), data, length);
+    if (bytesRead < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::runtime_error("ERROR: Cannot read input file!");
+    }
+    return static_cast<size_t>(bytesRead);
+  }
+#else
+  size_t bytesRead = fread(data, 1, length, input);
+  if (bytesRead == 0 && ferror(input)) {
+    throw std::runtime_error("ERROR: Cannot read input file!");
+  }
+  return bytesRead;
+#endif
+}
+
 class CProcessor {
  private:
-  CIsobmffReader m_reader;
-  std::ofstream m_outFile;
-  bool m_swapBytes;
+  std::string m_inputFilename;
+  std::unique_ptr<CIsobmffReader> m_reader;
+  FILE* m_mhasInput;
+  HANDLE_MHAS_FRAMER m_framer;
+  CSparseFileWriter m_outFile;
+  std::unique_ptr<CPacedOutput> m_pacer;
+  IEC61937_ENC_CONFIG m_encoderConfig;
   HANDLE_IEC61937_ENCODER m_encoder;
+  uint32_t m_mhasPeakAuSize;
 
  public:
   CProcessor(std::string& inputFilename, std::string& outputFilename, uint32_t factor,
-             bool swapBytes)
-      : m_reader(ilo::make_unique<CIsobmffFileInput>(inputFilename)),
-        m_outFile(outputFilename, std::ios::out | std::ios::binary),
-        m_swapBytes(swapBytes) {
-    m_encoder = iec61937_encode_open(factor);
-    if (m_encoder == nullptr) {
-      throw std::runtime_error("ERROR: IEC61937-13 encoder could not be created!");
-    }
-    if (!m_outFile) {
+             uint32_t frameLength, bool swapBytes, bool sparseOutput, uint32_t pacingSampleRate,
+             uint32_t mhasPeakAuSize)
+      : m_inputFilename(inputFilename),
+        m_mhasInput(nullptr),
+        m_framer(nullptr),
+        m_outFile(outputFilename, sparseOutput),
+        m_pacer(pacingSampleRate > 0 ? ilo::make_unique<CPacedOutput>(frameLength, pacingSampleRate)
+                                     : nullptr),
+        m_encoder(nullptr),
+        m_mhasPeakAuSize(mhasPeakAuSize) {
+    iec61937_encode_config_init(&m_encoderConfig);
+    m_encoderConfig.rateFactor = static_cast<uint8_t>(factor);
+    m_encoderConfig.audioFrameLength = frameLength;
+    // let the encoder write the swapped byte order directly into the output buffer
+    m_encoderConfig.outputFormat =
+        swapBytes ? IEC61937_PCM_FORMAT_S16_LE : IEC61937_PCM_FORMAT_S16_BE;
+    if (!m_outFile.good()) {
       throw std::runtime_error("ERROR: Cannot open output file!");
     }
   }
 
+  void writeOutput(ilo::ByteBuffer& iecOutputData, uint32_t iecOutputBytes) {
+    if (iecOutputBytes == 0) {
+      return;
+    }
+    if (m_pacer) {
+      // each call of the encoder provides at most one IEC61937-13 frame
+      m_pacer->waitForNextFrame();
+      m_outFile.write(iecOutputData.data(), iecOutputBytes * sizeof(uint8_t));
+      m_outFile.flush();
+    } else {
+      m_outFile.write(iecOutputData.data(), iecOutputBytes * sizeof(uint8_t));
+    }
+  }
+
   ~CProcessor() {
     if (m_encoder != nullptr) {
       iec61937_encode_close(m_encoder);
     }
-    if (m_outFile) {
-      m_outFile.close();
-      if (!m_outFile.good()) {
-        std::cout << "Error occurred at writing output file!" << std::endl;
+    if (m_framer != nullptr) {
+      mhas_framer_close(m_framer);
+    }
+    if (m_mhasInput != nullptr && m_mhasInput != stdin) {
+      fclose(m_mhasInput);
+    }
+    if (m_pacer) {
+      m_pacer->printStatistics(std::cout);
+    }
+    if (m_outFile.isSparse()) {
+      std::cout << "Bytes stored as file holes: " << m_outFile.holeBytes() << std::endl;
+    }
+    if (!m_outFile.close()) {
+      std::cout << "Error occurred at writing output file!" << std::endl;
+    }
+  }
+
+  // A raw MHAS stream is read from stdin ("-") or from files with the extension ".mhas"
+  static bool isMhasInput(const std::string& filename) {
+    const std::string extension = ".mhas";
+    return filename == "-" ||
+           (filename.size() > extension.size() &&
+            filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0);
+  }
+
+  void openEncoder(uint32_t maxAuSize, uint32_t auDuration) {
+    // In case of automatic rate factor selection, maxAuSize is used as the peak MPEG-H frame size
+    // and auDuration as the MPEG-H frame duration (0 keeps the default).
+    m_encoderConfig.maxAuSize = maxAuSize;
+    if (auDuration > 0) {
+      m_encoderConfig.auDuration = auDuration;
+    }
+    m_encoder = iec61937_encode_open_config(&m_encoderConfig);
+    if (m_encoder == nullptr && m_encoderConfig.rateFactor == 0) {
+      throw std::runtime_error("ERROR: No samplerate factor carries the peak MPEG-H frame size!");
+    }
+    if (m_encoder == nullptr) {
+      throw std::runtime_error("ERROR: IEC61937-13 encoder could not be created!");
+    }
+    std::cout << "IEC61937-13 frame size  : " << iec61937_encode_get_frame_size(m_encoder)
+              << " Bytes" << std::endl;
+    std::cout << std::endl;
+  }
+
+  void encodeFrame(ilo::ByteBuffer& iecOutputData, const uint8_t* auData, uint32_t auLength,
+                   uint32_t auDuration) {
+    // Get as many output frames as possible.
+    bool fReadMoreData = false;
+    while (!fReadMoreData) {
+      uint32_t iecOutputBytes = MAX_IEC61937_FRAME_SIZE_BYTES;
+      // Encode into iec61937-13 format
+      IECENC_RESULT returnValue =
+          iec61937_encode_process(m_encoder, auData, auLength, &fReadMoreData, auDuration,
+                                  iecOutputData.data(), &iecOutputBytes);
+      if (returnValue != IECENC_OK) {
+        throw std::runtime_error(
+            "ERROR: Internal buffer too small or rate factor too small or duration exceeds "
+            "maximum.");
       }
+
+      // Write to data file
+      writeOutput(iecOutputData, iecOutputBytes);
     }
   }
 
+  void flushEncoder(ilo::ByteBuffer& iecOutputData) {
+    // Write the MPEG-H frames still stored in the encoder
+    uint32_t iecOutputBytes = 0;
+    do {
+      iecOutputBytes = MAX_IEC61937_FRAME_SIZE_BYTES;
+      IECENC_RESULT returnValue =
+          iec61937_encode_flush(m_encoder, iecOutputData.data(), &iecOutputBytes);
+      if (returnValue != IECENC_OK) {
+        throw std::runtime_error("ERROR: Flushing the IEC61937-13 encoder failed.");
+      }
+      writeOutput(iecOutputData, iecOutputBytes);
+    } while (iecOutputBytes > 0);
+  }
+
   void process() {
+    if (isMhasInput(m_inputFilename)) {
+      processMhas();
+    } else {
+      processMp4();
+    }
+  }
+
+  void processMhas() {
+    m_mhasInput = (m_inputFilename == "-") ? stdin : fopen(m_inputFilename.c_str(), "rb");
+    if (m_mhasInput == nullptr) {
+      throw std::runtime_error("ERROR: Cannot open input file!");
+    }
+    m_framer = mhas_framer_open();
+    if (m_framer == nullptr) {
+      throw std::runtime_error("ERROR: MHAS framer could not be created!");
+    }
+
+    // The peak MPEG-H frame size of a raw MHAS stream is not known in advance. The automatic rate
+    // factor selection needs it from the command line, because no rate factor carries MPEG-H
+    // frames of MHAS_MAX_AU_SIZE.
+    if (m_encoderConfig.rateFactor == 0 && m_mhasPeakAuSize == 0) {
+      throw std::runtime_error(
+          "ERROR: Samplerate factor 0 requires the peak MPEG-H frame size for raw MHAS input!");
+    }
+    uint32_t peakAuSize = (m_mhasPeakAuSize > 0) ? m_mhasPeakAuSize : MHAS_MAX_AU_SIZE;
+    std::cout << "Reading raw MHAS stream" << std::endl;
+    std::cout << "########################################" << std::endl;
+
+    uint8_t readBuffer[MHAS_READ_CHUNK_SIZE];
+    ilo::ByteBuffer auData(MHAS_MAX_AU_SIZE);
+    ilo::ByteBuffer iecOutputData(MAX_IEC61937_FRAME_SIZE_BYTES);
+    uint64_t auCounter = 0;
+
+    size_t bytesRead = 0;
+    while ((bytesRead = readInput(m_mhasInput, readBuffer, sizeof(readBuffer))) > 0) {
+      if (mhas_framer_feed(m_framer, readBuffer, static_cast<uint32_t>(bytesRead)) != MHAS_OK) {
+        throw std::runtime_error("ERROR: MHAS framer buffer full!");
+      }
+      // Encode all MPEG-H frames completed by the new data
+      while (true) {
+        uint32_t auLength = static_cast<uint32_t>(auData.size());
+        uint32_t auDuration = 0;
+        MHAS_RESULT result = mhas_framer_process(m_framer, auData.data(), &auLength, &auDuration);
+        if (result == MHAS_FEED_MORE_DATA) {
+          break;
+        }
+        if (result != MHAS_OK) {
+          throw std::runtime_error("ERROR: MPEG-H frame exceeds the maximum size!");
+        }
+        if (auLength > peakAuSize) {
+          throw std::runtime_error("ERROR: MPEG-H frame exceeds the peak MPEG-H frame size!");
+        }
+        // The encoder is created with the duration of the first MPEG-H frame of the stream.
+        if (m_encoder == nullptr) {
+          openEncoder(peakAuSize, auDuration);
+        }
+        encodeFrame(iecOutputData, auData.data(), auLength, auDuration);
+
+        auCounter++;
+        std::cout << "MPEG-H frames processed: " << auCounter << "\r" << std::flush;
+      }
+    }
+    if (auCounter == 0) {
+      throw std::runtime_error("No data to encode found!");
+    }
+    flushEncoder(iecOutputData);
+    std::cout << std::endl;
+  }
+
+  void processMp4() {
+    m_reader =
+        ilo::make_unique<CIsobmffReader>(ilo::make_unique<CIsobmffFileInput>(m_inputFilename));
+
     // Only the first MPEG-H mhm1 track will be processed. Further MPEG-H mhm1 tracks will be
     // skipped!
     bool mhmTrackAlreadyProcessed = false;
 
     // Getting some information about the available tracks
-    std::cout << "Found " << m_reader.trackCount() << " tracks in input file." << std::endl;
+    std::cout << "Found " << m_reader->trackCount() << " tracks in input file." << std::endl;
 
-    for (const auto& trackInfo : m_reader.trackInfos()) {
+    for (const auto& trackInfo : m_reader->trackInfos()) {
       std::cout << "########################################" << std::endl;
       std::cout << "-TrackInfo: " << std::endl;
       std::cout << "-- ID       : " << trackInfo.trackId << std::endl;
@@ -168,7 +374,7 @@ class CProcessor {
 
       // Create a generic track reader for track number i
       std::unique_ptr<CGenericTrackReader> trackReader =
-          m_reader.trackByIndex<CGenericTrackReader>(trackInfo.trackIndex);
+          m_reader->trackByIndex<CGenericTrackReader>(trackInfo.trackIndex);
 
       if (trackReader == nullptr) {
         std::cout << "Error: Track reader could not be created!" << std::endl;
@@ -184,48 +390,28 @@ class CProcessor {
       std::cout << "Total number of samples: " << trackInfo.sampleCount << std::endl;
       std::cout << std::endl;
 
-      std::cout << "Reading all samples of this track" << std::endl;
-      std::cout << "########################################" << std::endl;
-
       // Preallocate the sample with max sample size to avoid reallocation of memory.
       // Sample can be re-used for each nextSample call.
       CSample sample{trackInfo.maxSampleSize};
 
+      // Get all samples in order. Each call fetches the next sample.
+      trackReader->nextSample(sample);
+
+      // The encoder is created as soon as the track is known. In case of automatic rate factor
+      // selection, the maximum sample size of the track is used as the peak MPEG-H frame size and
+      // the duration of the first sample as the MPEG-H frame duration.
+      openEncoder(trackInfo.maxSampleSize, static_cast<uint32_t>(sample.duration));
+
+      std::cout << "Reading all samples of this track" << std::endl;
+      std::cout << "########################################" << std::endl;
+
       uint64_t sampleCounter = 0;
       ilo::ByteBuffer iecOutputData(MAX_IEC61937_FRAME_SIZE_BYTES);
-      uint32_t iecOutputBytes = 0;
-      IECENC_RESULT returnValue = IECENC_OK;
 
-      // Get all samples in order. Each call fetches the next sample.
-      trackReader->nextSample(sample);
       while (!sample.empty()) {
-        // Get as many output frames as possible.
-        bool fReadMoreData = false;
-        while (!fReadMoreData) {
-          iecOutputBytes = MAX_IEC61937_FRAME_SIZE_BYTES;
-          // Encode into iec61937-13 format
-          returnValue = iec61937_encode_process(
-              m_encoder, sample.rawData.data(), sample.rawData.size(), &fReadMoreData,
-              sample.duration, iecOutputData.data(), &iecOutputBytes);
-          if (returnValue != IECENC_OK) {
-            throw std::runtime_error(
-                "ERROR: Internal buffer too small or rate factor too small or duration exceeds "
-                "maximum.");
-          }
-
-          // Write to data file
-          if (iecOutputBytes > 0) {
-            if (m_swapBytes) {
-              // Reorder Bytes
-              for (uint32_t i = 0; i < iecOutputBytes; i += 2) {
-                std::swap(iecOutputData.at(i), iecOutputData.at(i + 1));
-              }
-            }
-
-            m_outFile.write(reinterpret_cast<const char*>(iecOutputData.data()),
-                            iecOutputBytes * sizeof(uint8_t));
-          }
-        }
+        encodeFrame(iecOutputData, sample.rawData.data(),
+                    static_cast<uint32_t>(sample.rawData.size()),
+                    static_cast<uint32_t>(sample.duration));
 
         sampleCounter++;
         std::cout << "Samples processed: " << sampleCounter << "\r" << std::flush;
@@ -233,6 +419,8 @@ class CProcessor {
         trackReader->nextSample(sample);
       }
 
+      flushEncoder(iecOutputData);
+
       mhmTrackAlreadyProcessed = true;
 
       std::cout << std::endl;
@@ -260,14 +448,37 @@ int main(int argc, char** argv) {
   // Configure mmtisobmff logging to your liking (logging to file, system, console or disable)
   disableLogging();
 
-  if (argc != 5) {
+  if (argc < 5 || argc > 9) {
     std::cout << "Usage: IEC61937-13_encoder_example <inputFile-URI> <outputFile-URI> <samplerate "
-                 "factor> <swap byte order flag>"
+                 "factor> <swap byte order flag> [frame length] [sparse output flag] [pacing "
+                 "samplerate] [peak frame size]"
+              << std::endl;
+    std::cout << "  inputFile-URI        : MP4 file with an mhm1 track, raw MHAS stream with the "
+                 "extension .mhas or - to read a raw MHAS stream from stdin"
+              << std::endl;
+    std::cout << "  samplerate factor    : 2, 4, 8, 16, 1 for non-HBR audio mode 0 or 0 to select "
+                 "the smallest suitable factor"
               << std::endl;
-    std::cout << "  samplerate factor    : 4 or 16" << std::endl;
     std::cout << "  swap byte order flag : 1 to swap pairwise, 0 to keep the byte order"
               << std::endl;
     std::cout << "    NOTE: the default byte order is Big-Endian" << std::endl;
+    std::cout << "  frame length         : 768, 1024, 1536, 2048, 3072 or 4096 (default: 1024)"
+              << std::endl;
+    std::cout << "  sparse output flag   : 1 to store zero padding as file holes, 0 to write all "
+                 "bytes (default: 0)"
+              << std::endl;
+    std::cout << "  pacing samplerate    : write one IEC61937-13 frame every frame length / "
+                 "samplerate seconds"
+              << std::endl;
+    std::cout << "                         in real time (e.g. 48000) or 0 to write as fast as "
+                 "possible (default: 0)"
+              << std::endl;
+    std::cout << "  peak frame size      : largest MPEG-H frame of a raw MHAS stream in bytes; "
+                 "required for samplerate"
+              << std::endl;
+    std::cout << "                         factor 0 with raw MHAS input (default: 0 = unknown, up "
+                 "to 65536)"
+              << std::endl;
     return 0;
   }
 
@@ -279,7 +490,7 @@ int main(int argc, char** argv) {
   if (!parseCmdlInteger(argv[3], factor)) {
     return 1;
   }
-  if (factor != 4 && factor != 16) {
+  if (factor != 0 && factor != 1 && factor != 2 && factor != 4 && factor != 8 && factor != 16) {
     std::cout << "Unsupported samplerate factor: " << factor << std::endl;
     return 1;
   }
@@ -294,12 +505,62 @@ int main(int argc, char** argv) {
     return 1;
   }
 
+  // parse and check frame length
+  uint32_t frameLength = IEC61937_AUDIOFRAME_LENGTH;
+  if (argc >= 6) {
+    if (!parseCmdlInteger(argv[5], frameLength)) {
+      return 1;
+    }
+    if (frameLength != 768 && frameLength != 1024 && frameLength != 1536 && frameLength != 2048 &&
+        frameLength != 3072 && frameLength != 4096) {
+      std::cout << "Unsupported frame length: " << frameLength << std::endl;
+      return 1;
+    }
+  }
+
+  // parse and check sparse output flag
+  uint32_t sparseOutput = 0;
+  if (argc >= 7) {
+    if (!parseCmdlInteger(argv[6], sparseOutput)) {
+      return 1;
+    }
+    if (sparseOutput != 0 && sparseOutput != 1) {
+      std::cout << "Unsupported sparse output value: " << sparseOutput << std::endl;
+      return 1;
+    }
+  }
+
+  // parse and check pacing samplerate
+  uint32_t pacingSampleRate = 0;
+  if (argc >= 8) {
+    if (!parseCmdlInteger(argv[7], pacingSampleRate)) {
+      return 1;
+    }
+    if (pacingSampleRate > 0 && sparseOutput > 0) {
+      std::cout << "Sparse output cannot be combined with paced output" << std::endl;
+      return 1;
+    }
+  }
+
+  // parse and check peak frame size
+  uint32_t mhasPeakAuSize = 0;
+  if (argc == 9) {
+    if (!parseCmdlInteger(argv[8], mhasPeakAuSize)) {
+      return 1;
+    }
+    if (mhasPeakAuSize > MHAS_MAX_AU_SIZE) {
+      std::cout << "Unsupported peak frame size: " << mhasPeakAuSize << std::endl;
+      return 1;
+    }
+  }
+
   std::cout << "Reading from input file: " << inputFileUri << std::endl;
   std::cout << "Writing to output file: " << outputFileUri << std::endl;
   std::cout << std::endl;
 
   try {
-    CProcessor processor(inputFileUri, outputFileUri, factor, swapBytes > 0);
+    CProcessor processor(inputFileUri, outputFileUri, factor, frameLength, swapBytes > 0,
+                         sparseOutput > 0, pacingSampleRate, mhasPeakAuSize);
     processor.process();
   } catch (const std::exception& e) {
     std::cout << std::endl << "Exception caught: " << e.what() << std::endl;
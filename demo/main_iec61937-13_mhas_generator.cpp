@@ -0,0 +1,300 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// system includes
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+// External includes
+#include "ilo/memory.h"
+#include "mmtisobmff/types.h"
+#include "mmtisobmff/logging.h"
+#include "mmtisobmff/writer/writer.h"
+#include "mmtisobmff/writer/trackwriter.h"
+
+// project includes
+#include "mhas_generator.h"
+
+using namespace mmt::isobmff;
+
+class CGenerator {
+ private:
+  std::string m_outputFilename;
+  HANDLE_MHAS_GENERATOR m_generator;
+  std::ostream& m_log;
+
+  // A raw MHAS stream is written to stdout ("-") or to files with the extension ".mhas"
+  static bool isMhasOutput(const std::string& filename) {
+    const std::string extension = ".mhas";
+    return filename == "-" ||
+           (filename.size() >= extension.size() &&
+            filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0);
+  }
+
+  void generateMhas(uint64_t numFrames) {
+    FILE* output = (m_outputFilename == "-") ? stdout : fopen(m_outputFilename.c_str(), "wb");
+    if (output == nullptr) {
+      throw std::runtime_error("ERROR: Cannot open output file!");
+    }
+    ilo::ByteBuffer frame(MHAS_MAX_AU_SIZE);
+    bool generatorError = false;
+    bool writeError = false;
+    for (uint64_t i = 0; i < numFrames && !generatorError && !writeError; i++) {
+      uint32_t frameLength = static_cast<uint32_t>(frame.size());
+      uint32_t frameDuration = 0;
+      bool isRap = false;
+      generatorError = mhas_generator_process(m_generator, frame.data(), &frameLength,
+                                              &frameDuration, &isRap) != MHAS_OK;
+      writeError = !generatorError && fwrite(frame.data(), 1, frameLength, output) != frameLength;
+    }
+    if (output != stdout) {
+      writeError = (fclose(output) != 0) || writeError;
+    } else {
+      writeError = (fflush(output) != 0) || writeError;
+    }
+    if (generatorError) {
+      throw std::runtime_error("ERROR: MHAS generator failed!");
+    }
+    if (writeError) {
+      throw std::runtime_error("ERROR: Cannot write output file!");
+    }
+  }
+
+  void generateMp4(uint64_t numFrames) {
+    // Configure the output
+    CIsobmffFileWriter::SOutputConfig outputConfig;
+    outputConfig.outputUri = m_outputFilename;
+    outputConfig.tmpUri = "";
+
+    SMovieConfig movieConfig;
+    movieConfig.majorBrand = ilo::toFcc("mp42");
+
+    // Create a non-fragmented (plain) MP4 file writer with an MPEG-H track
+    std::unique_ptr<CIsobmffFileWriter> writer =
+        ilo::make_unique<CIsobmffFileWriter>(outputConfig, movieConfig);
+    SMpeghMhm1TrackConfig mpeghConfig;
+    mpeghConfig.mediaTimescale = 48000;
+    mpeghConfig.sampleRate = 48000;
+    std::unique_ptr<CMpeghTrackWriter> mpeghTrackWriter =
+        writer->trackWriter<CMpeghTrackWriter>(mpeghConfig);
+
+    CSample sample{MHAS_MAX_AU_SIZE};
+    for (uint64_t i = 0; i < numFrames; i++) {
+      sample.rawData.resize(MHAS_MAX_AU_SIZE);
+      uint32_t frameLength = static_cast<uint32_t>(sample.rawData.size());
+      uint32_t frameDuration = 0;
+      bool isRap = false;
+      if (mhas_generator_process(m_generator, sample.rawData.data(), &frameLength, &frameDuration,
+                                 &isRap) != MHAS_OK) {
+        throw std::runtime_error("ERROR: MHAS generator failed!");
+      }
+      sample.rawData.resize(frameLength);
+      sample.duration = frameDuration;
+      sample.isSyncSample = isRap;
+      mpeghTrackWriter->addSample(sample);
+    }
+    writer->close();
+  }
+
+ public:
+  CGenerator(const std::string& outputFilename, const MHAS_GEN_CONFIG& config)
+      : m_outputFilename(outputFilename),
+        m_generator(nullptr),
+        m_log(outputFilename == "-" ? std::cerr : std::cout) {
+    m_generator = mhas_generator_open(&config);
+    if (m_generator == nullptr) {
+      throw std::runtime_error("ERROR: MHAS generator could not be created!");
+    }
+  }
+
+  ~CGenerator() {
+    if (m_generator != nullptr) {
+      mhas_generator_close(m_generator);
+    }
+  }
+
+  void process(uint64_t numFrames) {
+    if (isMhasOutput(m_outputFilename)) {
+      m_log << "Writing raw MHAS stream" << std::endl;
+      generateMhas(numFrames);
+    } else {
+      m_log << "Writing MP4 file" << std::endl;
+      generateMp4(numFrames);
+    }
+    m_log << "MPEG-H frames written: " << numFrames << std::endl;
+  }
+};
+
+static bool parseCmdlInteger(const char* arg, uint32_t& result) {
+  std::istringstream ss(arg);
+  if (!(ss >> result)) {
+    std::cerr << "Invalid number: " << arg << std::endl;
+    return false;
+  } else if (!ss.eof()) {
+    std::cerr << "Trailing characters after number: " << arg << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  // Configure mmtisobmff logging to your liking (logging to file, system, console or disable)
+  disableLogging();
+
+  if (argc < 3 || argc > 8) {
+    std::cout << "Usage: IEC61937-13_mhas_generator_example <outputFile-URI> <number of frames> "
+                 "[bitrate] [size distribution] [RAP interval] [frame duration] [seed]"
+              << std::endl;
+    std::cout << "  outputFile-URI       : MP4 file, raw MHAS stream with the extension .mhas or - "
+                 "to write a raw MHAS stream to stdout"
+              << std::endl;
+    std::cout << "  bitrate              : mean bit rate in bit/s (default: 256000)" << std::endl;
+    std::cout << "  size distribution    : 0 = CBR, 1 = uniform (mean +/- 50%), 2 = exponential, "
+                 "3 = peak size of MPEG-H Level 4 (default: 0)"
+              << std::endl;
+    std::cout << "  RAP interval         : frames from one RAP to the next, 0 for only the first "
+                 "frame (default: 32)"
+              << std::endl;
+    std::cout << "  frame duration       : 768, 1024, 2048 or 4096 (default: 1024)" << std::endl;
+    std::cout << "  seed                 : seed of the pseudo-random sizes and payloads "
+                 "(default: 0)"
+              << std::endl;
+    return 0;
+  }
+
+  std::string outputFileUri = std::string(argv[1]);
+  MHAS_GEN_CONFIG config;
+  mhas_generator_config_init(&config);
+
+  uint32_t numFrames = 0;
+  if (!parseCmdlInteger(argv[2], numFrames)) {
+    return 1;
+  }
+  if (argc >= 4 && !parseCmdlInteger(argv[3], config.bitrate)) {
+    return 1;
+  }
+  if (argc >= 5) {
+    uint32_t sizes = 0;
+    if (!parseCmdlInteger(argv[4], sizes)) {
+      return 1;
+    }
+    if (sizes > MHAS_GEN_SIZES_PEAK) {
+      std::cerr << "Unsupported size distribution: " << sizes << std::endl;
+      return 1;
+    }
+    config.sizes = static_cast<MHAS_GEN_SIZES>(sizes);
+  }
+  if (argc >= 6 && !parseCmdlInteger(argv[5], config.rapInterval)) {
+    return 1;
+  }
+  if (argc >= 7) {
+    if (!parseCmdlInteger(argv[6], config.frameDurations[0])) {
+      return 1;
+    }
+    if (config.frameDurations[0] != 768 && config.frameDurations[0] != 1024 &&
+        config.frameDurations[0] != 2048 && config.frameDurations[0] != 4096) {
+      std::cerr << "Unsupported frame duration: " << config.frameDurations[0] << std::endl;
+      return 1;
+    }
+  }
+  if (argc == 8 && !parseCmdlInteger(argv[7], config.seed)) {
+    return 1;
+  }
+
+  try {
+    CGenerator generator(outputFileUri, config);
+    generator.process(numFrames);
+  } catch (const std::exception& e) {
+    std::cerr << std::endl << "Exception caught: " << e.what() << std::endl;
+    return 1;
+  } catch (...) {
+    std::cerr << std::endl
+              << "Error: An unknown error happened. The program will exit now." << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
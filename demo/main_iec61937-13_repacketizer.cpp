@@ -0,0 +1,298 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// project includes
+#include "iec61937_repack.h"
+
+static constexpr uint32_t inputChunkSize = 1024 * 2 * 2 * 4;  // for swapping bytes this should
+                                                              // be an even number!
+
+class CProcessor {
+ private:
+  std::ifstream m_inFile;
+  std::ofstream m_outFile;
+  bool m_swapBytes;
+  HANDLE_IEC61937_REPACKETIZER m_repacketizer;
+  std::vector<uint8_t> m_outputBuffer;
+  uint64_t m_numOutputFrames;
+
+  void writeOutput(uint32_t outputBytes) {
+    if (outputBytes == 0) {
+      return;
+    }
+    if (m_swapBytes) {
+      // Reorder Bytes
+      for (uint32_t i = 0; i < outputBytes; i += 2) {
+        std::swap(m_outputBuffer[i], m_outputBuffer[i + 1]);
+      }
+    }
+    m_outFile.write(reinterpret_cast<const char*>(m_outputBuffer.data()), outputBytes);
+    m_numOutputFrames++;
+  }
+
+ public:
+  CProcessor(const std::string& inputFilename, const std::string& outputFilename, uint32_t factor,
+             uint32_t frameLength, bool swapBytes)
+      : m_inFile(inputFilename, std::ios::in | std::ios::binary),
+        m_outFile(outputFilename, std::ios::out | std::ios::binary),
+        m_swapBytes(swapBytes),
+        m_repacketizer(nullptr),
+        m_numOutputFrames(0) {
+    if (!m_inFile) {
+      throw std::runtime_error("ERROR: Cannot open input file!");
+    }
+    if (!m_outFile) {
+      throw std::runtime_error("ERROR: Cannot open output file!");
+    }
+
+    IEC61937_ENC_CONFIG outputConfig;
+    iec61937_encode_config_init(&outputConfig);
+    outputConfig.rateFactor = static_cast<uint8_t>(factor);
+    outputConfig.audioFrameLength = frameLength;
+    m_repacketizer = iec61937_repack_open(&outputConfig);
+    if (m_repacketizer == nullptr) {
+      throw std::runtime_error("ERROR: IEC61937-13 repacketizer could not be created!");
+    }
+    m_outputBuffer.resize(iec61937_repack_get_frame_size(m_repacketizer));
+    std::cout << "Output IEC61937-13 frame size: " << m_outputBuffer.size() << " Bytes"
+              << std::endl;
+  }
+
+  ~CProcessor() {
+    if (m_repacketizer != nullptr) {
+      iec61937_repack_close(m_repacketizer);
+    }
+  }
+
+  void process() {
+    std::vector<uint8_t> inputBuffer(inputChunkSize);
+
+    while (m_inFile) {
+      m_inFile.read(reinterpret_cast<char*>(inputBuffer.data()), inputBuffer.size());
+      uint32_t inputDataRead = static_cast<uint32_t>(m_inFile.gcount());
+
+      if (m_swapBytes) {
+        // Reorder Bytes
+        for (uint32_t i = 0; i + 1 < inputDataRead; i += 2) {
+          std::swap(inputBuffer[i], inputBuffer[i + 1]);
+        }
+      }
+      if (iec61937_repack_feed(m_repacketizer, inputBuffer.data(), inputDataRead) !=
+          IECREPACK_OK) {
+        throw std::runtime_error("ERROR: Unable to feed data to the IEC61937-13 repacketizer!");
+      }
+
+      // Get as many output frames as possible.
+      while (true) {
+        uint32_t outputBytes = static_cast<uint32_t>(m_outputBuffer.size());
+        IECREPACK_RESULT err =
+            iec61937_repack_process(m_repacketizer, m_outputBuffer.data(), &outputBytes);
+        if (err == IECREPACK_FEED_MORE_DATA) {
+          break;
+        }
+        switch (err) {
+          case IECREPACK_DECODE_ERROR:
+            throw std::runtime_error("ERROR: The input IEC61937-13 stream could not be decoded!");
+          case IECREPACK_ENCODE_ERROR:
+            throw std::runtime_error(
+                "ERROR: Rate factor too small or MPEG-H frame duration exceeds maximum.");
+          case IECREPACK_OK:
+            break;
+          default:
+            throw std::runtime_error("ERROR: IEC61937-13 repacketizer failed!");
+        }
+        writeOutput(outputBytes);
+        std::cout << "IEC61937-13 frames written: " << m_numOutputFrames << "\r" << std::flush;
+      }
+    }
+
+    // Write the MPEG-H frames still stored in the repacketizer
+    uint32_t outputBytes = 0;
+    do {
+      outputBytes = static_cast<uint32_t>(m_outputBuffer.size());
+      if (iec61937_repack_flush(m_repacketizer, m_outputBuffer.data(), &outputBytes) !=
+          IECREPACK_OK) {
+        throw std::runtime_error("ERROR: Flushing the IEC61937-13 repacketizer failed.");
+      }
+      writeOutput(outputBytes);
+    } while (outputBytes > 0);
+    std::cout << "IEC61937-13 frames written: " << m_numOutputFrames << std::endl;
+
+    if (!m_outFile.good()) {
+      throw std::runtime_error("ERROR: Cannot write output file!");
+    }
+  }
+};
+
+static bool parseCmdlInteger(const char* arg, uint32_t& result) {
+  std::istringstream ss(arg);
+  if (!(ss >> result)) {
+    std::cout << "Invalid number: " << arg << std::endl;
+    return false;
+  } else if (!ss.eof()) {
+    std::cout << "Trailing characters after number: " << arg << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 4 || argc > 6) {
+    std::cout << "Usage: IEC61937-13_repacketizer_example <inputFile-URI> <outputFile-URI> "
+                 "<samplerate factor> [frame length] [swap byte order flag]"
+              << std::endl;
+    std::cout << "  samplerate factor    : 2, 4, 8, 16 or 1 for non-HBR audio mode 0 of the output"
+              << std::endl;
+    std::cout << "  frame length         : 768, 1024, 1536, 2048, 3072 or 4096 of the output "
+                 "(default: 1024)"
+              << std::endl;
+    std::cout << "  swap byte order flag : 1 to swap pairwise, 0 to keep the byte order of input "
+                 "and output (default: 0)"
+              << std::endl;
+    std::cout << "    NOTE: the default byte order is Big-Endian" << std::endl;
+    return 0;
+  }
+
+  std::string inputFileUri = std::string(argv[1]);
+  std::string outputFileUri = std::string(argv[2]);
+
+  // parse and check samplerate factor
+  uint32_t factor = 0;
+  if (!parseCmdlInteger(argv[3], factor)) {
+    return 1;
+  }
+  if (factor != 1 && factor != 2 && factor != 4 && factor != 8 && factor != 16) {
+    std::cout << "Unsupported samplerate factor: " << factor << std::endl;
+    return 1;
+  }
+
+  // parse and check frame length
+  uint32_t frameLength = IEC61937_AUDIOFRAME_LENGTH;
+  if (argc >= 5) {
+    if (!parseCmdlInteger(argv[4], frameLength)) {
+      return 1;
+    }
+    if (frameLength != 768 && frameLength != 1024 && frameLength != 1536 && frameLength != 2048 &&
+        frameLength != 3072 && frameLength != 4096) {
+      std::cout << "Unsupported frame length: " << frameLength << std::endl;
+      return 1;
+    }
+  }
+
+  // parse and check swap bytes flag
+  uint32_t swapBytes = 0;
+  if (argc == 6) {
+    if (!parseCmdlInteger(argv[5], swapBytes)) {
+      return 1;
+    }
+    if (swapBytes != 0 && swapBytes != 1) {
+      std::cout << "Unsupported swap byte order value: " << swapBytes << std::endl;
+      return 1;
+    }
+  }
+
+  std::cout << "Reading from input file: " << inputFileUri << std::endl;
+  std::cout << "Writing to output file: " << outputFileUri << std::endl;
+  std::cout << std::endl;
+
+  try {
+    CProcessor processor(inputFileUri, outputFileUri, factor, frameLength, swapBytes == 1);
+    processor.process();
+  } catch (const std::exception& e) {
+    std::cout << std::endl << "Exception caught: " << e.what() << std::endl;
+    return 1;
+  } catch (...) {
+    std::cout << std::endl
+              << "Error: An unknown error happened. The program will exit now." << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
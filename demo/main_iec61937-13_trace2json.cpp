@@ -0,0 +1,242 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// project includes
+#include "iec61937_trace.h"
+
+struct STraceEventInfo {
+  const char* name;
+  const char* category;
+  const char* arg0Name;
+  const char* arg1Name;
+  const char* counterName;  // counter track of arg0, nullptr if none
+};
+
+// Indexed by IEC61937_TRACE_EVENT
+static const STraceEventInfo traceEventInfo[IEC61937_TRACE_NUM_EVENTS] = {
+    {"burst written", "encoder", "mpeghBytes", "mpeghFrames", "encoded MPEG-H bytes"},
+    {"pause written", "encoder", "frameLength", nullptr, nullptr},
+    {"buffer error", "encoder", "frameLength", "framesStored", nullptr},
+    {"sync acquired", "decoder", "frameLength", "burstRepetitionPeriod", nullptr},
+    {"sync lost", "decoder", "bytesDropped", nullptr, nullptr},
+    {"candidate rejected", "decoder", "reason", "pc", nullptr},
+    {"AU emitted", "decoder", "size", "pcmOffset", "decoded MPEG-H frame size"},
+    {"buffer error", "decoder", "bytesRequired", "bytesAvailable", nullptr},
+    {"pending data error", "decoder", "bytesMissing", nullptr, nullptr},
+};
+
+static const char* rejectReasons[] = {"pc", "burst spacing", "payload headers"};
+
+static uint64_t readLittleEndian(const uint8_t* data, uint32_t numBytes) {
+  uint64_t value = 0;
+  for (uint32_t i = 0; i < numBytes; i++) {
+    value |= (uint64_t)data[i] << (8 * i);
+  }
+  return value;
+}
+
+class CConverter {
+ private:
+  std::ifstream m_inFile;
+  std::ofstream m_outFile;
+  uint64_t m_numEvents;
+
+  void writeEvent(uint64_t timestamp, uint32_t event, uint32_t arg0, int32_t arg1) {
+    const STraceEventInfo& info = traceEventInfo[event];
+    // the Chrome trace format uses microseconds; encoder and decoder are separate threads
+    std::ostringstream ts;
+    ts << timestamp / 1000 << "." << std::setw(3) << std::setfill('0') << timestamp % 1000;
+    int tid = (info.category[0] == 'e') ? 1 : 2;
+
+    m_outFile << ",\n{\"name\":\"" << info.name << "\",\"cat\":\"" << info.category
+              << "\",\"ph\":\"i\",\"s\":\"t\",\"ts\":" << ts.str() << ",\"pid\":1,\"tid\":" << tid
+              << ",\"args\":{\"" << info.arg0Name << "\":";
+    if (event == IEC61937_TRACE_DEC_CANDIDATE_REJECTED && arg0 < 3) {
+      m_outFile << "\"" << rejectReasons[arg0] << "\"";
+    } else {
+      m_outFile << arg0;
+    }
+    if (info.arg1Name != nullptr) {
+      m_outFile << ",\"" << info.arg1Name << "\":" << arg1;
+    }
+    m_outFile << "}}";
+    if (info.counterName != nullptr) {
+      m_outFile << ",\n{\"name\":\"" << info.counterName << "\",\"ph\":\"C\",\"ts\":" << ts.str()
+                << ",\"pid\":1,\"args\":{\"bytes\":" << arg0 << "}}";
+    }
+    m_numEvents++;
+  }
+
+ public:
+  CConverter(const std::string& inputFilename, const std::string& outputFilename)
+      : m_inFile(inputFilename, std::ios::in | std::ios::binary),
+        m_outFile(outputFilename, std::ios::out),
+        m_numEvents(0) {
+    if (!m_inFile) {
+      throw std::runtime_error("ERROR: Cannot open input file!");
+    }
+    if (!m_outFile) {
+      throw std::runtime_error("ERROR: Cannot open output file!");
+    }
+  }
+
+  void process() {
+    // check the file header
+    std::string magic(IEC61937_TRACE_MAGIC);
+    std::vector<uint8_t> header(magic.size() + 4);
+    m_inFile.read(reinterpret_cast<char*>(header.data()), header.size());
+    if (static_cast<size_t>(m_inFile.gcount()) != header.size() ||
+        magic.compare(0, magic.size(), reinterpret_cast<const char*>(header.data()),
+                      magic.size()) != 0) {
+      throw std::runtime_error("ERROR: The input file is no IEC61937-13 trace!");
+    }
+    if (readLittleEndian(header.data() + magic.size(), 4) != IEC61937_TRACE_VERSION) {
+      throw std::runtime_error("ERROR: Unsupported trace version!");
+    }
+
+    m_outFile << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    m_outFile << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+                 "\"args\":{\"name\":\"encoder\"}},"
+                 "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,"
+                 "\"args\":{\"name\":\"decoder\"}}";
+    uint8_t record[IEC61937_TRACE_RECORD_SIZE];
+    while (m_inFile.read(reinterpret_cast<char*>(record), sizeof(record))) {
+      uint64_t word = readLittleEndian(record, 8);
+      uint32_t event = static_cast<uint32_t>(word & 0xFF);
+      if (event >= IEC61937_TRACE_NUM_EVENTS) {
+        throw std::runtime_error("ERROR: Unknown trace event!");
+      }
+      writeEvent(word >> 8, event, static_cast<uint32_t>(readLittleEndian(record + 8, 4)),
+                 static_cast<int32_t>(readLittleEndian(record + 12, 4)));
+    }
+    if (m_inFile.gcount() != 0) {
+      std::cout << "Warning: truncated last record ignored" << std::endl;
+    }
+    m_outFile << "\n]}\n";
+    std::cout << "Trace events converted: " << m_numEvents << std::endl;
+
+    if (!m_outFile.good()) {
+      throw std::runtime_error("ERROR: Cannot write output file!");
+    }
+  }
+};
+
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    std::cout << "Usage: IEC61937-13_trace2json <inputFile-URI> <outputFile-URI>" << std::endl;
+    std::cout << "  inputFile-URI  : binary trace written by the IEC61937-13 trace sink"
+              << std::endl;
+    std::cout << "  outputFile-URI : JSON trace (Chrome trace event format, e.g. for Perfetto)"
+              << std::endl;
+    return 0;
+  }
+
+  std::string inputFileUri = std::string(argv[1]);
+  std::string outputFileUri = std::string(argv[2]);
+
+  std::cout << "Reading from input file: " << inputFileUri << std::endl;
+  std::cout << "Writing to output file: " << outputFileUri << std::endl;
+  std::cout << std::endl;
+
+  try {
+    CConverter converter(inputFileUri, outputFileUri);
+    converter.process();
+  } catch (const std::exception& e) {
+    std::cout << std::endl << "Exception caught: " << e.what() << std::endl;
+    return 1;
+  } catch (...) {
+    std::cout << std::endl
+              << "Error: An unknown error happened. The program will exit now." << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
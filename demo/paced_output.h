@@ -0,0 +1,188 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+#if !defined(PACED_OUTPUT_H)
+#define PACED_OUTPUT_H
+
+/**
+ * @file   paced_output.h
+ * @brief  Real-time pacing of IEC61937-13 frames with send time jitter statistics.
+ *
+ * Each IEC61937-13 frame carries audioFrameLength samples, so a live sink consumes one frame every
+ * audioFrameLength / sampleRate seconds. The pacer releases frame n at the absolute deadline
+ * start + n * audioFrameLength / sampleRate of the monotonic clock. Deadlines are computed from the
+ * frame count instead of being accumulated, so rounding errors and late wake-ups do not add up to
+ * a drift: a late frame is followed by frames with a shorter wait until the schedule is met again.
+ */
+
+// system includes
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+
+// Upper bounds of the jitter histogram bins in microseconds; the last bin has no upper bound
+static const int64_t PACED_OUTPUT_JITTER_BINS_US[] = {10, 50, 100, 500, 1000, 5000};
+#define PACED_OUTPUT_NUM_JITTER_BINS \
+  (sizeof(PACED_OUTPUT_JITTER_BINS_US) / sizeof(PACED_OUTPUT_JITTER_BINS_US[0]) + 1)
+
+class CPacedOutput {
+ private:
+  typedef std::chrono::steady_clock Clock;
+
+  uint32_t m_audioFrameLength;
+  uint32_t m_sampleRate;
+  Clock::time_point m_start;
+  uint64_t m_numFrames;
+  uint64_t m_numDeadlineMisses; /* frames sent one frame period or more after their deadline */
+  int64_t m_maxLatenessNs;
+  uint64_t m_histogram[PACED_OUTPUT_NUM_JITTER_BINS];
+
+  // Deadline of frame n relative to the start; computed without accumulating rounding errors.
+  // Whole seconds and the remainder are converted separately, so the nanoseconds do not overflow
+  // during long-running playout.
+  std::chrono::nanoseconds getDeadline(uint64_t frameIndex) const {
+    uint64_t numSamples = frameIndex * m_audioFrameLength;
+    return std::chrono::nanoseconds((numSamples / m_sampleRate) * 1000000000ULL +
+                                    (numSamples % m_sampleRate) * 1000000000ULL / m_sampleRate);
+  }
+
+ public:
+  CPacedOutput(uint32_t audioFrameLength, uint32_t sampleRate)
+      : m_audioFrameLength(audioFrameLength),
+        m_sampleRate(sampleRate),
+        m_numFrames(0),
+        m_numDeadlineMisses(0),
+        m_maxLatenessNs(0),
+        m_histogram() {}
+
+  // Blocks until the deadline of the next IEC61937-13 frame and records the send time jitter. The
+  // first call starts the schedule.
+  void waitForNextFrame() {
+    if (m_numFrames == 0) {
+      m_start = Clock::now();
+    }
+    Clock::time_point deadline = m_start + getDeadline(m_numFrames);
+    std::this_thread::sleep_until(deadline);
+
+    int64_t latenessNs =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - deadline).count();
+    if (latenessNs < 0) {
+      latenessNs = 0;
+    }
+    if (latenessNs > m_maxLatenessNs) {
+      m_maxLatenessNs = latenessNs;
+    }
+    if (latenessNs >= getDeadline(1).count()) {
+      m_numDeadlineMisses++;
+    }
+    size_t bin = 0;
+    while (bin < PACED_OUTPUT_NUM_JITTER_BINS - 1 &&
+           latenessNs >= PACED_OUTPUT_JITTER_BINS_US[bin] * 1000) {
+      bin++;
+    }
+    m_histogram[bin]++;
+    m_numFrames++;
+  }
+
+  uint64_t numFrames() const { return m_numFrames; }
+
+  uint64_t numDeadlineMisses() const { return m_numDeadlineMisses; }
+
+  void printStatistics(std::ostream& out) const {
+    out << "Paced IEC61937-13 frames : " << m_numFrames << " (period "
+        << getDeadline(1).count() / 1000 << " us)" << std::endl;
+    out << "Deadline misses          : " << m_numDeadlineMisses << std::endl;
+    out << "Max. send time jitter    : " << m_maxLatenessNs / 1000 << " us" << std::endl;
+    out << "Send time jitter histogram:" << std::endl;
+    for (size_t bin = 0; bin < PACED_OUTPUT_NUM_JITTER_BINS; bin++) {
+      if (bin < PACED_OUTPUT_NUM_JITTER_BINS - 1) {
+        out << "  < " << PACED_OUTPUT_JITTER_BINS_US[bin] << " us";
+      } else {
+        out << "  >= " << PACED_OUTPUT_JITTER_BINS_US[bin - 1] << " us";
+      }
+      out << " : " << m_histogram[bin] << std::endl;
+    }
+  }
+};
+
+#endif /* !defined(PACED_OUTPUT_H) */
@@ -0,0 +1,311 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+#if !defined(SPARSE_FILE_WRITER_H)
+#define SPARSE_FILE_WRITER_H
+
+/**
+ * @file   sparse_file_writer.h
+ * @brief  Output file writer which turns zero blocks into file holes.
+ *
+ * IEC61937-13 frames with a high rate factor mostly consist of zero padding. In sparse mode, all
+ * blocks of SPARSE_FILE_BLOCK_SIZE bytes (aligned to the file offset) which contain zeroes only
+ * are skipped with lseek() instead of being written, so the file system does not allocate them.
+ * Reading the file returns zeroes for the holes, i.e. the file content is identical to a regular
+ * write. Without POSIX file support, all data is written regularly.
+ */
+
+// system includes
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+#define SPARSE_FILE_POSIX 1
+#else
+#define SPARSE_FILE_POSIX 0
+#endif
+
+// Granularity of file holes; matches the page and file system block size of common systems
+#define SPARSE_FILE_BLOCK_SIZE 4096
+
+class CSparseFileWriter {
+ private:
+  std::ofstream m_file;
+  bool m_sparse;
+  int m_fd;
+  uint64_t m_fileSize;      /* logical size of the file */
+  uint64_t m_pendingHole;   /* zero bytes skipped since the last write */
+  uint64_t m_holeBytes;     /* overall number of bytes not written */
+  uint8_t m_block[SPARSE_FILE_BLOCK_SIZE];
+  size_t m_blockFill;
+
+  static bool isZero(const uint8_t* data, size_t length) {
+    // compare word-wise; the block size is a multiple of the word size
+    uint64_t accumulator = 0;
+    for (size_t i = 0; i < length; i += sizeof(uint64_t)) {
+      uint64_t word;
+      memcpy(&word, data + i, sizeof(uint64_t));
+      accumulator |= word;
+    }
+    return accumulator == 0;
+  }
+
+#if SPARSE_FILE_POSIX
+  void seekOverHole() {
+    if (m_pendingHole == 0) {
+      return;
+    }
+    if (lseek(m_fd, static_cast<off_t>(m_pendingHole), SEEK_CUR) < 0) {
+      throw std::runtime_error("ERROR: Cannot seek in output file!");
+    }
+    m_pendingHole = 0;
+  }
+
+  void writeData(const uint8_t* data, size_t length) {
+    seekOverHole();
+    while (length > 0) {
+      ssize_t written = ::write(m_fd, data, length);
+      if (written < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw std::runtime_error("ERROR: Cannot write output file!");
+      }
+      data += written;
+      length -= static_cast<size_t>(written);
+    }
+  }
+
+  // Closes the file descriptor and drops data which has not been written yet.
+  bool releaseFile() {
+    bool success = (::close(m_fd) == 0);
+    m_fd = -1;
+    m_blockFill = 0;
+    m_pendingHole = 0;
+    return success;
+  }
+
+  // Writes whole blocks; runs of data blocks are written with a single call.
+  void writeBlocks(const uint8_t* data, size_t numBlocks) {
+    const uint8_t* run = data;
+    size_t runLength = 0;
+    for (size_t i = 0; i < numBlocks; i++) {
+      const uint8_t* block = data + i * SPARSE_FILE_BLOCK_SIZE;
+      if (isZero(block, SPARSE_FILE_BLOCK_SIZE)) {
+        if (runLength > 0) {
+          writeData(run, runLength);
+          runLength = 0;
+        }
+        m_pendingHole += SPARSE_FILE_BLOCK_SIZE;
+        m_holeBytes += SPARSE_FILE_BLOCK_SIZE;
+      } else {
+        if (runLength == 0) {
+          run = block;
+        }
+        runLength += SPARSE_FILE_BLOCK_SIZE;
+      }
+    }
+    if (runLength > 0) {
+      writeData(run, runLength);
+    }
+  }
+#endif
+
+ public:
+  CSparseFileWriter(const std::string& filename, bool sparse)
+      : m_sparse(sparse && SPARSE_FILE_POSIX),
+        m_fd(-1),
+        m_fileSize(0),
+        m_pendingHole(0),
+        m_holeBytes(0),
+        m_blockFill(0) {
+#if SPARSE_FILE_POSIX
+    if (m_sparse) {
+      m_fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      return;
+    }
+#endif
+    m_file.open(filename, std::ios::out | std::ios::binary);
+  }
+
+  ~CSparseFileWriter() {
+    try {
+      close();
+    } catch (...) {
+    }
+  }
+
+  bool good() const { return m_sparse ? (m_fd >= 0) : m_file.good(); }
+
+  bool isSparse() const { return m_sparse; }
+
+  // Number of bytes which have been skipped as file holes
+  uint64_t holeBytes() const { return m_holeBytes; }
+
+  void write(const uint8_t* data, size_t length) {
+    m_fileSize += length;
+    if (!m_sparse) {
+      m_file.write(reinterpret_cast<const char*>(data), length);
+      return;
+    }
+#if SPARSE_FILE_POSIX
+    // complete a partially filled block first
+    if (m_blockFill > 0) {
+      size_t copyLength = SPARSE_FILE_BLOCK_SIZE - m_blockFill;
+      if (copyLength > length) {
+        copyLength = length;
+      }
+      memcpy(m_block + m_blockFill, data, copyLength);
+      m_blockFill += copyLength;
+      data += copyLength;
+      length -= copyLength;
+      if (m_blockFill < SPARSE_FILE_BLOCK_SIZE) {
+        return;
+      }
+      writeBlocks(m_block, 1);
+      m_blockFill = 0;
+    }
+
+    // whole blocks are taken directly from the input
+    size_t numBlocks = length / SPARSE_FILE_BLOCK_SIZE;
+    writeBlocks(data, numBlocks);
+    data += numBlocks * SPARSE_FILE_BLOCK_SIZE;
+    length -= numBlocks * SPARSE_FILE_BLOCK_SIZE;
+
+    // keep the remainder until the block is complete
+    memcpy(m_block, data, length);
+    m_blockFill = length;
+#endif
+  }
+
+  // Hands the written data over to the system. In sparse mode, data of a partially filled block is
+  // held back until the block is complete.
+  void flush() {
+    if (!m_sparse) {
+      m_file.flush();
+    }
+  }
+
+  // Writes the remaining data and sets the final file size. Returns false in case of an error.
+  bool close() {
+    if (!m_sparse) {
+      if (!m_file.is_open()) {
+        return true;
+      }
+      m_file.close();
+      return m_file.good();
+    }
+#if SPARSE_FILE_POSIX
+    if (m_fd < 0) {
+      return true;
+    }
+    bool success = true;
+    try {
+      if (m_blockFill > 0) {
+        writeData(m_block, m_blockFill);
+      }
+    } catch (...) {
+      // the file descriptor is released on errors as well
+      releaseFile();
+      throw;
+    }
+    // a trailing hole is created by setting the file size
+    if (m_pendingHole > 0 && ftruncate(m_fd, static_cast<off_t>(m_fileSize)) != 0) {
+      success = false;
+    }
+    if (!releaseFile()) {
+      success = false;
+    }
+    return success;
+#else
+    return true;
+#endif
+  }
+};
+
+#endif /* !defined(SPARSE_FILE_WRITER_H) */
@@ -83,12 +83,23 @@ amm-info@iis.fraunhofer.de
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "iec61937_pcm_format.h"
+#include "iec61937_trace.h"
+
 #if !defined(IEC61937_DEC_H)
 #define IEC61937_DEC_H
 
 /**
  * @file   iec61937_dec.h
  * @brief  IEC61937-13 decoder library interface header file.
+ *
+ * Real-time use: iec61937_decode_feed(), iec61937_decode_feed_format() and
+ * iec61937_decode_process() neither allocate memory nor call into the operating system (only the
+ * decoder instance is allocated by iec61937_decode_open()), so they can be called from an audio
+ * callback. The work buffer is circular, i.e. data is never moved within it. The work of a feed
+ * call is proportional to the fed data, the work of a process call to the MPEG-H frame it outputs
+ * plus the sync search, which is bounded by iec61937_decode_set_realtime(). Installed trace
+ * callbacks are invoked synchronously and have to be real-time safe as well.
  */
 
 #ifdef __cplusplus
@@ -99,12 +110,14 @@ extern "C" {
 // for MPEG-H Level 4
 #define MAX_MPEGH_FRAME_SIZE 65536
 
-#define MAX_AUDIOFRAME_LENGTH 4096
+#define IEC61937_MAX_AUDIOFRAME_LENGTH 4096
+// unprefixed name, kept for compatibility
+#define MAX_AUDIOFRAME_LENGTH IEC61937_MAX_AUDIOFRAME_LENGTH
 #define IEC61937_MAX_SAMPLERATE_FACTOR 16
 #define IEC60958_FRAME_SIZE_BYTES 4
 
 #define MAX_IEC61937_FRAME_SIZE_BYTES \
-  (MAX_AUDIOFRAME_LENGTH) * (IEC61937_MAX_SAMPLERATE_FACTOR) * (IEC60958_FRAME_SIZE_BYTES)
+  (IEC61937_MAX_AUDIOFRAME_LENGTH) * (IEC61937_MAX_SAMPLERATE_FACTOR) * (IEC60958_FRAME_SIZE_BYTES)
 
 #define WORKBUFFER_SIZE_BYTES (MAX_IEC61937_FRAME_SIZE_BYTES) * 3
 
@@ -115,8 +128,42 @@ typedef enum IECDEC_RESULT {
                                  or the available data exceeds the pending data limit */
   IECDEC_BUFFER_ERROR,      /*!< Working buffer full or output buffer size too small */
   IECDEC_NULLPTR_ERROR,     /*!< A nullptr was used */
+  IECDEC_FORMAT_ERROR,      /*!< Unsupported input format or the input data length is not a
+                                 multiple of the PCM container size */
+  IECDEC_BUDGET_EXHAUSTED,  /*!< Ok, but the sync search budget of the process call is exhausted;
+                                 the search continues with the next call */
 } IECDEC_RESULT;
 
+/* IEC61937-13 decoder statistics */
+typedef struct IEC61937_DEC_STATS {
+  uint64_t bytesFed;                  /*!< number of bytes fed into the work buffer (after PCM
+                                           container conversion) */
+  uint64_t bytesScanned;              /*!< number of bytes searched for a sync preamble */
+  uint64_t bytesConsumed;             /*!< number of bytes of processed IEC frames */
+  uint64_t bytesDiscarded;            /*!< number of bytes dropped from the work buffer while
+                                           searching for the next IEC frame */
+  uint64_t bytesMoved;                /*!< number of bytes moved by compaction of the work buffer;
+                                           always 0 since the work buffer is circular */
+  uint64_t numSyncAcquired;           /*!< number of times an IEC frame was found without a directly
+                                           preceding IEC frame */
+  uint64_t numSyncLost;               /*!< number of times data had to be dropped after an IEC
+                                           frame, e.g. due to corruption or bursts of other data
+                                           types like pause bursts */
+  uint64_t numRejectedPc;             /*!< sync preambles rejected because of an unsupported burst
+                                           info (Pc) or burst length (Pd), including other data
+                                           types */
+  uint64_t numRejectedBurstSpacing;   /*!< IEC frame candidates rejected because the burst spacing
+                                           is not zero */
+  uint64_t numRejectedPayloadHeaders; /*!< IEC frame candidates rejected because of inconsistent
+                                           payload header offsets or lengths */
+  uint64_t numPendingDataErrors;      /*!< number of IECDEC_PENDINGDATA_ERROR results */
+  uint64_t numIecFrames;              /*!< number of processed IEC frames */
+  uint64_t numAus;                    /*!< number of obtained MPEG-H frames */
+  uint64_t numSplitAus;               /*!< number of MPEG-H frames reassembled from several IEC
+                                           frames */
+  uint32_t workBufferHighWaterMark;   /*!< maximum number of bytes stored in the work buffer */
+} IEC61937_DEC_STATS;
+
 /* IEC61937-13 decoder state structure */
 typedef struct iec61937_decoder_state* HANDLE_IEC61937_DECODER;
 
@@ -144,6 +191,25 @@ void iec61937_decode_close(HANDLE_IEC61937_DECODER h);
 IECDEC_RESULT iec61937_decode_feed(HANDLE_IEC61937_DECODER h, const uint8_t* inputBuffer,
                                    uint32_t inputBufferLength);
 
+/**
+ * @brief Feed IEC data chunks in a PCM container format to the IEC61937-13 decoder.
+ *
+ * The data is converted to packed 16-bit big-endian words while it is copied into the internal
+ * working buffer, so e.g. the buffers of an audio capture device can be fed directly.
+ * iec61937_decode_feed() equals this function with IEC61937_PCM_FORMAT_S16_BE.
+ * @param[in] h decoder handle
+ * @param[in] inputBuffer pointer to a data buffer to read the input data from
+ * @param[in] inputBufferLength length in bytes of the provided input data; has to be a multiple of
+ * the PCM container size (2 bytes for 16-bit and 4 bytes for 32-bit containers)
+ * @param[in] inputFormat PCM container format of the input data
+ * @returns IECDEC_OK in case of success, IECDEC_BUFFER_ERROR if the size of the converted input
+ * data is too big to fit into the internal working buffer, IECDEC_FORMAT_ERROR for an unsupported
+ * format or input data length and IECDEC_NULLPTR_ERROR if a nullptr was used as an input argument
+ */
+IECDEC_RESULT iec61937_decode_feed_format(HANDLE_IEC61937_DECODER h, const uint8_t* inputBuffer,
+                                          uint32_t inputBufferLength,
+                                          IEC61937_PCM_FORMAT inputFormat);
+
 /**
  * @brief Decode the IEC61937-13 frame and obtain one MPEG-H frame.
  * @param[in] h decoder handle
@@ -157,13 +223,65 @@ IECDEC_RESULT iec61937_decode_feed(HANDLE_IEC61937_DECODER h, const uint8_t* inp
  * @param[out] pIecFrameProcessed pointer where the info about having completed the processing of
  * the IEC frame is stored into; can be used to recreate the PTS of the obtained MPEG-H frame
  * @return IECDEC_OK on success, IECDEC_FEED_MORE_DATA if new data needs to fed into the decoder,
- * IECDEC_BUFFER_ERROR if the provided output buffer has not enough space to hold the output MPEG-H
- * frame and IECDEC_NULLPTR_ERROR if a nullptr was used as an input argument
+ * IECDEC_BUDGET_EXHAUSTED without output if the sync search budget set by
+ * iec61937_decode_set_realtime() is exhausted before an IEC frame is found, IECDEC_BUFFER_ERROR if
+ * the provided output buffer has not enough space to hold the output MPEG-H frame and
+ * IECDEC_NULLPTR_ERROR if a nullptr was used as an input argument
  */
 IECDEC_RESULT iec61937_decode_process(HANDLE_IEC61937_DECODER h, uint8_t* outputBuffer,
                                       uint32_t* pOutputBufferLength, int32_t* pPcmOffset,
                                       uint32_t* pIecFrameLength, bool* pIecFrameProcessed);
 
+/**
+ * @brief Bound the work of the sync search of iec61937_decode_process() for real-time use.
+ *
+ * Without a budget, a process call searches all available data for the next IEC frame, i.e. a
+ * call following a large amount of noise or a loss of sync can take much longer than others. With
+ * a budget, each process call examines at most maxBytesPerCall bytes while searching (scanned
+ * bytes plus the checked burst spacing and payload headers of candidates, the last check may
+ * exceed the budget by one payload header list). If the budget is exhausted before an IEC frame is
+ * found, the call returns IECDEC_BUDGET_EXHAUSTED without output and with *pIecFrameProcessed set
+ * to false, and the search continues with the next call. Callers which call
+ * iec61937_decode_process() until IECDEC_FEED_MORE_DATA therefore spread the search over several
+ * calls, or stop after a fixed number of calls per audio callback and continue in the next one.
+ * The decoded MPEG-H frames are the same with and without a budget.
+ * @param[in] h decoder handle
+ * @param[in] maxBytesPerCall maximum number of bytes examined by the sync search of a process call
+ * (0 = unlimited, the default)
+ * @returns IECDEC_OK in case of success and IECDEC_NULLPTR_ERROR if a nullptr was used as the
+ * handle.
+ */
+IECDEC_RESULT iec61937_decode_set_realtime(HANDLE_IEC61937_DECODER h, uint32_t maxBytesPerCall);
+
+/**
+ * @brief Get the statistics of a decoder instance since opening.
+ *
+ * The counters are updated with plain increments while decoding, so they can be polled cheaply,
+ * e.g. to spot streams which spend their time on resynchronization (bytesScanned and
+ * bytesDiscarded growing compared to bytesConsumed).
+ * @param[in] h decoder handle
+ * @param[out] stats pointer where the statistics are stored into
+ * @returns IECDEC_OK in case of success and IECDEC_NULLPTR_ERROR if a nullptr was used as an input
+ * argument.
+ */
+IECDEC_RESULT iec61937_decode_get_stats(HANDLE_IEC61937_DECODER h, IEC61937_DEC_STATS* stats);
+
+#if defined(IEC61937_ENABLE_TRACING)
+/**
+ * @brief Install a trace callback (see iec61937_trace.h).
+ *
+ * The callback is invoked synchronously for each trace event of the decoder instance.
+ * Only available if the library is built with IEC61937_ENABLE_TRACING.
+ * @param[in] h decoder handle
+ * @param[in] callback trace callback or NULL to disable tracing
+ * @param[in] userData user data passed to the callback
+ * @returns IECDEC_OK in case of success and IECDEC_NULLPTR_ERROR if a nullptr was used as the
+ * handle.
+ */
+IECDEC_RESULT iec61937_decode_set_trace(HANDLE_IEC61937_DECODER h,
+                                        IEC61937_TRACE_CALLBACK callback, void* userData);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -83,51 +83,172 @@ amm-info@iis.fraunhofer.de
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "iec61937_pcm_format.h"
+#include "iec61937_trace.h"
+
 #if !defined(IEC61937_ENC_H)
 #define IEC61937_ENC_H
 
 /**
  * @file   iec61937_enc.h
  * @brief  IEC61937-13 encoder library interface header file.
+ *
+ * Real-time use: iec61937_encode_process(), iec61937_encode_process_batch(),
+ * iec61937_encode_fill(), iec61937_encode_flush() and the pool functions except for creating and
+ * destroying a pool neither allocate memory nor call into the operating system, so they can be
+ * called from an audio callback. A call of iec61937_encode_process() copies at most one MPEG-H
+ * frame into the circular work buffer, in which the stored MPEG-H frames are never moved, and
+ * writes at most one IEC frame (see iec61937_encode_get_frame_size()). In low latency mode it
+ * writes at most as many IEC frames as the output buffer holds (see IEC61937_ENC_CONFIG), i.e. the
+ * output buffer size is the budget of the call: with an output buffer of one IEC frame, the
+ * further IEC frames are written by the following calls. Release callbacks and installed trace
+ * callbacks are invoked synchronously and have to be real-time safe as well.
+ * iec61937_encode_process_parallel() allocates and starts threads and is not real-time safe.
  */
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Default IEC frame length
 #define IEC61937_AUDIOFRAME_LENGTH 1024
+#define IEC61937_MAX_AUDIOFRAME_LENGTH 4096
 #define IEC61937_MAX_SAMPLERATE_FACTOR 16
 #define IEC60958_FRAME_SIZE_BYTES 4
 
+// Maximum IEC61937-13 frame size in the 16-bit output formats (IEC61937_PCM_FORMAT_S16_BE/_LE)
 #define MAX_IEC61937_FRAME_SIZE_BYTES \
-  (IEC61937_AUDIOFRAME_LENGTH) * (IEC61937_MAX_SAMPLERATE_FACTOR) * (IEC60958_FRAME_SIZE_BYTES)
+  (IEC61937_MAX_AUDIOFRAME_LENGTH) * (IEC61937_MAX_SAMPLERATE_FACTOR) * (IEC60958_FRAME_SIZE_BYTES)
+// Maximum IEC61937-13 frame size in any output format; 32-bit containers double the frame size
+#define IEC61937_MAX_OUTPUT_FRAME_SIZE_BYTES \
+  ((MAX_IEC61937_FRAME_SIZE_BYTES) / 2 * (IEC61937_MAX_PCM_CONTAINER_SIZE))
 
 typedef enum IECENC_RESULT {
   IECENC_OK = 0,         /*!< Ok, no error */
   IECENC_BUFFER_ERROR,   /*!< Working buffer full or output buffer size too small */
   IECENC_NULLPTR_ERROR,  /*!< A nullptr was used */
   IECENC_DURATION_ERROR, /*!< The provided frame duration exceeds the maximum allowed duration */
+  IECENC_CONFIG_ERROR,   /*!< An unsupported parameter value was used */
+  IECENC_LATENCY_ERROR,  /*!< The MPEG-H frame could exceed the configured latency limit */
 } IECENC_RESULT;
 
+/* Packing policy of MPEG-H frames into IEC61937-13 frames */
+typedef enum IECENC_PACKING {
+  IECENC_PACKING_GREEDY = 0, /*!< fill each IEC frame completely; the last MPEG-H frame is split */
+  IECENC_PACKING_LOOKAHEAD,  /*!< move an MPEG-H frame which would be split to the next IEC frame
+                                  if it fits there completely; all MPEG-H frames are signaled one
+                                  IEC frame length ahead (PCM offsets >= audioFrameLength) to keep
+                                  the PCM offset of a moved frame valid */
+} IECENC_PACKING;
+
+/* IEC frame written by iec61937_encode_fill() if no MPEG-H frame is stored */
+typedef enum IECENC_FILL {
+  IECENC_FILL_EMPTY = 0, /*!< MPEG-H IEC frame without MPEG-H frames */
+  IECENC_FILL_PAUSE,     /*!< IEC 61937 pause burst (data type 3) with the IEC frame length */
+} IECENC_FILL;
+
+// Number of bins of IEC61937_ENC_STATS::payloadUtilization, each covering 10 percent
+#define IEC61937_ENC_NUM_UTILIZATION_BINS 10
+// Number of bins of IEC61937_ENC_STATS::auLatency
+#define IEC61937_ENC_NUM_LATENCY_BINS 8
+
+/* IEC61937-13 encoder statistics */
+typedef struct IEC61937_ENC_STATS {
+  uint64_t numIecFrames;    /*!< number of IEC61937-13 frames written */
+  uint64_t numAus;          /*!< number of MPEG-H frames written completely */
+  uint64_t numSplitAus;     /*!< number of MPEG-H frames spread over several IEC61937-13 frames */
+  uint64_t numDeferredAus;  /*!< number of MPEG-H frames moved to the next IEC61937-13 frame by
+                                 IECENC_PACKING_LOOKAHEAD instead of being split */
+  uint64_t splitLatency;    /*!< audio samples by which split MPEG-H frames are completed after the
+                                 IEC61937-13 frame carrying their payload header (sum) */
+  uint64_t numPauseBursts;  /*!< number of pause bursts written by iec61937_encode_fill() */
+  uint64_t payloadBytes;    /*!< MPEG-H frame bytes written into IEC61937-13 frames */
+  uint64_t paddingBytes;    /*!< unused payload bytes of IEC61937-13 frames, i.e. the burst
+                                 repetition period minus IEC header, burst spacing, payload headers
+                                 and MPEG-H frame bytes */
+  /*! histogram of IEC61937-13 frames by the share of payload headers and MPEG-H frame bytes in
+      the payload space: bin i counts shares from i*10% to below (i+1)*10%, the last bin includes
+      completely filled frames */
+  uint64_t payloadUtilization[IEC61937_ENC_NUM_UTILIZATION_BINS];
+  /*! histogram of MPEG-H frames by the IEC61937-13 frame completing them: bin k counts frames
+      completed by the k-th IEC61937-13 frame written after they were passed in (k = 0 is the next
+      one), the last bin includes all later frames */
+  uint64_t auLatency[IEC61937_ENC_NUM_LATENCY_BINS];
+  uint32_t peakFramesStored; /*!< maximum number of stored MPEG-H frames */
+  uint32_t maxFramesStored;  /*!< limit of stored MPEG-H frames (see maxQueuedAus) */
+  uint32_t peakStoredBytes;  /*!< maximum number of bytes of stored MPEG-H frames */
+  uint32_t workBufferSize;   /*!< size of the work buffer, 0 for borrowing instances */
+  uint64_t numBufferErrors;  /*!< number of MPEG-H frames rejected with IECENC_BUFFER_ERROR because
+                                  the queue or the work buffer was full */
+  uint64_t numNearOverflows; /*!< number of stored MPEG-H frames after which another frame of the
+                                  same size would have been rejected with IECENC_BUFFER_ERROR */
+} IEC61937_ENC_STATS;
+
 /* IEC61937-13 encoder state structure */
 typedef struct iec61937_encoder_state* HANDLE_IEC61937_ENCODER;
 
+/* IEC61937-13 encoder pool structure */
+typedef struct iec61937_encoder_pool* HANDLE_IEC61937_ENCODER_POOL;
+
+/* MPEG-H frame description for iec61937_encode_process_batch() */
+typedef struct IEC61937_ENC_AU {
+  const uint8_t* data; /*!< pointer to the MPEG-H frame */
+  uint32_t length;     /*!< size in bytes of the MPEG-H frame */
+  uint32_t duration;   /*!< the amount of audio samples of the MPEG-H frame */
+} IEC61937_ENC_AU;
+
+/**
+ * @brief Callback to hand back an MPEG-H frame borrowed by the IEC61937-13 encoder.
+ * @param[in] userData user data pointer provided to iec61937_encode_open_borrowed()
+ * @param[in] inputBuffer pointer to the MPEG-H frame as it was passed to iec61937_encode_process()
+ */
+typedef void (*IEC61937_ENC_RELEASE_CALLBACK)(void* userData, const uint8_t* inputBuffer);
+
+/* IEC61937-13 encoder configuration, see iec61937_encode_config_init() for the defaults */
+typedef struct IEC61937_ENC_CONFIG {
+  uint8_t rateFactor;        /*!< bit rate factor for IEC frame rate (2, 4, 8 or 16), 1 for audio
+                                  mode 0 (no HBR) or 0 to select the smallest rate factor which
+                                  fits maxAuSize */
+  uint32_t audioFrameLength; /*!< IEC frame length in audio samples (768, 1024, 1536, 2048, 3072 or
+                                  4096) */
+  uint32_t maxAuSize;  /*!< peak MPEG-H frame size in bytes, used if rateFactor is 0 and to size
+                            the work buffer, which rejects larger frames (0 = 65536) */
+  uint32_t auDuration; /*!< MPEG-H frame duration in audio samples, used if rateFactor is 0 */
+  bool borrowFrames;   /*!< reference MPEG-H frames instead of copying them, see
+                            iec61937_encode_open_borrowed() */
+  IEC61937_ENC_RELEASE_CALLBACK releaseCallback; /*!< release callback for borrowed frames */
+  void* releaseUserData;                         /*!< user data passed to releaseCallback */
+  bool lowLatency;     /*!< write an IEC frame as soon as its content is known, i.e. also when
+                            its payload is complete and, if the output buffer holds them, all
+                            IEC frames completed by one MPEG-H frame at once */
+  uint32_t maxLatency; /*!< latency limit in audio samples; opening fails if the worst-case
+                            latency exceeds it and MPEG-H frames with another duration than
+                            auDuration or more than maxAuSize bytes are rejected (0 = no limit) */
+  uint32_t maxQueuedAus; /*!< maximum number of stored MPEG-H frames, at most 16 (0 = derived from
+                              audioFrameLength and auDuration) */
+  IECENC_PACKING packing; /*!< packing policy of MPEG-H frames into IEC frames */
+  IEC61937_PCM_FORMAT outputFormat; /*!< PCM container format of the written IEC frames; 32-bit
+                                         containers double the IEC frame size */
+} IEC61937_ENC_CONFIG;
+
 /**
  * @brief Encode one IEC61937-13 MPEG-H frame.
  * @param[in] h encoder handle
- * @param[in] inputBuffer pointer to data buffer where one MPEG-H frame is read from
+ * @param[in] inputBuffer pointer to data buffer where one MPEG-H frame is read from; the data is
+ * borrowed instead of copied for instances created with iec61937_encode_open_borrowed()
  * @param[in] inputBufferLength size in bytes of the data in inputBuffer
  * @param[out] fInputBufferProcessed flag set to true if data from inputBuffer was read or false if
  * it had to be postponed, i.e. the inputBuffer needs to be passed in again
  * @param[in] duration the amount of audio samples according to PTS difference of consecutive MPEG-H
  * frames
  * @param[out] outputBuffer pointer to an output data buffer into which one resulting IEC61937-13
- * frame will be written
+ * frame will be written; in low latency mode further IEC61937-13 frames whose content is already
+ * known are written back-to-back as far as the capacity allows
  * @param[in,out] pOutputBufferLength pointer to the capacity of the outputBuffer on input and the
  * number of bytes written into outputBuffer on output
  * @returns IECENC_OK in case of success, IECDEC_BUFFER_ERROR in case the internal buffer is full or
- * the output buffer size is too small and IECENC_NULLPTR_ERROR if a nullptr was used as an input
- * argument.
+ * the output buffer size is too small, IECENC_LATENCY_ERROR if the MPEG-H frame could exceed the
+ * latency limit and IECENC_NULLPTR_ERROR if a nullptr was used as an input argument.
  */
 IECENC_RESULT iec61937_encode_process(HANDLE_IEC61937_ENCODER h, const uint8_t* inputBuffer,
                                       uint32_t inputBufferLength, bool* fInputBufferProcessed,
@@ -135,15 +256,313 @@ IECENC_RESULT iec61937_encode_process(HANDLE_IEC61937_ENCODER h, const uint8_t*
                                       uint32_t* pOutputBufferLength);
 
 /**
- * @brief Create a IEC61937-13 encoder instance.
+ * @brief Encode a sequence of MPEG-H frames into as many IEC61937-13 frames as possible.
+ *
+ * The MPEG-H frames are consumed in order and the resulting IEC61937-13 frames are written
+ * back-to-back into outputBuffer. Processing stops when all frames are consumed and no further
+ * IEC61937-13 frame is ready, when outputBuffer cannot hold another IEC61937-13 frame or when
+ * burstOffsets is full. The not consumed frames need to be passed in again with the next call.
+ * MPEG-H frames with a length of zero are consumed without being stored.
+ * @param[in] h encoder handle
+ * @param[in] aus array of MPEG-H frames to be encoded
+ * @param[in] numAus number of entries in aus
+ * @param[out] pNumAusConsumed pointer where the number of consumed MPEG-H frames is stored into
+ * @param[out] outputBuffer pointer to an output data buffer into which the IEC61937-13 frames are
+ * written
+ * @param[in] outputBufferLength capacity of outputBuffer in bytes
+ * @param[out] burstOffsets optional array (may be NULL) where the byte offset of each written
+ * IEC61937-13 frame within outputBuffer is stored into
+ * @param[in,out] pNumBursts pointer to the capacity of burstOffsets on input and the number of
+ * IEC61937-13 frames written on output
+ * @returns IECENC_OK in case of success, IECENC_BUFFER_ERROR in case the internal buffer is full or
+ * outputBuffer cannot hold a single IEC61937-13 frame, IECENC_DURATION_ERROR if a frame duration
+ * exceeds the maximum, IECENC_LATENCY_ERROR if a frame could exceed the latency limit and
+ * IECENC_NULLPTR_ERROR if a nullptr was used as an input argument. In case of an error,
+ * pNumAusConsumed and pNumBursts reflect the work done so far.
+ */
+IECENC_RESULT iec61937_encode_process_batch(HANDLE_IEC61937_ENCODER h, const IEC61937_ENC_AU* aus,
+                                            uint32_t numAus, uint32_t* pNumAusConsumed,
+                                            uint8_t* outputBuffer, uint32_t outputBufferLength,
+                                            uint32_t* burstOffsets, uint32_t* pNumBursts);
+
+/**
+ * @brief Encode a sequence of MPEG-H frames like iec61937_encode_process_batch() using several
+ * threads.
+ *
+ * A sequential planning pass determines the layout of all IEC61937-13 frames from the MPEG-H frame
+ * lengths and durations only. Afterwards the IEC61937-13 frames are written in parallel. The output
+ * and the encoder state after the call are identical to iec61937_encode_process_batch(). The
+ * MPEG-H frames are read directly from aus while the IEC61937-13 frames are written; consumed
+ * frames which are still needed for the next IEC61937-13 frame are copied into the work buffer
+ * (or kept borrowed) before the function returns. Release callbacks of borrowing instances are
+ * called in the same order as with iec61937_encode_process_batch(), after all IEC61937-13 frames
+ * of the call have been written. Calls which cannot give at least two threads about 1 MiB of
+ * IEC61937-13 frames each (estimated from the MPEG-H frame durations) are encoded by
+ * iec61937_encode_process_batch() without allocating memory or starting threads.
+ * @param[in] h encoder handle
+ * @param[in] aus array of MPEG-H frames to be encoded
+ * @param[in] numAus number of entries in aus
+ * @param[out] pNumAusConsumed pointer where the number of consumed MPEG-H frames is stored into
+ * @param[out] outputBuffer pointer to an output data buffer into which the IEC61937-13 frames are
+ * written
+ * @param[in] outputBufferLength capacity of outputBuffer in bytes
+ * @param[out] burstOffsets optional array (may be NULL) where the byte offset of each written
+ * IEC61937-13 frame within outputBuffer is stored into
+ * @param[in,out] pNumBursts pointer to the capacity of burstOffsets on input and the number of
+ * IEC61937-13 frames written on output
+ * @param[in] numThreads number of threads writing IEC61937-13 frames, 0 selects the number of
+ * hardware threads
+ * @returns see iec61937_encode_process_batch(). IECENC_BUFFER_ERROR is also returned if the
+ * planning memory cannot be allocated.
+ */
+IECENC_RESULT iec61937_encode_process_parallel(HANDLE_IEC61937_ENCODER h,
+                                               const IEC61937_ENC_AU* aus, uint32_t numAus,
+                                               uint32_t* pNumAusConsumed, uint8_t* outputBuffer,
+                                               uint32_t outputBufferLength, uint32_t* burstOffsets,
+                                               uint32_t* pNumBursts, uint32_t numThreads);
+
+/**
+ * @brief Write one IEC61937-13 frame on an output deadline although no complete IEC61937-13 frame
+ * is available (underrun of the MPEG-H source in live operation).
+ *
+ * Stored MPEG-H frames are written regardless of their duration. If no MPEG-H frame is stored, an
+ * IEC frame without MPEG-H frames or an IEC 61937 pause burst with the gap length of one IEC frame
+ * length is written. Both keep the IEC frame rate, so receivers stay locked. The missing duration
+ * is treated as a gap in the time line: MPEG-H frames passed in afterwards get valid (non-negative)
+ * PCM offsets and continue seamlessly with iec61937_encode_process().
+ * @param[in] h encoder handle
+ * @param[in] fill type of IEC frame written if no MPEG-H frame is stored
+ * @param[out] outputBuffer pointer to an output data buffer into which one IEC frame is written
+ * @param[in,out] pOutputBufferLength pointer to the capacity of the outputBuffer on input and the
+ * number of bytes written into outputBuffer on output (always the IEC frame size)
+ * @returns IECENC_OK in case of success, IECENC_BUFFER_ERROR if the output buffer size is too
+ * small, IECENC_CONFIG_ERROR for an unsupported fill type and IECENC_NULLPTR_ERROR if a nullptr was
+ * used as an input argument.
+ */
+IECENC_RESULT iec61937_encode_fill(HANDLE_IEC61937_ENCODER h, IECENC_FILL fill,
+                                   uint8_t* outputBuffer, uint32_t* pOutputBufferLength);
+
+/**
+ * @brief Write the remaining stored MPEG-H frames.
+ *
+ * Each call writes one IEC61937-13 frame containing as many of the stored MPEG-H frames as fit,
+ * padded with zeroes. The function needs to be called until pOutputBufferLength is set to 0. Then
+ * all stored data has been written and the encoder starts a new time line with the next call of
+ * iec61937_encode_process().
+ * @param[in] h encoder handle
+ * @param[out] outputBuffer pointer to an output data buffer into which one resulting IEC61937-13
+ * frame will be written
+ * @param[in,out] pOutputBufferLength pointer to the capacity of the outputBuffer on input and the
+ * number of bytes written into outputBuffer on output
+ * @returns IECENC_OK in case of success, IECENC_BUFFER_ERROR if the output buffer size is too small
+ * and IECENC_NULLPTR_ERROR if a nullptr was used as an input argument.
+ */
+IECENC_RESULT iec61937_encode_flush(HANDLE_IEC61937_ENCODER h, uint8_t* outputBuffer,
+                                    uint32_t* pOutputBufferLength);
+
+/**
+ * @brief Create a IEC61937-13 encoder instance with an IEC frame length of
+ * IEC61937_AUDIOFRAME_LENGTH.
  * @param[in] rateFactor bit rate factor for IEC frame rate. The rate factors are defined in
- * specification IEC 61937-13 subclause 5.3.2. Supported rate factors are 4 and 16.
+ * specification IEC 61937-13 subclause 5.3.2. Supported rate factors are 2, 4, 8 and 16 which use
+ * audio mode 1 (MPEG-H 3D Audio HBR). Rate factor 1 selects audio mode 0 (MPEG-H 3D Audio) with 6
+ * byte payload headers, which fits into a standard 2-channel IEC 60958 link but limits the
+ * MPEG-H frame size to 65535 bytes.
  * @return HANDLE_IEC61937_ENCODER in case of success, NULL in case of error.
  */
 HANDLE_IEC61937_ENCODER iec61937_encode_open(uint8_t rateFactor);
 
 /**
- * @brief Close a IEC61937-13 encoder instance.
+ * @brief Initialize an encoder configuration with the default values (rate factor 16, IEC frame
+ * length IEC61937_AUDIOFRAME_LENGTH, MPEG-H frames are copied, greedy packing).
+ * @param[out] config configuration to be initialized
+ */
+void iec61937_encode_config_init(IEC61937_ENC_CONFIG* config);
+
+/**
+ * @brief Create a IEC61937-13 encoder instance from a configuration.
+ * @param[in] config encoder configuration
+ * @return HANDLE_IEC61937_ENCODER in case of success, NULL in case of error (e.g. unsupported rate
+ * factor or frame length or no rate factor fits the configured peak MPEG-H frame size).
+ */
+HANDLE_IEC61937_ENCODER iec61937_encode_open_config(const IEC61937_ENC_CONFIG* config);
+
+/**
+ * @brief Get the memory size required for an encoder instance created with
+ * iec61937_encode_open_in_place().
+ *
+ * The size covers the encoder state and the circular work buffer for maxQueuedAus MPEG-H frames
+ * of maxAuSize bytes plus one frame of unused space at its end (no work buffer is needed if
+ * borrowFrames is set).
+ * @param[in] config encoder configuration
+ * @return memory size in bytes or 0 in case of an unsupported configuration
+ */
+uint32_t iec61937_encode_get_memory_size(const IEC61937_ENC_CONFIG* config);
+
+/**
+ * @brief Create a IEC61937-13 encoder instance in caller-provided memory.
+ *
+ * Only the encoder state is initialized, the work buffer is not touched until it is used. The
+ * memory must stay valid until the instance is closed; iec61937_encode_close() does not free it.
+ * @param[in] config encoder configuration
+ * @param[in] memory memory of at least iec61937_encode_get_memory_size() bytes, aligned to
+ * alignof(max_align_t) like memory returned by malloc(); less aligned memory is rejected
+ * @param[in] memorySize size of memory in bytes
+ * @return HANDLE_IEC61937_ENCODER in case of success, NULL in case of error.
+ */
+HANDLE_IEC61937_ENCODER iec61937_encode_open_in_place(const IEC61937_ENC_CONFIG* config,
+                                                      void* memory, uint32_t memorySize);
+
+/**
+ * @brief Reset an encoder instance to its state after opening.
+ *
+ * All stored MPEG-H frames are dropped (borrowed frames are released) and a new time line is
+ * started. The configuration is kept.
+ * @param[in] h encoder handle
+ * @returns IECENC_OK in case of success and IECENC_NULLPTR_ERROR if h is NULL.
+ */
+IECENC_RESULT iec61937_encode_reset(HANDLE_IEC61937_ENCODER h);
+
+/**
+ * @brief Get the memory size required for an encoder pool.
+ * @param[in] config encoder configuration used for all instances of the pool
+ * @param[in] numEncoders number of encoder instances
+ * @return memory size in bytes or 0 in case of an unsupported configuration
+ */
+uint32_t iec61937_encode_pool_get_memory_size(const IEC61937_ENC_CONFIG* config,
+                                              uint32_t numEncoders);
+
+/**
+ * @brief Create a pool of IEC61937-13 encoder instances sharing one configuration.
+ *
+ * All instances are created up front and the whole pool memory is touched once, so acquiring an
+ * instance neither allocates nor causes page faults. The pool is not thread-safe.
+ * @param[in] config encoder configuration used for all instances
+ * @param[in] numEncoders number of encoder instances
+ * @param[in] memory memory of at least iec61937_encode_pool_get_memory_size() bytes aligned to
+ * alignof(max_align_t) (e.g. hugepage-backed) or NULL to let the pool allocate it
+ * @param[in] memorySize size of memory in bytes; ignored if memory is NULL
+ * @return HANDLE_IEC61937_ENCODER_POOL in case of success, NULL in case of error.
+ */
+HANDLE_IEC61937_ENCODER_POOL iec61937_encode_pool_create(const IEC61937_ENC_CONFIG* config,
+                                                         uint32_t numEncoders, void* memory,
+                                                         uint32_t memorySize);
+
+/**
+ * @brief Take an encoder instance from the pool.
+ * @param[in] pool pool handle
+ * @return HANDLE_IEC61937_ENCODER ready for a new stream or NULL if the pool is exhausted
+ */
+HANDLE_IEC61937_ENCODER iec61937_encode_pool_acquire(HANDLE_IEC61937_ENCODER_POOL pool);
+
+/**
+ * @brief Reset an encoder instance and hand it back to the pool.
+ * @param[in] pool pool handle
+ * @param[in] h encoder handle obtained from iec61937_encode_pool_acquire()
+ * @returns IECENC_OK in case of success, IECENC_BUFFER_ERROR if h does not belong to the pool or is
+ * not acquired (e.g. released twice) and IECENC_NULLPTR_ERROR if a nullptr was used as an input
+ * argument.
+ */
+IECENC_RESULT iec61937_encode_pool_release(HANDLE_IEC61937_ENCODER_POOL pool,
+                                           HANDLE_IEC61937_ENCODER h);
+
+/**
+ * @brief Destroy an encoder pool including all of its instances.
+ * @param[in] pool pool handle
+ */
+void iec61937_encode_pool_destroy(HANDLE_IEC61937_ENCODER_POOL pool);
+
+/**
+ * @brief Determine the smallest rate factor which is able to carry the given peak bitrate.
+ * @param[in] audioFrameLength IEC frame length in audio samples
+ * @param[in] maxAuSize peak MPEG-H frame size in bytes, e.g. the maximum sample size of an MP4
+ * track or the result of a pre-scan of the stream
+ * @param[in] auDuration MPEG-H frame duration in audio samples
+ * @return the smallest suitable rate factor (1 denotes audio mode 0, see iec61937_encode_open()) or
+ * 0 if no rate factor is sufficient or the parameters are invalid.
+ */
+uint8_t iec61937_encode_get_min_rate_factor(uint32_t audioFrameLength, uint32_t maxAuSize,
+                                            uint32_t auDuration);
+
+/**
+ * @brief Get the statistics of an encoder instance since opening or the last reset.
+ *
+ * The payload statistics show whether a lower rate factor would suffice (e.g. no IEC frames in
+ * the upper utilization bins), the queue statistics how close the encoder is to rejecting MPEG-H
+ * frames.
+ * @param[in] h encoder handle
+ * @param[out] stats pointer where the statistics are stored into
+ * @returns IECENC_OK in case of success and IECENC_NULLPTR_ERROR if a nullptr was used as an input
+ * argument.
+ */
+IECENC_RESULT iec61937_encode_get_stats(HANDLE_IEC61937_ENCODER h, IEC61937_ENC_STATS* stats);
+
+#if defined(IEC61937_ENABLE_TRACING)
+/**
+ * @brief Install a trace callback (see iec61937_trace.h).
+ *
+ * The callback is invoked synchronously for each trace event of the encoder instance. It persists
+ * across iec61937_encode_reset() and is removed by iec61937_encode_pool_release(). Only available
+ * if the library is built with IEC61937_ENABLE_TRACING.
+ * @param[in] h encoder handle
+ * @param[in] callback trace callback or NULL to disable tracing
+ * @param[in] userData user data passed to the callback
+ * @returns IECENC_OK in case of success and IECENC_NULLPTR_ERROR if a nullptr was used as the
+ * handle.
+ */
+IECENC_RESULT iec61937_encode_set_trace(HANDLE_IEC61937_ENCODER h,
+                                        IEC61937_TRACE_CALLBACK callback, void* userData);
+#endif
+
+/**
+ * @brief Get the worst-case latency added by an encoder instance.
+ *
+ * The latency lasts from passing an MPEG-H frame in until the IEC61937-13 frame completing it has
+ * been transmitted. An MPEG-H frame is held until MPEG-H frames with a total duration of one IEC
+ * frame length are available; MPEG-H frames longer than the IEC frame length complete several
+ * IEC61937-13 frames, which are held until the next call unless low latency mode writes them at
+ * once. The tail of a split MPEG-H frame of up to maxAuSize bytes (one IEC61937-13 frame if
+ * maxAuSize is 0) follows with the next IEC61937-13 frames. The bound assumes the configured
+ * MPEG-H frame duration and a rate factor which carries the stream's bitrate.
+ * IECENC_PACKING_LOOKAHEAD adds one IEC frame length.
+ * @param[in] h encoder handle
+ * @return worst-case latency in audio samples or 0 if h is NULL
+ */
+uint32_t iec61937_encode_get_max_latency(HANDLE_IEC61937_ENCODER h);
+
+/**
+ * @brief Get the size of the IEC61937-13 frames written by an encoder instance.
+ *
+ * The size includes the PCM container format (outputFormat), i.e. it is twice the burst repetition
+ * period for 32-bit containers. All output buffers have to hold at least one IEC frame of this
+ * size; it is at most MAX_IEC61937_FRAME_SIZE_BYTES for the 16-bit formats and
+ * IEC61937_MAX_OUTPUT_FRAME_SIZE_BYTES for all formats.
+ * @param[in] h encoder handle
+ * @return IEC61937-13 frame size in bytes or 0 if h is NULL
+ */
+uint32_t iec61937_encode_get_frame_size(HANDLE_IEC61937_ENCODER h);
+
+/**
+ * @brief Create a IEC61937-13 encoder instance which borrows the MPEG-H frames instead of copying
+ * them.
+ *
+ * The encoder keeps a reference to every MPEG-H frame accepted by iec61937_encode_process() and
+ * copies its payload directly into the output IEC61937-13 frames. The data of an accepted frame
+ * must stay valid and unchanged until releaseCallback is called for it, which happens once the
+ * frame has been written completely or the instance is closed. No internal work buffer is
+ * allocated for such an instance.
+ * @param[in] rateFactor bit rate factor for IEC frame rate, see iec61937_encode_open()
+ * @param[in] releaseCallback callback to hand back a borrowed MPEG-H frame; may be NULL
+ * @param[in] userData user data pointer passed to releaseCallback
+ * @return HANDLE_IEC61937_ENCODER in case of success, NULL in case of error.
+ */
+HANDLE_IEC61937_ENCODER iec61937_encode_open_borrowed(uint8_t rateFactor,
+                                                      IEC61937_ENC_RELEASE_CALLBACK releaseCallback,
+                                                      void* userData);
+
+/**
+ * @brief Close a IEC61937-13 encoder instance. The memory of instances created with
+ * iec61937_encode_open_in_place() is not freed.
  * @param[in] h encoder handle to be closed
  */
 void iec61937_encode_close(HANDLE_IEC61937_ENCODER h);
@@ -0,0 +1,255 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#if !defined(IEC61937_LINK_SIM_H)
+#define IEC61937_LINK_SIM_H
+
+/**
+ * @file   iec61937_link_sim.h
+ * @brief  IEC61937-13 link simulator library interface header file.
+ *
+ * The link simulator is a local stand-in for an S/PDIF or HDMI connection between an IEC61937-13
+ * encoder and decoder. The transmitted stream is fed burst by burst and received in chunks like
+ * from a capture driver, with the following impairments injected:
+ * - bit flips at random bit positions
+ * - byte slips, i.e. a byte is lost or received twice
+ * - dropouts of a fixed number of bytes
+ * - duplicated bursts, i.e. a fed burst is received twice
+ * - clock drift of the receiver, i.e. PCM sample frames are periodically lost or received twice
+ * - chunks of random size
+ * Random events occur at exponentially distributed intervals. An optional callback reports the
+ * position of every impairment in the received stream, e.g. to measure the time until the decoder
+ * has recovered. The same configuration and input always result in the same received stream.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Largest burst which can be fed at once (IEC frame of 16x and 4096 samples in 32-bit containers)
+#define IEC61937_LINK_MAX_FEED_SIZE (4096 * 16 * 4 * 2)
+// Largest PCM sample frame (8 channels in 32-bit containers)
+#define IEC61937_LINK_MAX_SAMPLE_FRAME_SIZE 32
+// Largest clock deviation in ppm
+#define IEC61937_LINK_MAX_CLOCK_DRIFT 100000
+
+typedef enum IECLINK_RESULT {
+  IECLINK_OK = 0,         /*!< Ok, no error */
+  IECLINK_FEED_MORE_DATA, /*!< Ok, but more input data needs to be fed */
+  IECLINK_BUFFER_ERROR,   /*!< Working buffer full or output buffer size too small */
+  IECLINK_NULLPTR_ERROR,  /*!< A nullptr was used */
+} IECLINK_RESULT;
+
+/* Impairments injected by the link simulator */
+typedef enum IECLINK_IMPAIRMENT {
+  IECLINK_IMPAIRMENT_BIT_FLIP = 0, /*!< a bit of a received byte is inverted */
+  IECLINK_IMPAIRMENT_SLIP,         /*!< a byte is lost or received twice */
+  IECLINK_IMPAIRMENT_DROPOUT,      /*!< dropoutLength bytes are lost */
+  IECLINK_IMPAIRMENT_DUPLICATE,    /*!< a burst is received twice */
+  IECLINK_IMPAIRMENT_CLOCK_DRIFT,  /*!< a PCM sample frame is lost or received twice */
+} IECLINK_IMPAIRMENT;
+
+/**
+ * @brief Callback reporting an impairment.
+ * @param userData user data of the configuration
+ * @param impairment type of the impairment
+ * @param offset number of bytes received before the impairment
+ */
+typedef void (*IEC61937_LINK_IMPAIRMENT_CALLBACK)(void* userData, IECLINK_IMPAIRMENT impairment,
+                                                  uint64_t offset);
+
+/* IEC61937-13 link simulator configuration, see iec61937_link_config_init() for the defaults */
+typedef struct IEC61937_LINK_CONFIG {
+  uint64_t bitErrorInterval;  /*!< mean number of bits between bit flips (0 = no bit flips) */
+  uint32_t slipInterval;      /*!< mean number of bytes between byte slips (0 = no byte slips) */
+  uint32_t dropoutInterval;   /*!< mean number of bytes between dropouts (0 = no dropouts) */
+  uint32_t dropoutLength;     /*!< number of bytes lost per dropout */
+  uint32_t duplicateInterval; /*!< mean number of bursts between duplicated bursts (0 = no
+                                   duplicated bursts) */
+  int32_t clockDrift;         /*!< clock deviation of the receiver in ppm: a faster receiver
+                                   (positive values) receives every 10^6 / clockDrift-th PCM sample
+                                   frame twice, a slower one loses it (0 = no drift) */
+  uint32_t sampleFrameSize;   /*!< size of a PCM sample frame in bytes, e.g. 4 for two 16-bit
+                                   channels or 16 for the eight channels of HBR */
+  uint32_t minChunkSize;      /*!< smallest chunk returned by iec61937_link_process() */
+  uint32_t maxChunkSize;      /*!< largest chunk returned by iec61937_link_process(), at most
+                                   IEC61937_LINK_MAX_FEED_SIZE (0 = one chunk per fed burst) */
+  uint32_t seed;              /*!< seed of the pseudo-random impairments and chunk sizes */
+  IEC61937_LINK_IMPAIRMENT_CALLBACK impairmentCallback; /*!< optional impairment callback */
+  void* impairmentUserData;                             /*!< user data passed to the callback */
+} IEC61937_LINK_CONFIG;
+
+/* IEC61937-13 link simulator statistics */
+typedef struct IEC61937_LINK_STATS {
+  uint64_t bytesFed;       /*!< number of bytes fed */
+  uint64_t bytesReceived;  /*!< number of bytes returned by iec61937_link_process() and
+                                iec61937_link_flush() */
+  uint64_t bytesLost;      /*!< number of bytes lost by slips, dropouts and clock drift */
+  uint64_t bytesInserted;  /*!< number of bytes received twice by slips, duplicated bursts and
+                                clock drift */
+  uint64_t numBursts;      /*!< number of fed bursts */
+  uint64_t numBitFlips;    /*!< number of inverted bits */
+  uint64_t numSlips;       /*!< number of byte slips */
+  uint64_t numDropouts;    /*!< number of dropouts */
+  uint64_t numDuplicates;  /*!< number of duplicated bursts */
+  uint64_t numDriftFrames; /*!< number of PCM sample frames lost or received twice */
+} IEC61937_LINK_STATS;
+
+/* IEC61937-13 link simulator state structure */
+typedef struct iec61937_link_state* HANDLE_IEC61937_LINK;
+
+/**
+ * @brief Initialize a link simulator configuration with the default values: no impairments, one
+ * chunk per fed burst and 4-byte PCM sample frames.
+ * @param[out] config configuration to be initialized
+ */
+void iec61937_link_config_init(IEC61937_LINK_CONFIG* config);
+
+/**
+ * @brief Open an IEC61937-13 link simulator instance.
+ * @param[in] config link simulator configuration
+ * @return HANDLE_IEC61937_LINK on success or NULL in case of error (e.g. invalid configuration)
+ */
+HANDLE_IEC61937_LINK iec61937_link_open(const IEC61937_LINK_CONFIG* config);
+
+/**
+ * @brief Close an IEC61937-13 link simulator instance.
+ * @param[in] h link simulator handle to be closed.
+ */
+void iec61937_link_close(HANDLE_IEC61937_LINK h);
+
+/**
+ * @brief Transmit a burst (e.g. an IEC frame written by the encoder) over the link.
+ * @param[in] h link simulator handle
+ * @param[in] inputBuffer pointer to a data buffer to read the burst from
+ * @param[in] inputBufferLength length in bytes of the burst, at most IEC61937_LINK_MAX_FEED_SIZE
+ * @returns IECLINK_OK in case of success, IECLINK_BUFFER_ERROR if the burst is too big or the
+ * received data has not been obtained with iec61937_link_process() and IECLINK_NULLPTR_ERROR if a
+ * nullptr was used as an input argument
+ */
+IECLINK_RESULT iec61937_link_feed(HANDLE_IEC61937_LINK h, const uint8_t* inputBuffer,
+                                  uint32_t inputBufferLength);
+
+/**
+ * @brief Obtain the next received chunk.
+ *
+ * Has to be called until IECLINK_FEED_MORE_DATA is returned before the next burst is fed.
+ * @param[in] h link simulator handle
+ * @param[out] outputBuffer pointer to an output data buffer into which the chunk is written
+ * @param[in,out] pOutputBufferLength pointer to the capacity of the outputBuffer on input and the
+ * number of bytes written into outputBuffer on output
+ * @return IECLINK_OK if a chunk was written, IECLINK_FEED_MORE_DATA if not enough data has been
+ * received for the next chunk, IECLINK_BUFFER_ERROR if the provided output buffer is too small and
+ * IECLINK_NULLPTR_ERROR if a nullptr was used as an input argument
+ */
+IECLINK_RESULT iec61937_link_process(HANDLE_IEC61937_LINK h, uint8_t* outputBuffer,
+                                     uint32_t* pOutputBufferLength);
+
+/**
+ * @brief Obtain the received data which does not fill a chunk at the end of the stream.
+ * @param[in] h link simulator handle
+ * @param[out] outputBuffer pointer to an output data buffer into which the data is written
+ * @param[in,out] pOutputBufferLength pointer to the capacity of the outputBuffer on input and the
+ * number of bytes written into outputBuffer on output (0 if all data has been obtained)
+ * @returns IECLINK_OK in case of success, IECLINK_BUFFER_ERROR if the provided output buffer is
+ * too small and IECLINK_NULLPTR_ERROR if a nullptr was used as an input argument
+ */
+IECLINK_RESULT iec61937_link_flush(HANDLE_IEC61937_LINK h, uint8_t* outputBuffer,
+                                   uint32_t* pOutputBufferLength);
+
+/**
+ * @brief Get the statistics of a link simulator instance since opening.
+ * @param[in] h link simulator handle
+ * @param[out] stats pointer where the statistics are stored into
+ * @returns IECLINK_OK in case of success and IECLINK_NULLPTR_ERROR if a nullptr was used as an
+ * input argument.
+ */
+IECLINK_RESULT iec61937_link_get_stats(HANDLE_IEC61937_LINK h, IEC61937_LINK_STATS* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !defined(IEC61937_LINK_SIM_H) */
@@ -0,0 +1,192 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "iec61937_enc.h"
+
+#if !defined(IEC61937_REPACK_H)
+#define IEC61937_REPACK_H
+
+/**
+ * @file   iec61937_repack.h
+ * @brief  IEC61937-13 repacketizer library interface header file.
+ *
+ * The repacketizer converts an IEC61937-13 stream into another IEC61937-13 stream with a different
+ * rate factor and/or audio frame length (e.g. 16x to 4x captures) without an intermediate MP4
+ * file. The MPEG-H frames obtained by an IEC61937-13 decoder instance are directly passed to an
+ * IEC61937-13 encoder instance. The durations of the MPEG-H frames are derived from the PCM offsets
+ * of the input stream, so the timing of the input is carried over to the output.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum IECREPACK_RESULT {
+  IECREPACK_OK = 0,         /*!< Ok, no error */
+  IECREPACK_FEED_MORE_DATA, /*!< Ok, but more input data needs to be fed */
+  IECREPACK_DECODE_ERROR,   /*!< The input IEC61937-13 stream could not be decoded */
+  IECREPACK_ENCODE_ERROR,   /*!< The MPEG-H frames could not be encoded with the output
+                                 configuration (e.g. rate factor too small) */
+  IECREPACK_BUFFER_ERROR,   /*!< Working buffer full or output buffer size too small */
+  IECREPACK_NULLPTR_ERROR,  /*!< A nullptr was used */
+} IECREPACK_RESULT;
+
+/* IEC61937-13 repacketizer state structure */
+typedef struct iec61937_repacketizer_state* HANDLE_IEC61937_REPACKETIZER;
+
+/**
+ * @brief Open an IEC61937-13 repacketizer instance.
+ * @param[in] outputConfig configuration of the output IEC61937-13 stream (see
+ * iec61937_encode_open_config()); the audio mode and rate factor of the input stream are detected
+ * automatically
+ * @return HANDLE_IEC61937_REPACKETIZER on success or NULL in case of error (e.g. invalid output
+ * configuration)
+ */
+HANDLE_IEC61937_REPACKETIZER iec61937_repack_open(const IEC61937_ENC_CONFIG* outputConfig);
+
+/**
+ * @brief Close an IEC61937-13 repacketizer instance.
+ * @param[in] h repacketizer handle to be closed.
+ */
+void iec61937_repack_close(HANDLE_IEC61937_REPACKETIZER h);
+
+/**
+ * @brief Get the size of the output IEC61937-13 frames in bytes.
+ * @param[in] h repacketizer handle
+ * @returns the output IEC frame size in bytes or 0 if h is a nullptr
+ */
+uint32_t iec61937_repack_get_frame_size(HANDLE_IEC61937_REPACKETIZER h);
+
+/**
+ * @brief Feed input IEC frames/data chunks to the IEC61937-13 repacketizer.
+ * @param[in] h repacketizer handle
+ * @param[in] inputBuffer pointer to a data buffer to read the input data from
+ * @param[in] inputBufferLength length in bytes of the provided input data
+ * @returns IECREPACK_OK in case of success, IECREPACK_BUFFER_ERROR if the size of the input data is
+ * too big to fit into the internal working buffer and IECREPACK_NULLPTR_ERROR if a nullptr was used
+ * as an input argument
+ */
+IECREPACK_RESULT iec61937_repack_feed(HANDLE_IEC61937_REPACKETIZER h, const uint8_t* inputBuffer,
+                                      uint32_t inputBufferLength);
+
+/**
+ * @brief Obtain the next output IEC61937-13 frame.
+ *
+ * Has to be called until IECREPACK_FEED_MORE_DATA is returned before new input data is fed. The
+ * last MPEG-H frame obtained from the input is held back until the PCM offset of the next MPEG-H
+ * frame determines its duration.
+ * @param[in] h repacketizer handle
+ * @param[out] outputBuffer pointer to an output data buffer into which the IEC frame is written
+ * @param[in,out] pOutputBufferLength pointer to the capacity of the outputBuffer on input and the
+ * number of bytes written into outputBuffer on output
+ * @return IECREPACK_OK if an IEC frame was written, IECREPACK_FEED_MORE_DATA if new data needs to
+ * be fed into the repacketizer, IECREPACK_DECODE_ERROR or IECREPACK_ENCODE_ERROR if the conversion
+ * failed, IECREPACK_BUFFER_ERROR if the provided output buffer is too small and
+ * IECREPACK_NULLPTR_ERROR if a nullptr was used as an input argument
+ */
+IECREPACK_RESULT iec61937_repack_process(HANDLE_IEC61937_REPACKETIZER h, uint8_t* outputBuffer,
+                                         uint32_t* pOutputBufferLength);
+
+/**
+ * @brief Write the remaining MPEG-H frames at the end of the input stream.
+ *
+ * Has to be called until pOutputBufferLength is set to 0. The duration of the last MPEG-H frame is
+ * assumed to be the duration of the previous MPEG-H frame.
+ * @param[in] h repacketizer handle
+ * @param[out] outputBuffer pointer to an output data buffer into which the IEC frame is written
+ * @param[in,out] pOutputBufferLength pointer to the capacity of the outputBuffer on input and the
+ * number of bytes written into outputBuffer on output (0 if all MPEG-H frames have been written)
+ * @returns IECREPACK_OK in case of success, IECREPACK_ENCODE_ERROR if the conversion failed,
+ * IECREPACK_BUFFER_ERROR if the provided output buffer is too small and IECREPACK_NULLPTR_ERROR if
+ * a nullptr was used as an input argument
+ */
+IECREPACK_RESULT iec61937_repack_flush(HANDLE_IEC61937_REPACKETIZER h, uint8_t* outputBuffer,
+                                       uint32_t* pOutputBufferLength);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !defined(IEC61937_REPACK_H) */
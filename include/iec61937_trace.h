@@ -0,0 +1,191 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+#if !defined(IEC61937_TRACE_H)
+#define IEC61937_TRACE_H
+
+/**
+ * @file   iec61937_trace.h
+ * @brief  Event tracing interface of the IEC61937-13 encoder and decoder libraries.
+ *
+ * If the libraries are built with the CMake option iec61937-13_ENABLE_TRACING (which defines
+ * IEC61937_ENABLE_TRACING), a trace callback can be installed per encoder and decoder instance with
+ * iec61937_encode_set_trace() and iec61937_decode_set_trace(). The callback is invoked
+ * synchronously on the calling thread for each event. Without the option, the hooks and these
+ * functions are not compiled at all.
+ *
+ * The bundled trace sink (library iec61937-13_trace) records the events with a timestamp into a
+ * compact binary file, which iec61937-13_trace2json converts to the Chrome trace event format
+ * (viewable in chrome://tracing or Perfetto). The file starts with the 8 byte magic
+ * IEC61937_TRACE_MAGIC and a 32-bit little-endian version, followed by 16 byte records:
+ * - 64-bit little-endian value: nanoseconds since opening the sink << 8 | event
+ * - 32-bit little-endian arg0
+ * - 32-bit little-endian arg1 (signed)
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Trace events; the meaning of the arguments is given per event */
+typedef enum IEC61937_TRACE_EVENT {
+  IEC61937_TRACE_ENC_BURST_WRITTEN = 0,  /*!< IEC61937-13 frame written; arg0: MPEG-H frame bytes,
+                                              arg1: number of (partial) MPEG-H frames */
+  IEC61937_TRACE_ENC_PAUSE_WRITTEN,      /*!< pause burst written; arg0: IEC frame length in audio
+                                              samples */
+  IEC61937_TRACE_ENC_BUFFER_ERROR,       /*!< MPEG-H frame rejected with IECENC_BUFFER_ERROR; arg0:
+                                              frame length, arg1: number of stored frames */
+  IEC61937_TRACE_DEC_SYNC_ACQUIRED,      /*!< IEC frame found without a directly preceding IEC
+                                              frame; arg0: IEC frame length in audio samples, arg1:
+                                              burst repetition period in bytes */
+  IEC61937_TRACE_DEC_SYNC_LOST,          /*!< data dropped after an IEC frame; arg0: number of
+                                              dropped bytes (0 for a pending data error) */
+  IEC61937_TRACE_DEC_CANDIDATE_REJECTED, /*!< sync preamble rejected; arg0: IEC61937_TRACE_REJECT
+                                              reason, arg1: Pc of the candidate */
+  IEC61937_TRACE_DEC_AU_EMITTED,         /*!< MPEG-H frame obtained; arg0: frame length, arg1: PCM
+                                              offset */
+  IEC61937_TRACE_DEC_BUFFER_ERROR,       /*!< IECDEC_BUFFER_ERROR returned; arg0: required bytes,
+                                              arg1: available bytes */
+  IEC61937_TRACE_DEC_PENDINGDATA_ERROR,  /*!< IECDEC_PENDINGDATA_ERROR returned; arg0: number of
+                                              missing bytes of the split MPEG-H frame */
+  IEC61937_TRACE_NUM_EVENTS
+} IEC61937_TRACE_EVENT;
+
+/* Reasons of IEC61937_TRACE_DEC_CANDIDATE_REJECTED */
+typedef enum IEC61937_TRACE_REJECT {
+  IEC61937_TRACE_REJECT_PC = 0,          /*!< unsupported burst info (Pc) or burst length (Pd),
+                                              including other data types like pause bursts */
+  IEC61937_TRACE_REJECT_BURST_SPACING,   /*!< burst spacing is not zero */
+  IEC61937_TRACE_REJECT_PAYLOAD_HEADERS, /*!< inconsistent payload header offsets or lengths */
+} IEC61937_TRACE_REJECT;
+
+/**
+ * @brief Trace callback.
+ * @param[in] userData user data passed when installing the callback
+ * @param[in] event trace event
+ * @param[in] arg0 first event argument
+ * @param[in] arg1 second event argument
+ */
+typedef void (*IEC61937_TRACE_CALLBACK)(void* userData, IEC61937_TRACE_EVENT event, uint32_t arg0,
+                                        int32_t arg1);
+
+// Magic at the start of a binary trace file
+#define IEC61937_TRACE_MAGIC "IECTRACE"
+#define IEC61937_TRACE_VERSION 1
+#define IEC61937_TRACE_RECORD_SIZE 16
+
+/* Binary trace sink state structure */
+typedef struct iec61937_trace_sink* HANDLE_IEC61937_TRACE_SINK;
+
+/**
+ * @brief Open a binary trace sink writing to a file.
+ *
+ * The records are collected in memory and written in blocks, so the sink callback does not perform
+ * a system call per event. A sink must only be used from one thread at a time; encoder and decoder
+ * instances running on the same thread can share a sink.
+ * @param[in] fileName path of the binary trace file to be created
+ * @return HANDLE_IEC61937_TRACE_SINK on success or NULL in case of error
+ */
+HANDLE_IEC61937_TRACE_SINK iec61937_trace_sink_open(const char* fileName);
+
+/**
+ * @brief Trace callback of the binary sink.
+ *
+ * Install it with the sink handle as user data, e.g.
+ * iec61937_decode_set_trace(decoder, iec61937_trace_sink_callback, sink).
+ */
+void iec61937_trace_sink_callback(void* userData, IEC61937_TRACE_EVENT event, uint32_t arg0,
+                                  int32_t arg1);
+
+/**
+ * @brief Write the remaining records and close a binary trace sink.
+ * @param[in] h trace sink handle to be closed.
+ */
+void iec61937_trace_sink_close(HANDLE_IEC61937_TRACE_SINK h);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !defined(IEC61937_TRACE_H) */
@@ -0,0 +1,167 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#if !defined(MHAS_FRAMER_H)
+#define MHAS_FRAMER_H
+
+/**
+ * @file   mhas_framer.h
+ * @brief  MHAS framer library interface header file.
+ *
+ * The MHAS framer splits a continuous MPEG-H 3D Audio Stream (MHAS, ISO/IEC 23008-3 clause 14)
+ * into MPEG-H frames (access units) which can be passed to iec61937_encode_process(). An MPEG-H
+ * frame consists of all MHAS packets up to and including an MPEGH3DAFRAME packet, i.e. it carries
+ * the preceding SYNC and MPEGH3DACFG packets like the samples of an MP4 mhm1 track. The duration of
+ * the MPEG-H frames is derived from the coreSbrFrameLengthIndex of the last MPEGH3DACFG packet.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Maximum size in bytes of one MPEG-H frame (sequence of MHAS packets) for MPEG-H Level 4
+#define MHAS_MAX_AU_SIZE 65536
+
+#define MHAS_WORKBUFFER_SIZE_BYTES (MHAS_MAX_AU_SIZE) * 2
+
+typedef enum MHAS_RESULT {
+  MHAS_OK = 0,         /*!< Ok, no error */
+  MHAS_FEED_MORE_DATA, /*!< Ok, but more input data needs to be fed */
+  MHAS_BUFFER_ERROR,   /*!< Working buffer full or output buffer size too small */
+  MHAS_NULLPTR_ERROR,  /*!< A nullptr was used */
+} MHAS_RESULT;
+
+/* MHAS framer state structure */
+typedef struct mhas_framer_state* HANDLE_MHAS_FRAMER;
+
+/**
+ * @brief Open an MHAS framer instance.
+ *
+ * The MHAS stream is expected to start at an MHAS packet boundary. If the packet structure is lost
+ * (e.g. an MPEG-H frame exceeds MHAS_MAX_AU_SIZE), the framer resynchronizes at the next MHAS SYNC
+ * packet. MPEG-H frames before the first MPEGH3DACFG packet are discarded because their duration is
+ * unknown.
+ * @return HANDLE_MHAS_FRAMER on success or NULL in case of error
+ */
+HANDLE_MHAS_FRAMER mhas_framer_open(void);
+
+/**
+ * @brief Close an MHAS framer instance.
+ * @param[in] h framer handle to be closed.
+ */
+void mhas_framer_close(HANDLE_MHAS_FRAMER h);
+
+/**
+ * @brief Feed MHAS data chunks of arbitrary size to the MHAS framer.
+ * @param[in] h framer handle
+ * @param[in] inputBuffer pointer to a data buffer to read the input data from
+ * @param[in] inputBufferLength length in bytes of the provided input data
+ * @returns MHAS_OK in case of success, MHAS_BUFFER_ERROR if the size of the input data is too big
+ * to fit into the internal working buffer and MHAS_NULLPTR_ERROR if a nullptr was used as an input
+ * argument
+ */
+MHAS_RESULT mhas_framer_feed(HANDLE_MHAS_FRAMER h, const uint8_t* inputBuffer,
+                             uint32_t inputBufferLength);
+
+/**
+ * @brief Obtain the next complete MPEG-H frame from the fed MHAS data.
+ * @param[in] h framer handle
+ * @param[out] outputBuffer pointer to an output data buffer into which the MPEG-H frame is written
+ * @param[in,out] pOutputBufferLength pointer to the capacity of the outputBuffer on input and the
+ * number of bytes written into outputBuffer on output
+ * @param[out] pFrameDuration pointer to where the duration of the MPEG-H frame in samples is stored
+ * into (768, 1024, 2048 or 4096)
+ * @return MHAS_OK on success, MHAS_FEED_MORE_DATA if new data needs to be fed into the framer,
+ * MHAS_BUFFER_ERROR if the provided output buffer has not enough space to hold the output MPEG-H
+ * frame and MHAS_NULLPTR_ERROR if a nullptr was used as an input argument
+ */
+MHAS_RESULT mhas_framer_process(HANDLE_MHAS_FRAMER h, uint8_t* outputBuffer,
+                                uint32_t* pOutputBufferLength, uint32_t* pFrameDuration);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !defined(MHAS_FRAMER_H) */
@@ -0,0 +1,195 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "mhas_framer.h"
+
+#if !defined(MHAS_GENERATOR_H)
+#define MHAS_GENERATOR_H
+
+/**
+ * @file   mhas_generator.h
+ * @brief  Synthetic MHAS stream generator library interface header file.
+ *
+ * The generator creates MPEG-H frames (sequences of MHAS packets, ISO/IEC 23008-3 clause 14) for
+ * reproducible load tests without licensed content. A random access point (RAP) frame consists of
+ * a SYNC, an MPEGH3DACFG and an MPEGH3DAFRAME packet, all other frames of an MPEGH3DAFRAME packet.
+ * The packet structure and the configuration fields relevant for the transport (profile level
+ * indication, 48 kHz sampling frequency index and coreSbrFrameLengthIndex) are valid, so the
+ * frames can be processed by the MHAS framer, the IEC61937-13 libraries and MP4 writers. The
+ * usacIndependencyFlag of the frame payload is set for RAP frames; the rest of the payload is
+ * pseudo-random, i.e. the frames cannot be decoded to audio.
+ *
+ * The sizes are those of the complete MPEG-H frames including all MHAS packets, so a generated
+ * stream loads an encoder as configured (sizes from 2049 to 2051 bytes, which cannot be built
+ * because of the MHAS packet length coding, are rounded to the next possible size). The same
+ * configuration always results in the same stream.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Maximum number of entries of MHAS_GEN_CONFIG::frameDurations
+#define MHAS_GEN_MAX_FRAME_DURATIONS 8
+
+// MPEG-H 3D Audio Low Complexity profile, level 4
+#define MHAS_GEN_DEFAULT_PROFILE_LEVEL 0x0E
+
+/* Distribution of the MPEG-H frame sizes */
+typedef enum MHAS_GEN_SIZES {
+  MHAS_GEN_SIZES_CBR = 0,     /*!< every frame has the mean size given by the bit rate */
+  MHAS_GEN_SIZES_UNIFORM,     /*!< uniformly distributed within the mean size +/- variation */
+  MHAS_GEN_SIZES_EXPONENTIAL, /*!< exponentially distributed with the mean size (frequent small
+                                   frames and rare large peaks) */
+  MHAS_GEN_SIZES_PEAK,        /*!< every frame has maxAuSize (worst case, e.g. MHAS_MAX_AU_SIZE
+                                   for MPEG-H Level 4) */
+} MHAS_GEN_SIZES;
+
+/* MHAS generator configuration */
+typedef struct MHAS_GEN_CONFIG {
+  uint32_t bitrate;       /*!< mean bit rate in bit/s at 48 kHz */
+  MHAS_GEN_SIZES sizes;   /*!< distribution of the frame sizes */
+  uint32_t variation;     /*!< maximum deviation from the mean size in percent for
+                               MHAS_GEN_SIZES_UNIFORM (0 - 100) */
+  uint32_t maxAuSize;     /*!< upper limit of the frame sizes in bytes, at most MHAS_MAX_AU_SIZE
+                               (0 = MHAS_MAX_AU_SIZE) */
+  uint32_t rapInterval;   /*!< number of frames from one RAP frame to the next (0 = only the first
+                               frame is a RAP frame) */
+  uint32_t rapSizeFactor; /*!< size of RAP frames in percent of the drawn size, e.g. 300 for
+                               independently coded frames being three times as large */
+  /*! frame durations in audio samples (768, 1024, 2048 or 4096); the configuration switches to the
+      next entry at each RAP frame */
+  uint32_t frameDurations[MHAS_GEN_MAX_FRAME_DURATIONS];
+  uint32_t numFrameDurations;     /*!< number of valid entries in frameDurations (at least 1) */
+  uint8_t profileLevelIndication; /*!< mpegh3daProfileLevelIndication of the configuration */
+  uint32_t seed;                  /*!< seed of the pseudo-random sizes and payloads */
+} MHAS_GEN_CONFIG;
+
+/* MHAS generator state structure */
+typedef struct mhas_generator_state* HANDLE_MHAS_GENERATOR;
+
+/**
+ * @brief Initialize a generator configuration with the default values: 256 kbit/s CBR frames of
+ * 1024 samples with a RAP frame every 32 frames at Low Complexity profile level 4.
+ * @param[out] config configuration to be initialized
+ */
+void mhas_generator_config_init(MHAS_GEN_CONFIG* config);
+
+/**
+ * @brief Open an MHAS generator instance.
+ * @param[in] config generator configuration
+ * @return HANDLE_MHAS_GENERATOR on success or NULL in case of error (e.g. invalid configuration)
+ */
+HANDLE_MHAS_GENERATOR mhas_generator_open(const MHAS_GEN_CONFIG* config);
+
+/**
+ * @brief Close an MHAS generator instance.
+ * @param[in] h generator handle to be closed.
+ */
+void mhas_generator_close(HANDLE_MHAS_GENERATOR h);
+
+/**
+ * @brief Generate the next MPEG-H frame.
+ * @param[in] h generator handle
+ * @param[out] outputBuffer pointer to an output data buffer into which the MPEG-H frame is written
+ * @param[in,out] pOutputBufferLength pointer to the capacity of the outputBuffer on input and the
+ * number of bytes written into outputBuffer on output
+ * @param[out] pFrameDuration pointer to where the duration of the MPEG-H frame in samples is stored
+ * into
+ * @param[out] pIsRap pointer to where the info about the MPEG-H frame being a RAP frame is stored
+ * into, e.g. for the sync sample flag of an MP4 sample
+ * @return MHAS_OK on success, MHAS_BUFFER_ERROR if the provided output buffer has not enough space
+ * to hold the MPEG-H frame (the same frame is generated by the next call) and MHAS_NULLPTR_ERROR if
+ * a nullptr was used as an input argument
+ */
+MHAS_RESULT mhas_generator_process(HANDLE_MHAS_GENERATOR h, uint8_t* outputBuffer,
+                                   uint32_t* pOutputBufferLength, uint32_t* pFrameDuration,
+                                   bool* pIsRap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !defined(MHAS_GENERATOR_H) */
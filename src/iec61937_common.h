@@ -88,3 +88,22 @@ amm-info@iis.fraunhofer.de
 
 #define IEC_HEADER_SIZE_BYTES 8
 #define IEC_BURST_SPACING_SIZE_BYTES 8
+
+// Data types (Pc bits 0 - 4) according to IEC 61937
+#define IEC_DATA_TYPE_PAUSE 3
+#define IEC_DATA_TYPE_MPEGH 25
+
+// Invokes the trace callback of an encoder or decoder instance if one is installed; compiled out
+// without IEC61937_ENABLE_TRACING, so the arguments must not have side effects
+#if defined(IEC61937_ENABLE_TRACING)
+#define IEC61937_TRACE(h, event, arg0, arg1)                                              \
+  do {                                                                                    \
+    if ((h)->traceCallback != NULL) {                                                     \
+      (h)->traceCallback((h)->traceUserData, (event), (uint32_t)(arg0), (int32_t)(arg1)); \
+    }                                                                                     \
+  } while (0)
+#else
+#define IEC61937_TRACE(h, event, arg0, arg1) \
+  do {                                       \
+  } while (0)
+#endif
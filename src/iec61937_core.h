@@ -0,0 +1,314 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+#if !defined(IEC61937_CORE_H)
+#define IEC61937_CORE_H
+
+/**
+ * @file   iec61937_core.h
+ * @brief  Header-only IEC61937-13 frame core shared by encoder and decoder.
+ *
+ * The frame layout is described by a traits class. CIecFrameTraits fixes audio mode, rate factor
+ * and frame length at compile time, so all header offsets and sizes become constants.
+ * CIecFrameRuntimeTraits provides the same interface from runtime values (generic path).
+ */
+
+#include "iec61937_common.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#if !defined(IEC60958_FRAME_SIZE_BYTES)
+#define IEC60958_FRAME_SIZE_BYTES 4
+#endif
+
+namespace iec61937 {
+
+// Audio frame length in samples of a frame length code according to IEC 61937-13
+constexpr uint32_t getAudioFrameLength(uint8_t frameLengthCode) {
+  return (frameLengthCode == 0)   ? 1024
+         : (frameLengthCode == 1) ? 2048
+         : (frameLengthCode == 2) ? 4096
+         : (frameLengthCode == 3) ? 768
+         : (frameLengthCode == 4) ? 1536
+         : (frameLengthCode == 5) ? 3072
+                                  : 0;
+}
+
+// Burst repetition period in bytes
+constexpr uint32_t getBurstRepetitionPeriod(uint8_t audioMode, uint8_t rateFactorCode,
+                                            uint32_t audioFrameLength) {
+  return (audioMode == 1) ? (audioFrameLength * IEC60958_FRAME_SIZE_BYTES) << (rateFactorCode + 1)
+                          : audioFrameLength * IEC60958_FRAME_SIZE_BYTES;
+}
+
+// Payload header layout of an audio mode (0 = MPEG-H 3D Audio, 1 = MPEG-H 3D Audio HBR)
+template <uint8_t AudioMode>
+struct CIecAudioModeTraits {
+  static constexpr uint8_t audioMode() { return AudioMode; }
+  static constexpr uint32_t payloadHeaderSize() { return (AudioMode == 0) ? 6 : 8; }
+};
+
+// Complete IEC frame layout fixed at compile time
+template <uint8_t AudioMode, uint8_t RateFactorCode, uint8_t FrameLengthCode>
+struct CIecFrameTraits : public CIecAudioModeTraits<AudioMode> {
+  static constexpr uint8_t rateFactorCode() { return RateFactorCode; }
+  static constexpr uint8_t frameLengthCode() { return FrameLengthCode; }
+  static constexpr uint32_t audioFrameLength() { return getAudioFrameLength(FrameLengthCode); }
+  static constexpr uint32_t burstRepetitionPeriod() {
+    return getBurstRepetitionPeriod(AudioMode, RateFactorCode,
+                                    getAudioFrameLength(FrameLengthCode));
+  }
+};
+
+// Complete IEC frame layout determined at runtime
+struct CIecFrameRuntimeTraits {
+  uint8_t m_audioMode;
+  uint8_t m_rateFactorCode;
+  uint8_t m_frameLengthCode;
+
+  uint8_t audioMode() const { return m_audioMode; }
+  uint32_t payloadHeaderSize() const { return (m_audioMode == 0) ? 6 : 8; }
+  uint8_t rateFactorCode() const { return m_rateFactorCode; }
+  uint8_t frameLengthCode() const { return m_frameLengthCode; }
+  uint32_t audioFrameLength() const { return getAudioFrameLength(m_frameLengthCode); }
+  uint32_t burstRepetitionPeriod() const {
+    return getBurstRepetitionPeriod(m_audioMode, m_rateFactorCode, audioFrameLength());
+  }
+};
+
+// MPEG-H frames to be written into one IEC frame
+struct SIecFramePayload {
+  const uint8_t* const* frameData; /* first byte not yet written of each frame */
+  const uint32_t* frameLength;     /* bytes not yet written of each frame */
+  const uint32_t* frameDuration;   /* duration of each frame */
+  uint32_t numBuffersToWrite;      /* number of frames starting with the (pending) first one */
+  bool auPending;                  /* the first frame is the tail of a split frame */
+  uint32_t payloadLength;          /* sum of frameLength of all frames to be written */
+  uint32_t numAvailableBytes;      /* payload capacity of the IEC frame */
+};
+
+template <class Traits>
+inline uint8_t* writePayloadHeader(const Traits& traits, uint8_t* outputBuffer,
+                                   uint32_t dataOffset, uint32_t dataLength, int32_t pcmOffset) {
+  // write data offset field
+  if (traits.audioMode() == 1) {
+    *outputBuffer++ = (uint8_t)(dataOffset >> 16);
+  }
+  *outputBuffer++ = (uint8_t)(dataOffset >> 8);
+  *outputBuffer++ = (uint8_t)dataOffset;
+  // write data size field
+  if (traits.audioMode() == 1) {
+    *outputBuffer++ = (uint8_t)(dataLength >> 16);
+  }
+  *outputBuffer++ = (uint8_t)(dataLength >> 8);
+  *outputBuffer++ = (uint8_t)dataLength;
+  // write PCM offset field
+  *outputBuffer++ = (uint8_t)(pcmOffset >> 8);
+  *outputBuffer++ = (uint8_t)pcmOffset;
+  return outputBuffer;
+}
+
+template <class Traits>
+inline void parsePayloadHeader(const Traits& traits, const uint8_t* data, uint32_t* dataOffset,
+                               uint32_t* dataLength, int32_t* pcmOffset) {
+  if (traits.audioMode() == 0) {
+    *dataOffset = (data[0] << 8) | data[1];
+    *dataLength = (data[2] << 8) | data[3];
+    *pcmOffset = (data[4] << 8) | data[5];
+  } else {
+    *dataOffset = (data[0] << 16) | (data[1] << 8) | data[2];
+    *dataLength = (data[3] << 16) | (data[4] << 8) | data[5];
+    *pcmOffset = (data[6] << 8) | data[7];
+  }
+}
+
+// IEC frame writer without the padding. Introduces headers and includes the payload data. The PCM
+// offset of the first new frame is taken from pPcmOffset which is advanced by the written frame
+// durations. Returns the number of bytes written; the rest of the IEC frame is zero padding.
+template <class Traits>
+inline uint32_t writeIecFrameData(const Traits& traits, uint8_t* outputBuffer,
+                                  const SIecFramePayload& payload, int32_t* pPcmOffset) {
+  uint8_t* const frameStart = outputBuffer;
+  const uint32_t payloadHeaderSize = traits.payloadHeaderSize();
+
+  // write frame header
+  *outputBuffer++ = SYNC_PREAMBLE_0;  // Pa
+  *outputBuffer++ = SYNC_PREAMBLE_1;  // Pa
+  *outputBuffer++ = SYNC_PREAMBLE_2;  // Pb
+  *outputBuffer++ = SYNC_PREAMBLE_3;  // Pb
+  *outputBuffer++ =
+      (uint8_t)((traits.rateFactorCode() << 3) | traits.frameLengthCode());  // bits  8 - 12 of Pc
+  *outputBuffer++ =
+      (uint8_t)((traits.audioMode() << 5) | IEC_DATA_TYPE_MPEGH);  // bits  0 -  6 of Pc
+
+  uint32_t numPayloadHeaders = payload.numBuffersToWrite;
+  if (payload.auPending) {
+    numPayloadHeaders--;
+  }
+
+  uint32_t payloadDataLength = payload.numAvailableBytes;
+  if (payload.payloadLength < payload.numAvailableBytes) {
+    payloadDataLength = payload.payloadLength;
+  }
+  uint32_t dataBurstLengthBytes = payloadDataLength + (numPayloadHeaders + 1) * payloadHeaderSize;
+
+  uint32_t dataBurstLength = dataBurstLengthBytes;
+  if (traits.audioMode() == 1) {
+    // divided by 8
+    dataBurstLength = (dataBurstLengthBytes + 7) >> 3;
+  }
+
+  *outputBuffer++ = (uint8_t)(dataBurstLength >> 8);  // Pd
+  *outputBuffer++ = (uint8_t)dataBurstLength;         // Pd
+
+  // write payload headers
+  uint32_t dataOffset = IEC_HEADER_SIZE_BYTES + (numPayloadHeaders + 1) * payloadHeaderSize;
+
+  uint32_t i = 0;
+  if (payload.auPending) {
+    dataOffset += payload.frameLength[i];
+    i++;
+  }
+
+  int32_t pcmOffset = *pPcmOffset;
+  for (uint32_t j = 0; j < numPayloadHeaders; j++) {
+    outputBuffer =
+        writePayloadHeader(traits, outputBuffer, dataOffset, payload.frameLength[i], pcmOffset);
+    pcmOffset += payload.frameDuration[i];
+    dataOffset += payload.frameLength[i];
+    i++;
+  }
+  *pPcmOffset = pcmOffset;
+
+  // write last payload header with zeroes as list terminator
+  memset(outputBuffer, 0, payloadHeaderSize);
+  outputBuffer += payloadHeaderSize;
+
+  // write payload data
+  for (i = 0; i < payload.numBuffersToWrite && payloadDataLength > 0; i++) {
+    uint32_t copyLength = payload.frameLength[i];
+    if (copyLength > payloadDataLength) {
+      copyLength = payloadDataLength;
+    }
+    memcpy(outputBuffer, payload.frameData[i], copyLength);
+    outputBuffer += copyLength;
+    payloadDataLength -= copyLength;
+  }
+
+  return (uint32_t)(outputBuffer - frameStart);
+}
+
+// IEC frame writer. Introduces headers, trailers and includes the payload data. The PCM offset of
+// the first new frame is taken from pPcmOffset which is advanced by the written frame durations.
+template <class Traits>
+inline uint32_t writeIecFrame(const Traits& traits, uint8_t* outputBuffer,
+                              const SIecFramePayload& payload, int32_t* pPcmOffset) {
+  uint32_t lengthWritten = writeIecFrameData(traits, outputBuffer, payload, pPcmOffset);
+
+  // write padding and burst spacing
+  memset(outputBuffer + lengthWritten, 0, traits.burstRepetitionPeriod() - lengthWritten);
+
+  return traits.burstRepetitionPeriod();
+}
+
+// Pause burst writer according to IEC 61937-1 without the padding. The burst payload consists of
+// the gap length and a reserved word. Returns the number of bytes written.
+inline uint32_t writePauseBurst(uint8_t* outputBuffer, uint16_t gapLength) {
+  outputBuffer[0] = SYNC_PREAMBLE_0;      // Pa
+  outputBuffer[1] = SYNC_PREAMBLE_1;      // Pa
+  outputBuffer[2] = SYNC_PREAMBLE_2;      // Pb
+  outputBuffer[3] = SYNC_PREAMBLE_3;      // Pb
+  outputBuffer[4] = 0;                    // bits 8 - 12 of Pc
+  outputBuffer[5] = IEC_DATA_TYPE_PAUSE;  // bits 0 - 4 of Pc
+  outputBuffer[6] = 0;                    // Pd
+  outputBuffer[7] = 32;                   // Pd: burst payload length in bits
+  outputBuffer[8] = (uint8_t)(gapLength >> 8);
+  outputBuffer[9] = (uint8_t)gapLength;
+  outputBuffer[10] = 0;  // reserved
+  outputBuffer[11] = 0;  // reserved
+  return 12;
+}
+
+}  // namespace iec61937
+
+#endif /* !defined(IEC61937_CORE_H) */
@@ -82,12 +82,19 @@ amm-info@iis.fraunhofer.de
 
 #include "iec61937_dec.h"
 #include "iec61937_common.h"
+#include "iec61937_core.h"
+#include "iec61937_pcm.h"
 
 #include <stdlib.h>
 #include <string.h>
 
+// The first bytes of the circular work buffer are mirrored behind its end, so an IEC header, a
+// payload header or the burst spacing can be read contiguously at any position.
+#define WORKBUFFER_MIRROR_BYTES 8
+
 struct iec61937_decoder_state {
-  uint8_t workBuffer[WORKBUFFER_SIZE_BYTES];
+  uint8_t workBuffer[WORKBUFFER_SIZE_BYTES + WORKBUFFER_MIRROR_BYTES];
+  uint32_t workBufferReadIndex; /* position of the first available byte in the work buffer */
   uint32_t workBufferBytesAvailable;
 
   // Pending data state
@@ -97,6 +104,7 @@ struct iec61937_decoder_state {
   int32_t pcmOffsetPending; /* PCM offset of pending audio frame */
 
   // Sync state
+  bool syncLocked; /* no data was dropped since the last IEC frame */
   bool syncFound;
   bool syncCandidateFound;
   uint32_t syncCandidateIndex;
@@ -111,6 +119,16 @@ struct iec61937_decoder_state {
   uint32_t payloadHeaderSize;
   uint32_t numPayloadHeaders;
   uint32_t payloadHeaderIndex;
+
+  // Real-time state
+  uint32_t maxBytesPerCall; /* sync search budget of a process call (0 = unlimited) */
+
+  IEC61937_DEC_STATS stats;
+
+#if defined(IEC61937_ENABLE_TRACING)
+  IEC61937_TRACE_CALLBACK traceCallback;
+  void* traceUserData;
+#endif
 } iec61937_decoder_state;
 
 static void resetSyncState(HANDLE_IEC61937_DECODER h) {
@@ -137,17 +155,75 @@ static void resetPendingState(HANDLE_IEC61937_DECODER h) {
   h->pcmOffsetPending = 0;
 }
 
+// Returns the position in the work buffer of the available byte at index.
+static uint32_t getWorkBufferPosition(HANDLE_IEC61937_DECODER h, uint32_t index) {
+  uint32_t position = h->workBufferReadIndex + index;
+  if (position >= WORKBUFFER_SIZE_BYTES) {
+    position -= WORKBUFFER_SIZE_BYTES;
+  }
+  return position;
+}
+
+// Returns a pointer to the available byte at index; up to WORKBUFFER_MIRROR_BYTES bytes can be
+// read from it.
+static const uint8_t* getWorkBufferData(HANDLE_IEC61937_DECODER h, uint32_t index) {
+  return h->workBuffer + getWorkBufferPosition(h, index);
+}
+
+// Copies numBytes available bytes starting at index from the work buffer.
+static void copyFromWorkBuffer(HANDLE_IEC61937_DECODER h, uint8_t* output, uint32_t index,
+                               uint32_t numBytes) {
+  uint32_t position = getWorkBufferPosition(h, index);
+  uint32_t firstLength = WORKBUFFER_SIZE_BYTES - position;
+  if (numBytes <= firstLength) {
+    memcpy(output, h->workBuffer + position, numBytes);
+  } else {
+    memcpy(output, h->workBuffer + position, firstLength);
+    memcpy(output + firstLength, h->workBuffer, numBytes - firstLength);
+  }
+}
+
+// Removes numBytes from the start of the work buffer.
+static void removeWorkBufferBytes(HANDLE_IEC61937_DECODER h, uint32_t numBytes) {
+  h->workBufferReadIndex = getWorkBufferPosition(h, numBytes);
+  h->workBufferBytesAvailable -= numBytes;
+  if (h->workBufferBytesAvailable == 0) {
+    h->workBufferReadIndex = 0;
+  }
+}
+
+// Removes numBytes from the start of the work buffer which do not belong to an IEC frame.
+static void discardWorkBufferBytes(HANDLE_IEC61937_DECODER h, uint32_t numBytes) {
+  if (numBytes == 0) {
+    return;
+  }
+  h->stats.bytesDiscarded += numBytes;
+  if (h->syncLocked) {
+    h->syncLocked = false;
+    h->stats.numSyncLost++;
+    IEC61937_TRACE(h, IEC61937_TRACE_DEC_SYNC_LOST, numBytes, 0);
+  }
+  removeWorkBufferBytes(h, numBytes);
+}
+
+#if defined(IEC61937_ENABLE_TRACING)
+// Returns the burst info (Pc) of the IEC header at data.
+static uint16_t getPc(const uint8_t* data) {
+  return (uint16_t)((data[4] << 8) | data[5]);
+}
+#endif
+
 static int32_t parseIecFrameData(HANDLE_IEC61937_DECODER h) {
   // Parse Pc, Pd
-  uint16_t dataType = h->workBuffer[h->syncCandidateIndex + 5] & 0x1f;
-  uint16_t audioMode = (h->workBuffer[h->syncCandidateIndex + 5] >> 5) & 0x3;
-  uint16_t frameLengthCode = h->workBuffer[h->syncCandidateIndex + 4] & 0x7;
-  uint16_t rateFactor = (h->workBuffer[h->syncCandidateIndex + 4] >> 3) & 0x3;
-  uint32_t payloadLength = (uint16_t)(h->workBuffer[h->syncCandidateIndex + 6] << 8) +
-                           (uint16_t)h->workBuffer[h->syncCandidateIndex + 7];
+  const uint8_t* header = getWorkBufferData(h, h->syncCandidateIndex);
+  uint16_t dataType = header[5] & 0x1f;
+  uint16_t audioMode = (header[5] >> 5) & 0x3;
+  uint16_t frameLengthCode = header[4] & 0x7;
+  uint16_t rateFactor = (header[4] >> 3) & 0x3;
+  uint32_t payloadLength = (uint16_t)(header[6] << 8) + (uint16_t)header[7];
 
   // check data type for MPEG-H 3D Audio
-  if (dataType != 25) {
+  if (dataType != IEC_DATA_TYPE_MPEGH) {
     return 1;
   }
 
@@ -159,38 +235,14 @@ static int32_t parseIecFrameData(HANDLE_IEC61937_DECODER h) {
   }
 
   // check the data frame length
-  uint32_t frameLength = 0;
-  switch (frameLengthCode) {
-    case 0:
-      frameLength = 1024;
-      break;
-    case 1:
-      frameLength = 2048;
-      break;
-    case 2:
-      frameLength = 4096;
-      break;
-    case 3:
-      frameLength = 768;
-      break;
-    case 4:
-      frameLength = 1536;
-      break;
-    case 5:
-      frameLength = 3072;
-      break;
-    default:
-      break;
-  }
+  uint32_t frameLength = iec61937::getAudioFrameLength((uint8_t)frameLengthCode);
   if (frameLength == 0) {
     return 1;
   }
 
   // determine the burst repetition period
-  uint32_t burstRepetitionPeriod = frameLength * IEC60958_FRAME_SIZE_BYTES;
-  if (audioMode == 1) {
-    burstRepetitionPeriod = burstRepetitionPeriod << (rateFactor + 1);
-  }
+  uint32_t burstRepetitionPeriod =
+      iec61937::getBurstRepetitionPeriod((uint8_t)audioMode, (uint8_t)rateFactor, frameLength);
 
   // adjust payload length to be in number of bytes
   if (audioMode == 1) {
@@ -218,24 +270,22 @@ static int32_t parseIecFrameData(HANDLE_IEC61937_DECODER h) {
   return 0;
 }
 
-static void parsePayloadHeader(HANDLE_IEC61937_DECODER h, uint8_t* data, uint32_t* dataOffset,
+static void parsePayloadHeader(HANDLE_IEC61937_DECODER h, const uint8_t* data, uint32_t* dataOffset,
                                uint32_t* dataLength, int32_t* pcmOffset) {
   if (h->audioMode == 0) {
-    *dataOffset = (data[0] << 8) | data[1];
-    *dataLength = (data[2] << 8) | data[3];
-    *pcmOffset = (data[4] << 8) | data[5];
+    iec61937::parsePayloadHeader(iec61937::CIecAudioModeTraits<0>(), data, dataOffset, dataLength,
+                                 pcmOffset);
   } else {
-    *dataOffset = (data[0] << 16) | (data[1] << 8) | data[2];
-    *dataLength = (data[3] << 16) | (data[4] << 8) | data[5];
-    *pcmOffset = (data[6] << 8) | data[7];
+    iec61937::parsePayloadHeader(iec61937::CIecAudioModeTraits<1>(), data, dataOffset, dataLength,
+                                 pcmOffset);
   }
 }
 
-static bool checkPayloadHeaders(HANDLE_IEC61937_DECODER h, uint32_t* numPayloadHeaders) {
+template <class Traits>
+static bool checkPayloadHeaders(const Traits& traits, HANDLE_IEC61937_DECODER h,
+                                uint32_t* numPayloadHeaders, uint32_t* payloadHeadersLength) {
   // get the number of payload headers and check the offsets
-  uint32_t payloadHeadersLength = 0;
   uint32_t payloadStartIndex = h->syncCandidateIndex + IEC_HEADER_SIZE_BYTES;
-  uint8_t* headerPointer = &h->workBuffer[payloadStartIndex];
   uint32_t firstPayloadOffset = 0;
   uint32_t previousPayloadOffset = 0;
   while (true) {
@@ -243,10 +293,20 @@ static bool checkPayloadHeaders(HANDLE_IEC61937_DECODER h, uint32_t* numPayloadH
     uint32_t dataLength = 0;
     int32_t pcmOffset = 0;
 
+    // the payload header list including its terminator is part of the payload
+    if (*payloadHeadersLength + traits.payloadHeaderSize() > h->payloadLength) {
+      return false;
+    }
+
     // Parse audio burst payload header
-    parsePayloadHeader(h, headerPointer, &dataOffset, &dataLength, &pcmOffset);
+    const uint8_t* headerPointer = getWorkBufferData(h, payloadStartIndex + *payloadHeadersLength);
+    iec61937::parsePayloadHeader(traits, headerPointer, &dataOffset, &dataLength, &pcmOffset);
 
     if (dataLength > 0) {
+      // larger MPEG-H frames cannot be reassembled in the pending buffer
+      if (dataLength > MAX_MPEGH_FRAME_SIZE) {
+        return false;
+      }
       if (*numPayloadHeaders == 0) {
         firstPayloadOffset = dataOffset;
       } else {
@@ -256,29 +316,42 @@ static bool checkPayloadHeaders(HANDLE_IEC61937_DECODER h, uint32_t* numPayloadH
       }
       previousPayloadOffset = dataOffset;
 
-      if (dataOffset > h->payloadLength) {
+      // the data offset is relative to the start of the IEC frame, so the data has to start before
+      // the end of the payload
+      if (dataOffset >= IEC_HEADER_SIZE_BYTES + h->payloadLength) {
         return false;
       }
     }
-    payloadHeadersLength += h->payloadHeaderSize;
-    headerPointer += h->payloadHeaderSize;
+    *payloadHeadersLength += traits.payloadHeaderSize();
     if (dataLength == 0) {
       break;
     }
     (*numPayloadHeaders)++;
   }
   if (*numPayloadHeaders > 0) {
-    if (firstPayloadOffset < payloadHeadersLength + IEC_HEADER_SIZE_BYTES + h->frameBytesMissing) {
+    if (firstPayloadOffset <
+        *payloadHeadersLength + IEC_HEADER_SIZE_BYTES + h->frameBytesMissing) {
       return false;
     }
   }
   return true;
 }
 
+static bool checkPayloadHeaders(HANDLE_IEC61937_DECODER h, uint32_t* numPayloadHeaders,
+                                uint32_t* payloadHeadersLength) {
+  if (h->audioMode == 0) {
+    return checkPayloadHeaders(iec61937::CIecAudioModeTraits<0>(), h, numPayloadHeaders,
+                               payloadHeadersLength);
+  }
+  return checkPayloadHeaders(iec61937::CIecAudioModeTraits<1>(), h, numPayloadHeaders,
+                             payloadHeadersLength);
+}
+
 static bool checkBurstSpacing(HANDLE_IEC61937_DECODER h) {
-  for (uint32_t k = h->syncCandidateIndex + h->burstRepetitionPeriod - IEC_BURST_SPACING_SIZE_BYTES;
-       k < h->syncCandidateIndex + h->burstRepetitionPeriod; k++) {
-    if (h->workBuffer[k] != 0) {
+  const uint8_t* burstSpacing = getWorkBufferData(
+      h, h->syncCandidateIndex + h->burstRepetitionPeriod - IEC_BURST_SPACING_SIZE_BYTES);
+  for (uint32_t k = 0; k < IEC_BURST_SPACING_SIZE_BYTES; k++) {
+    if (burstSpacing[k] != 0) {
       return false;
     }
   }
@@ -302,18 +375,74 @@ void iec61937_decode_close(HANDLE_IEC61937_DECODER h) {
 
 IECDEC_RESULT iec61937_decode_feed(HANDLE_IEC61937_DECODER h, const uint8_t* inputBuffer,
                                    uint32_t inputBufferLength) {
+  return iec61937_decode_feed_format(h, inputBuffer, inputBufferLength,
+                                     IEC61937_PCM_FORMAT_S16_BE);
+}
+
+IECDEC_RESULT iec61937_decode_feed_format(HANDLE_IEC61937_DECODER h, const uint8_t* inputBuffer,
+                                          uint32_t inputBufferLength,
+                                          IEC61937_PCM_FORMAT inputFormat) {
   if (h == NULL || inputBuffer == NULL) {
     return IECDEC_NULLPTR_ERROR;
   }
+  uint32_t containerSize = iec61937::getPcmContainerSize(inputFormat);
+  if (containerSize == 0) {
+    return IECDEC_FORMAT_ERROR;
+  }
+  if (inputFormat == IEC61937_PCM_FORMAT_S16_BE) {
+    // the packed big-endian data is copied as it is, also an odd number of bytes
+    containerSize = 1;
+  } else if (inputBufferLength % containerSize != 0) {
+    return IECDEC_FORMAT_ERROR;
+  }
+  uint32_t convertedLength = inputBufferLength / containerSize * ((containerSize == 1) ? 1 : 2);
+
   // check if the input data fits into the work buffer
-  if (h->workBufferBytesAvailable > UINT32_MAX - inputBufferLength ||
-      h->workBufferBytesAvailable + inputBufferLength > WORKBUFFER_SIZE_BYTES) {
+  if (h->workBufferBytesAvailable > UINT32_MAX - convertedLength ||
+      h->workBufferBytesAvailable + convertedLength > WORKBUFFER_SIZE_BYTES) {
+    IEC61937_TRACE(h, IEC61937_TRACE_DEC_BUFFER_ERROR, convertedLength,
+                   WORKBUFFER_SIZE_BYTES - h->workBufferBytesAvailable);
     return IECDEC_BUFFER_ERROR;
   }
 
-  // copy the input data to the work buffer
-  memcpy(h->workBuffer + h->workBufferBytesAvailable, inputBuffer, inputBufferLength);
-  h->workBufferBytesAvailable += inputBufferLength;
+  // copy the input data to the work buffer, wrapping around at its end
+  uint32_t writePosition = getWorkBufferPosition(h, h->workBufferBytesAvailable);
+  uint32_t firstLength = WORKBUFFER_SIZE_BYTES - writePosition;
+  if (containerSize == 1) {
+    if (convertedLength <= firstLength) {
+      memcpy(h->workBuffer + writePosition, inputBuffer, convertedLength);
+    } else {
+      memcpy(h->workBuffer + writePosition, inputBuffer, firstLength);
+      memcpy(h->workBuffer, inputBuffer + firstLength, convertedLength - firstLength);
+    }
+  } else {
+    uint32_t numWords = convertedLength / 2;
+    uint32_t numFirstWords = (numWords < firstLength / 2) ? numWords : firstLength / 2;
+    iec61937::convertFromPcmFormat(inputFormat, h->workBuffer + writePosition, inputBuffer,
+                                   numFirstWords);
+    uint32_t numWordsWritten = numFirstWords;
+    if (numWordsWritten < numWords && firstLength % 2 != 0) {
+      // the word at the end of the work buffer is split (odd S16_BE data fed before)
+      uint8_t word[2];
+      iec61937::convertFromPcmFormat(inputFormat, word,
+                                     inputBuffer + numWordsWritten * containerSize, 1);
+      h->workBuffer[WORKBUFFER_SIZE_BYTES - 1] = word[0];
+      h->workBuffer[0] = word[1];
+      numWordsWritten++;
+    }
+    if (numWordsWritten < numWords) {
+      uint32_t secondPosition = 2 * numWordsWritten - firstLength;
+      iec61937::convertFromPcmFormat(inputFormat, h->workBuffer + secondPosition,
+                                     inputBuffer + numWordsWritten * containerSize,
+                                     numWords - numWordsWritten);
+    }
+  }
+  memcpy(h->workBuffer + WORKBUFFER_SIZE_BYTES, h->workBuffer, WORKBUFFER_MIRROR_BYTES);
+  h->workBufferBytesAvailable += convertedLength;
+  h->stats.bytesFed += convertedLength;
+  if (h->workBufferBytesAvailable > h->stats.workBufferHighWaterMark) {
+    h->stats.workBufferHighWaterMark = h->workBufferBytesAvailable;
+  }
   return IECDEC_OK;
 }
 
@@ -330,69 +459,118 @@ IECDEC_RESULT iec61937_decode_process(HANDLE_IEC61937_DECODER h, uint8_t* output
   *pIecFrameLength = 0;
   *pIecFrameProcessed = false;
 
-  while (!h->syncFound && h->workBufferBytesAvailable > IEC_HEADER_SIZE_BYTES) {
+  // the number of bytes the sync search may still examine in this call
+  uint32_t searchBudget = (h->maxBytesPerCall > 0) ? h->maxBytesPerCall : UINT32_MAX;
+  bool searchBudgetExhausted = false;
+
+  while (!h->syncFound && h->workBufferBytesAvailable > IEC_HEADER_SIZE_BYTES &&
+         !searchBudgetExhausted) {
     while (!h->syncCandidateFound && h->workBufferBytesAvailable > IEC_HEADER_SIZE_BYTES) {
-      for (uint32_t i = 0; i < h->workBufferBytesAvailable - IEC_HEADER_SIZE_BYTES; i++) {
-        // search for sync preamble
-        if (h->workBuffer[i + 0] == SYNC_PREAMBLE_0 && h->workBuffer[i + 1] == SYNC_PREAMBLE_1 &&
-            h->workBuffer[i + 2] == SYNC_PREAMBLE_2 && h->workBuffer[i + 3] == SYNC_PREAMBLE_3) {
-          // store the workbuffer index of the sync candidate
-          h->syncCandidateIndex = i;
-
-          // parse and process IEC frame data (Pc, Pd)
-          int32_t err = parseIecFrameData(h);
-          if (err > 0) {
-            // something went wrong when parsing the frame data
-            continue;
-          }
+      uint32_t numBytesToScan = h->workBufferBytesAvailable - IEC_HEADER_SIZE_BYTES;
+      if (numBytesToScan > searchBudget) {
+        numBytesToScan = searchBudget;
+      }
+      if (numBytesToScan == 0) {
+        searchBudgetExhausted = true;
+        break;
+      }
+      uint32_t numBytesScanned = numBytesToScan;
+      uint32_t i = 0;
+      while (i < numBytesToScan && !h->syncCandidateFound) {
+        // scan up to the end of the circular work buffer; the mirrored bytes behind it complete
+        // a sync preamble at its end
+        const uint8_t* data = getWorkBufferData(h, i);
+        uint32_t segmentEnd = i + WORKBUFFER_SIZE_BYTES - (uint32_t)(data - h->workBuffer);
+        if (segmentEnd > numBytesToScan) {
+          segmentEnd = numBytesToScan;
+        }
+        for (; i < segmentEnd; i++, data++) {
+          // search for sync preamble
+          if (data[0] == SYNC_PREAMBLE_0 && data[1] == SYNC_PREAMBLE_1 &&
+              data[2] == SYNC_PREAMBLE_2 && data[3] == SYNC_PREAMBLE_3) {
+            // store the workbuffer index of the sync candidate
+            h->syncCandidateIndex = i;
+
+            // parse and process IEC frame data (Pc, Pd)
+            int32_t err = parseIecFrameData(h);
+            if (err > 0) {
+              // something went wrong when parsing the frame data
+              h->stats.numRejectedPc++;
+              IEC61937_TRACE(h, IEC61937_TRACE_DEC_CANDIDATE_REJECTED, IEC61937_TRACE_REJECT_PC,
+                             getPc(data));
+              continue;
+            }
+
+            // signal that a possible sync candidate has been found
+            h->syncCandidateFound = true;
+            numBytesScanned = i + 1;
+            break;
+          }  // if preamble
+        }    // for loop
+      }
 
-          // signal that a possible sync candidate has been found
-          h->syncCandidateFound = true;
-          break;
-        }  // if preamble
-      }    // for loop
+      h->stats.bytesScanned += numBytesScanned;
+      searchBudget -= numBytesScanned;
 
       // adjust the workBuffer
       if (h->syncCandidateFound) {
         // remove everything before the syncCandidateIndex
-        memmove(h->workBuffer, h->workBuffer + h->syncCandidateIndex,
-                h->workBufferBytesAvailable - h->syncCandidateIndex);
-        h->workBufferBytesAvailable -= h->syncCandidateIndex;
+        discardWorkBufferBytes(h, h->syncCandidateIndex);
       } else {
-        // no sync found -> only keep the last IEC_HEADER_SIZE_BYTES bytes
-        memmove(h->workBuffer, h->workBuffer + h->workBufferBytesAvailable - IEC_HEADER_SIZE_BYTES,
-                IEC_HEADER_SIZE_BYTES);
-        h->workBufferBytesAvailable = IEC_HEADER_SIZE_BYTES;
+        // no sync found -> only keep the last IEC_HEADER_SIZE_BYTES bytes or the bytes which have
+        // not been scanned because of the search budget
+        discardWorkBufferBytes(h, numBytesScanned);
       }
       h->syncCandidateIndex = 0;
     }  // while (!h->syncCandidateFound && h->workBufferBytesAvailable - IEC_HEADER_SIZE_BYTES > 0)
 
     if (h->syncCandidateFound) {
       if (h->workBufferBytesAvailable >= h->syncCandidateIndex + h->burstRepetitionPeriod) {
-        if (checkBurstSpacing(h)) {
+        // the checks of the candidate are charged to the search budget as well
+        uint32_t numBytesChecked = IEC_BURST_SPACING_SIZE_BYTES;
+        bool burstSpacingOk = checkBurstSpacing(h);
+        uint32_t numPayloadHeaders = 0;
+        uint32_t payloadHeadersLength = 0;
+        bool payloadHeadersOk =
+            burstSpacingOk && checkPayloadHeaders(h, &numPayloadHeaders, &payloadHeadersLength);
+        if (burstSpacingOk) {
+          numBytesChecked += payloadHeadersLength + h->payloadHeaderSize;
+        }
+        searchBudget -= (numBytesChecked < searchBudget) ? numBytesChecked : searchBudget;
+
+        if (burstSpacingOk) {
           // we found an IEC frame
-          uint32_t numPayloadHeaders = 0;
-          if (checkPayloadHeaders(h, &numPayloadHeaders)) {
+          if (payloadHeadersOk) {
             // the found frame is okay
             h->syncFound = true;
+            if (!h->syncLocked) {
+              h->syncLocked = true;
+              h->stats.numSyncAcquired++;
+              IEC61937_TRACE(h, IEC61937_TRACE_DEC_SYNC_ACQUIRED, h->frameLength,
+                             h->burstRepetitionPeriod);
+            }
             h->numPayloadHeaders = numPayloadHeaders;
             h->payloadHeaderIndex = 0;
           } else {
             // there is some offset missmatch
-            // remove everything before the syncCandidateIndex and restart syncing, reset all states
-            memmove(h->workBuffer, h->workBuffer + h->syncCandidateIndex + IEC_HEADER_SIZE_BYTES,
-                    h->workBufferBytesAvailable - h->syncCandidateIndex - IEC_HEADER_SIZE_BYTES);
-            h->workBufferBytesAvailable -= h->syncCandidateIndex;
+            // remove the IEC header of the candidate and restart syncing, reset all states
+            h->stats.numRejectedPayloadHeaders++;
+            IEC61937_TRACE(h, IEC61937_TRACE_DEC_CANDIDATE_REJECTED,
+                           IEC61937_TRACE_REJECT_PAYLOAD_HEADERS,
+                           getPc(getWorkBufferData(h, h->syncCandidateIndex)));
+            discardWorkBufferBytes(h, h->syncCandidateIndex + IEC_HEADER_SIZE_BYTES);
             resetSyncState(h);
             resetParsingState(h);
             resetPendingState(h);
           }
         } else {
           // no correct IEC frame because burst spacing is wrong
-          // remove everything before the syncCandidateIndex and restart syncing
-          memmove(h->workBuffer, h->workBuffer + h->syncCandidateIndex + IEC_HEADER_SIZE_BYTES,
-                  h->workBufferBytesAvailable - h->syncCandidateIndex - IEC_HEADER_SIZE_BYTES);
-          h->workBufferBytesAvailable -= h->syncCandidateIndex;
+          // remove the IEC header of the candidate and restart syncing
+          h->stats.numRejectedBurstSpacing++;
+          IEC61937_TRACE(h, IEC61937_TRACE_DEC_CANDIDATE_REJECTED,
+                         IEC61937_TRACE_REJECT_BURST_SPACING,
+                         getPc(getWorkBufferData(h, h->syncCandidateIndex)));
+          discardWorkBufferBytes(h, h->syncCandidateIndex + IEC_HEADER_SIZE_BYTES);
           resetSyncState(h);
         }
       } else {
@@ -404,6 +582,10 @@ IECDEC_RESULT iec61937_decode_process(HANDLE_IEC61937_DECODER h, uint8_t* output
   }    // while (!h->syncFound && h->workBufferBytesAvailable - IEC_HEADER_SIZE_BYTES > 0)
 
   if (!h->syncFound) {
+    if (searchBudgetExhausted) {
+      // the sync search continues with the next call
+      return IECDEC_BUDGET_EXHAUSTED;
+    }
     // we were unable to find the sync on the current work buffer data
     return IECDEC_FEED_MORE_DATA;
   }
@@ -419,29 +601,47 @@ IECDEC_RESULT iec61937_decode_process(HANDLE_IEC61937_DECODER h, uint8_t* output
 
       if (h->frameBytesMissing > payloadBytesAvailable) {
         // the pending data cannot be completed -> copy complete payload data to pending buffer
-        memcpy(h->frameBufferPending + h->frameBytesPending, h->workBuffer + dataIndex,
-               payloadBytesAvailable);
+        copyFromWorkBuffer(h, h->frameBufferPending + h->frameBytesPending, dataIndex,
+                           payloadBytesAvailable);
         h->frameBytesPending += payloadBytesAvailable;
         h->frameBytesMissing -= payloadBytesAvailable;
         h->pcmOffsetPending -= h->frameLength;
       } else {
-        // the pending data can be completed
-        if (h->frameBytesMissing < payloadBytesAvailable) {
+        // the pending data can be completed; in audio mode 1 the payload length is signaled in
+        // multiples of 8 bytes, so up to 7 bytes of padding may follow the pending data
+        uint32_t maxPaddingBytes = (h->audioMode == 0) ? 0 : 7;
+        if (payloadBytesAvailable - h->frameBytesMissing > maxPaddingBytes) {
           // The pending data could be completed, but too much payload data is still available
+          IEC61937_TRACE(h, IEC61937_TRACE_DEC_PENDINGDATA_ERROR, h->frameBytesMissing,
+                         payloadBytesAvailable);
+          resetSyncState(h);
+          resetParsingState(h);
+          resetPendingState(h);
+          h->stats.numPendingDataErrors++;
+          if (h->syncLocked) {
+            h->syncLocked = false;
+            h->stats.numSyncLost++;
+            IEC61937_TRACE(h, IEC61937_TRACE_DEC_SYNC_LOST, 0, 0);
+          }
           return IECDEC_PENDINGDATA_ERROR;
         }
         // check if there is enough space in the output buffer
         if (h->frameBytesPending + h->frameBytesMissing > outputBufferLength) {
+          IEC61937_TRACE(h, IEC61937_TRACE_DEC_BUFFER_ERROR,
+                         h->frameBytesPending + h->frameBytesMissing, outputBufferLength);
           return IECDEC_BUFFER_ERROR;
         }
         // copy previous data
         memcpy(outputBuffer, h->frameBufferPending, h->frameBytesPending);
         // copy current data
-        memcpy(outputBuffer + h->frameBytesPending, h->workBuffer + dataIndex,
-               h->frameBytesMissing);
+        copyFromWorkBuffer(h, outputBuffer + h->frameBytesPending, dataIndex,
+                           h->frameBytesMissing);
         *pOutputBufferLength = h->frameBytesPending + h->frameBytesMissing;
         *pPcmOffset = h->pcmOffsetPending;
         resetPendingState(h);
+        h->stats.numAus++;
+        h->stats.numSplitAus++;
+        IEC61937_TRACE(h, IEC61937_TRACE_DEC_AU_EMITTED, *pOutputBufferLength, *pPcmOffset);
         return IECDEC_OK;
       }
     } else {
@@ -449,12 +649,14 @@ IECDEC_RESULT iec61937_decode_process(HANDLE_IEC61937_DECODER h, uint8_t* output
 
       // check if there is enough space in the output buffer
       if (h->frameBytesPending + h->frameBytesMissing > outputBufferLength) {
+        IEC61937_TRACE(h, IEC61937_TRACE_DEC_BUFFER_ERROR,
+                       h->frameBytesPending + h->frameBytesMissing, outputBufferLength);
         return IECDEC_BUFFER_ERROR;
       }
 
       // get first payload header offset
       uint32_t headerIndex = h->syncCandidateIndex + IEC_HEADER_SIZE_BYTES;
-      uint8_t* headerPointer = &h->workBuffer[headerIndex];
+      const uint8_t* headerPointer = getWorkBufferData(h, headerIndex);
       uint32_t dataOffset = 0;
       uint32_t dataLength = 0;
       int32_t pcmOffset = 0;
@@ -462,9 +664,16 @@ IECDEC_RESULT iec61937_decode_process(HANDLE_IEC61937_DECODER h, uint8_t* output
       parsePayloadHeader(h, headerPointer, &dataOffset, &dataLength, &pcmOffset);
 
       if (h->syncCandidateIndex + dataOffset < h->frameBytesMissing) {
+        IEC61937_TRACE(h, IEC61937_TRACE_DEC_PENDINGDATA_ERROR, h->frameBytesMissing, 0);
         resetSyncState(h);
         resetParsingState(h);
         resetPendingState(h);
+        h->stats.numPendingDataErrors++;
+        if (h->syncLocked) {
+          h->syncLocked = false;
+          h->stats.numSyncLost++;
+          IEC61937_TRACE(h, IEC61937_TRACE_DEC_SYNC_LOST, 0, 0);
+        }
         return IECDEC_PENDINGDATA_ERROR;
       }
       uint32_t dataIndex = h->syncCandidateIndex + dataOffset - h->frameBytesMissing;
@@ -472,10 +681,13 @@ IECDEC_RESULT iec61937_decode_process(HANDLE_IEC61937_DECODER h, uint8_t* output
       // copy previous data
       memcpy(outputBuffer, h->frameBufferPending, h->frameBytesPending);
       // copy current data
-      memcpy(outputBuffer + h->frameBytesPending, h->workBuffer + dataIndex, h->frameBytesMissing);
+      copyFromWorkBuffer(h, outputBuffer + h->frameBytesPending, dataIndex, h->frameBytesMissing);
       *pOutputBufferLength = h->frameBytesPending + h->frameBytesMissing;
       *pPcmOffset = h->pcmOffsetPending;
       resetPendingState(h);
+      h->stats.numAus++;
+      h->stats.numSplitAus++;
+      IEC61937_TRACE(h, IEC61937_TRACE_DEC_AU_EMITTED, *pOutputBufferLength, *pPcmOffset);
       return IECDEC_OK;
     }
   }
@@ -484,7 +696,7 @@ IECDEC_RESULT iec61937_decode_process(HANDLE_IEC61937_DECODER h, uint8_t* output
   if (h->payloadHeaderIndex < h->numPayloadHeaders) {
     uint32_t headerIndex = h->syncCandidateIndex + IEC_HEADER_SIZE_BYTES +
                            h->payloadHeaderIndex * h->payloadHeaderSize;
-    uint8_t* headerPointer = &h->workBuffer[headerIndex];
+    const uint8_t* headerPointer = getWorkBufferData(h, headerIndex);
     uint32_t dataOffset = 0;
     uint32_t dataLength = 0;
     int32_t pcmOffset = 0;
@@ -494,6 +706,7 @@ IECDEC_RESULT iec61937_decode_process(HANDLE_IEC61937_DECODER h, uint8_t* output
 
     // check if there is enough space in the output buffer
     if (dataLength > outputBufferLength) {
+      IEC61937_TRACE(h, IEC61937_TRACE_DEC_BUFFER_ERROR, dataLength, outputBufferLength);
       return IECDEC_BUFFER_ERROR;
     }
 
@@ -506,14 +719,16 @@ IECDEC_RESULT iec61937_decode_process(HANDLE_IEC61937_DECODER h, uint8_t* output
       h->frameBytesMissing = numAuBytesMissing;
 
       // Write partial data to pending buffer.
-      memcpy(h->frameBufferPending, h->workBuffer + h->syncCandidateIndex + dataOffset,
-             h->frameBytesPending);
+      copyFromWorkBuffer(h, h->frameBufferPending, h->syncCandidateIndex + dataOffset,
+                         h->frameBytesPending);
       h->pcmOffsetPending = pcmOffset - (int32_t)h->frameLength;
     } else {
       // Store length and PCM offset of complete AU to be written.
       *pOutputBufferLength = dataLength;
       *pPcmOffset = pcmOffset;
-      memcpy(outputBuffer, h->workBuffer + h->syncCandidateIndex + dataOffset, dataLength);
+      copyFromWorkBuffer(h, outputBuffer, h->syncCandidateIndex + dataOffset, dataLength);
+      h->stats.numAus++;
+      IEC61937_TRACE(h, IEC61937_TRACE_DEC_AU_EMITTED, dataLength, pcmOffset);
     }
 
     h->payloadHeaderIndex++;
@@ -522,9 +737,9 @@ IECDEC_RESULT iec61937_decode_process(HANDLE_IEC61937_DECODER h, uint8_t* output
   if (h->payloadHeaderIndex == h->numPayloadHeaders) {
     // the complete IEC frame has been processed
     // remove the found frame
-    memmove(h->workBuffer, h->workBuffer + h->syncCandidateIndex + h->burstRepetitionPeriod,
-            h->workBufferBytesAvailable - h->burstRepetitionPeriod);
-    h->workBufferBytesAvailable -= h->burstRepetitionPeriod;
+    removeWorkBufferBytes(h, h->syncCandidateIndex + h->burstRepetitionPeriod);
+    h->stats.bytesConsumed += h->burstRepetitionPeriod;
+    h->stats.numIecFrames++;
 
     // signal that the complete frame was processed
     *pIecFrameProcessed = true;
@@ -537,3 +752,31 @@ IECDEC_RESULT iec61937_decode_process(HANDLE_IEC61937_DECODER h, uint8_t* output
   }
   return IECDEC_OK;
 }
+
+IECDEC_RESULT iec61937_decode_set_realtime(HANDLE_IEC61937_DECODER h, uint32_t maxBytesPerCall) {
+  if (h == NULL) {
+    return IECDEC_NULLPTR_ERROR;
+  }
+  h->maxBytesPerCall = maxBytesPerCall;
+  return IECDEC_OK;
+}
+
+IECDEC_RESULT iec61937_decode_get_stats(HANDLE_IEC61937_DECODER h, IEC61937_DEC_STATS* stats) {
+  if (h == NULL || stats == NULL) {
+    return IECDEC_NULLPTR_ERROR;
+  }
+  *stats = h->stats;
+  return IECDEC_OK;
+}
+
+#if defined(IEC61937_ENABLE_TRACING)
+IECDEC_RESULT iec61937_decode_set_trace(HANDLE_IEC61937_DECODER h,
+                                        IEC61937_TRACE_CALLBACK callback, void* userData) {
+  if (h == NULL) {
+    return IECDEC_NULLPTR_ERROR;
+  }
+  h->traceCallback = callback;
+  h->traceUserData = userData;
+  return IECDEC_OK;
+}
+#endif
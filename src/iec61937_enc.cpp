@@ -82,100 +82,595 @@ amm-info@iis.fraunhofer.de
 
 #include "iec61937_enc.h"
 #include "iec61937_common.h"
+#include "iec61937_core.h"
+#include "iec61937_pcm.h"
 
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define MAX_NUM_MPEGH_FRAMES 5
+#include <thread>
+#include <vector>
+
+// Maximum number of stored MPEG-H frames, sufficient for the longest IEC frame length
+#define MAX_NUM_MPEGH_FRAMES 16
+// Default number of stored MPEG-H frames if not derived from a longer IEC frame length
+#define DEFAULT_NUM_MPEGH_FRAMES 4
 // Buffer size in bytes to hold one MPEG-H frame (sequence of MHAS packages) + overhead
 // for MPEG-H Level 4
 #define MAX_MPEGH_FRAME_SIZE 65536
 #define MAX_MPEGH_FRAME_DURATION 4096
-#define WORKBUFFER_SIZE_BYTES (MAX_MPEGH_FRAME_SIZE) * (MAX_NUM_MPEGH_FRAMES)
+// Alignment of the encoder instance memory
+#define ENCODER_MEMORY_ALIGNMENT 64
+// Maximum MPEG-H frame size which can be signaled in a 6 byte payload header (audio mode 0)
+#define MAX_MPEGH_FRAME_SIZE_AUDIOMODE_0 0xFFFF
+// Minimum IEC frame data in bytes written by one thread of iec61937_encode_process_parallel();
+// starting and joining a thread costs about as much as writing this amount
+#define PARALLEL_MIN_BYTES_PER_THREAD (1024 * 1024)
+
+// Writer of one IEC frame without its padding specialized for audio mode, rate factor and frame
+// length; returns the number of bytes written
+typedef uint32_t (*IEC_FRAME_WRITER)(uint8_t* outputBuffer,
+                                     const iec61937::SIecFramePayload& payload,
+                                     int32_t* pPcmOffset);
+
+// IEC frame recorded by the planning pass of iec61937_encode_process_parallel()
+struct SIecFramePlan {
+  uint8_t* outputBuffer;
+  int32_t pcmOffset; /* PCM offset of the first new MPEG-H frame */
+  iec61937::SIecFramePayload payload;
+  const uint8_t* frameData[MAX_NUM_MPEGH_FRAMES];
+  uint32_t frameLength[MAX_NUM_MPEGH_FRAMES];
+  uint32_t frameDuration[MAX_NUM_MPEGH_FRAMES];
+  uint32_t numFramesToRelease;
+  const uint8_t* frameToRelease[MAX_NUM_MPEGH_FRAMES]; /* borrowed frames completely written */
+};
 
 struct iec61937_encoder_state {
   uint8_t rateFactor;
   uint8_t audioMode;
+  uint8_t frameLengthCode;
   uint32_t burstRepetitionPeriod;
   uint8_t payloadHeaderSize;
   int32_t audioFrameLength;
+  IEC_FRAME_WRITER frameWriter;
+
+  // IEC frames are written as 16-bit big-endian words, of which only the part before the padding
+  // is converted to the output format
+  IEC61937_PCM_FORMAT outputFormat;
+  uint32_t outputFrameSize;
 
   int32_t pcmOffset;
   int32_t overallDuration;
 
-  uint8_t workBuffer[WORKBUFFER_SIZE_BYTES];
+  // Instance memory was allocated by iec61937_encode_open_config()
+  bool ownsMemory;
+
+  // Circular work buffer for copied MPEG-H frames; not available for borrowing instances. Each
+  // frame is stored contiguously and is not moved until it has been written.
+  uint8_t* workBuffer;
+  uint32_t workBufferSize;
+  uint32_t maxStoredBytes;
+  uint32_t maxAuSize;
   uint8_t* pWorkBufferWrite;
-  uint8_t* pWorkBufferRead;
 
+  // Borrowed MPEG-H frames are handed back via the release callback once written
+  bool borrowFrames;
+  IEC61937_ENC_RELEASE_CALLBACK releaseCallback;
+  void* releaseUserData;
+
+  // Emission mode; with a latency limit only MPEG-H frames which the worst-case latency maxLatency
+  // was derived for are accepted
+  bool lowLatency;
+  uint32_t maxLatency;
+  uint32_t latencyLimit;
+  uint32_t maxLatencyAuDuration;
+  uint32_t maxLatencyAuSize;
+
+  // Packing policy
+  IECENC_PACKING packing;
+
+  IEC61937_ENC_STATS stats;
+
+#if defined(IEC61937_ENABLE_TRACING)
+  IEC61937_TRACE_CALLBACK traceCallback;
+  void* traceUserData;
+#endif
+
+  // Planning pass: IEC frames are recorded instead of written; MPEG-H frames are not copied
+  SIecFramePlan* framePlan;
+  uint32_t numFramesPlanned;
+
+  uint32_t maxFramesStored;
   uint32_t framesStoredCount;
+  const uint8_t* frameBuffer[MAX_NUM_MPEGH_FRAMES]; /* borrowed MPEG-H frame to be released */
+  const uint8_t* frameData[MAX_NUM_MPEGH_FRAMES];   /* first byte not yet written */
   uint32_t frameLength[MAX_NUM_MPEGH_FRAMES];
   uint32_t frameDuration[MAX_NUM_MPEGH_FRAMES];
+  uint64_t frameStoreIndex[MAX_NUM_MPEGH_FRAMES]; /* number of IEC frames written before storing */
   bool auPending;
 } iec61937_encoder_state;
 
 static void resetBufferState(HANDLE_IEC61937_ENCODER h) {
-  h->pWorkBufferRead = h->workBuffer;
   h->pWorkBufferWrite = h->workBuffer;
 
   h->framesStoredCount = 0;
   for (uint32_t i = 0; i < MAX_NUM_MPEGH_FRAMES; i++) {
+    h->frameBuffer[i] = NULL;
+    h->frameData[i] = NULL;
     h->frameLength[i] = 0;
     h->frameDuration[i] = 0;
+    h->frameStoreIndex[i] = 0;
   }
   h->auPending = false;
 }
 
-HANDLE_IEC61937_ENCODER iec61937_encode_open(uint8_t rateFactor) {
+static void releaseFrames(HANDLE_IEC61937_ENCODER h, uint32_t numFrames) {
+  if (!h->borrowFrames || h->releaseCallback == NULL) {
+    return;
+  }
+  for (uint32_t i = 0; i < numFrames; i++) {
+    h->releaseCallback(h->releaseUserData, h->frameBuffer[i]);
+  }
+}
+
+// Returns the frame length code according to IEC 61937-13 or -1 for unsupported frame lengths.
+static int32_t getFrameLengthCode(uint32_t audioFrameLength) {
+  switch (audioFrameLength) {
+    case 1024:
+      return 0;
+    case 2048:
+      return 1;
+    case 4096:
+      return 2;
+    case 768:
+      return 3;
+    case 1536:
+      return 4;
+    case 3072:
+      return 5;
+    default:
+      return -1;
+  }
+}
+
+// Returns the rate factor code according to IEC 61937-13 or -1 for unsupported rate factors.
+// Rate factor 1 denotes audio mode 0 which does not use the rate factor.
+static int32_t getRateFactorCode(uint8_t rateFactor) {
+  switch (rateFactor) {
+    case 1:
+      return 0;
+    case 2:
+      return 0;
+    case 4:
+      return 1;
+    case 8:
+      return 2;
+    case 16:
+      return 3;
+    default:
+      return -1;
+  }
+}
+
+template <uint8_t AudioMode, uint8_t RateFactorCode, uint8_t FrameLengthCode>
+static uint32_t writeIecFrameFixed(uint8_t* outputBuffer, const iec61937::SIecFramePayload& payload,
+                                   int32_t* pPcmOffset) {
+  iec61937::CIecFrameTraits<AudioMode, RateFactorCode, FrameLengthCode> traits;
+  return iec61937::writeIecFrameData(traits, outputBuffer, payload, pPcmOffset);
+}
+
+template <uint8_t AudioMode, uint8_t RateFactorCode>
+static IEC_FRAME_WRITER getFrameWriter(uint8_t frameLengthCode) {
+  switch (frameLengthCode) {
+    case 0:
+      return writeIecFrameFixed<AudioMode, RateFactorCode, 0>;
+    case 1:
+      return writeIecFrameFixed<AudioMode, RateFactorCode, 1>;
+    case 2:
+      return writeIecFrameFixed<AudioMode, RateFactorCode, 2>;
+    case 3:
+      return writeIecFrameFixed<AudioMode, RateFactorCode, 3>;
+    case 4:
+      return writeIecFrameFixed<AudioMode, RateFactorCode, 4>;
+    case 5:
+      return writeIecFrameFixed<AudioMode, RateFactorCode, 5>;
+    default:
+      return NULL;
+  }
+}
+
+// Selects the IEC frame writer for a validated configuration once at open.
+static IEC_FRAME_WRITER getFrameWriter(uint8_t audioMode, uint8_t rateFactorCode,
+                                       uint8_t frameLengthCode) {
+  if (audioMode == 0) {
+    return getFrameWriter<0, 0>(frameLengthCode);
+  }
+  switch (rateFactorCode) {
+    case 0:
+      return getFrameWriter<1, 0>(frameLengthCode);
+    case 1:
+      return getFrameWriter<1, 1>(frameLengthCode);
+    case 2:
+      return getFrameWriter<1, 2>(frameLengthCode);
+    case 3:
+      return getFrameWriter<1, 3>(frameLengthCode);
+    default:
+      return NULL;
+  }
+}
+
+// Checks if MPEG-H frames of the given size and duration fit into IEC frames of the given size.
+static bool checkPeakBitrate(uint32_t burstRepetitionPeriod, uint32_t payloadHeaderSize,
+                             uint32_t audioFrameLength, uint32_t maxAuSize, uint32_t auDuration) {
+  // number of MPEG-H frames starting within one IEC frame plus a split one and the terminator
+  uint64_t numPayloadHeaders = (audioFrameLength + auDuration - 1) / auDuration + 2;
+  uint64_t payloadBytes = ((uint64_t)maxAuSize * audioFrameLength + auDuration - 1) / auDuration;
+  uint64_t requiredBytes = IEC_HEADER_SIZE_BYTES + IEC_BURST_SPACING_SIZE_BYTES +
+                           numPayloadHeaders * payloadHeaderSize + payloadBytes;
+  return requiredBytes <= burstRepetitionPeriod;
+}
+
+uint8_t iec61937_encode_get_min_rate_factor(uint32_t audioFrameLength, uint32_t maxAuSize,
+                                            uint32_t auDuration) {
+  if (getFrameLengthCode(audioFrameLength) < 0 || maxAuSize == 0 || auDuration == 0 ||
+      auDuration > MAX_MPEGH_FRAME_DURATION) {
+    return 0;
+  }
+  for (uint8_t rateFactor = 1; rateFactor <= IEC61937_MAX_SAMPLERATE_FACTOR; rateFactor *= 2) {
+    uint8_t audioMode = (rateFactor == 1) ? 0 : 1;
+    uint32_t payloadHeaderSize = (audioMode == 0) ? 6 : 8;
+    if (audioMode == 0 && maxAuSize > MAX_MPEGH_FRAME_SIZE_AUDIOMODE_0) {
+      continue;
+    }
+    uint32_t burstRepetitionPeriod = iec61937::getBurstRepetitionPeriod(
+        audioMode, (uint8_t)getRateFactorCode(rateFactor), audioFrameLength);
+    if (checkPeakBitrate(burstRepetitionPeriod, payloadHeaderSize, audioFrameLength, maxAuSize,
+                         auDuration)) {
+      return rateFactor;
+    }
+  }
+  return 0;
+}
+
+// Returns the payload space of an IEC frame which continues a split MPEG-H frame.
+static uint32_t getTailCapacity(uint32_t burstRepetitionPeriod, uint32_t payloadHeaderSize) {
+  return burstRepetitionPeriod - IEC_HEADER_SIZE_BYTES - IEC_BURST_SPACING_SIZE_BYTES -
+         payloadHeaderSize;
+}
+
+// Worst-case latency in audio samples from passing an MPEG-H frame to the encoder until the IEC
+// frame completing it has been transmitted:
+// - with a constant frame duration d an IEC frame is complete after ceil(L / d) MPEG-H frames, so
+//   the first one waits d * (ceil(L / d) - 1)
+// - an MPEG-H frame longer than the IEC frame completes several IEC frames; without low latency
+//   mode all but the first one are only written when the next MPEG-H frame is passed in
+// - the tail of a split frame needs ceil(maxTailSize / tail capacity) further IEC frames, where
+//   maxTailSize is maxAuSize or one tail capacity if maxAuSize is 0
+// - lookahead packing signals all frames one IEC frame length ahead
+static uint32_t getMaxLatency(uint32_t audioFrameLength, uint32_t auDuration, uint32_t maxTailSize,
+                              uint32_t tailCapacity, IECENC_PACKING packing, bool lowLatency) {
+  if (auDuration == 0) {
+    auDuration = 1;
+  }
+  uint32_t numFramesPerIecFrame = (audioFrameLength + auDuration - 1) / auDuration;
+  uint32_t latency = auDuration * (numFramesPerIecFrame - 1);
+  if (!lowLatency) {
+    latency += audioFrameLength * ((auDuration + audioFrameLength - 1) / audioFrameLength - 1);
+  }
+  uint32_t numTailFrames = (maxTailSize + tailCapacity - 1) / tailCapacity;
+  latency += audioFrameLength * (1 + numTailFrames);
+  if (packing == IECENC_PACKING_LOOKAHEAD) {
+    latency += audioFrameLength;
+  }
+  return latency;
+}
+
+// Returns the PCM offset of the first MPEG-H frame of a time line. With lookahead packing, the PCM
+// offsets start at one IEC frame length so that an MPEG-H frame can be moved to the next IEC frame
+// without getting a negative PCM offset.
+static int32_t getTimelineStart(HANDLE_IEC61937_ENCODER h) {
+  return (h->packing == IECENC_PACKING_LOOKAHEAD) ? h->audioFrameLength : 0;
+}
+
+static void resetTimeline(HANDLE_IEC61937_ENCODER h) {
+  h->pcmOffset = getTimelineStart(h);
+  h->overallDuration = 0;
+}
+
+void iec61937_encode_config_init(IEC61937_ENC_CONFIG* config) {
+  if (config == NULL) {
+    return;
+  }
+  config->rateFactor = IEC61937_MAX_SAMPLERATE_FACTOR;
+  config->audioFrameLength = IEC61937_AUDIOFRAME_LENGTH;
+  config->maxAuSize = 0;
+  config->auDuration = IEC61937_AUDIOFRAME_LENGTH;
+  config->borrowFrames = false;
+  config->releaseCallback = NULL;
+  config->releaseUserData = NULL;
+  config->lowLatency = false;
+  config->maxLatency = 0;
+  config->maxQueuedAus = 0;
+  config->packing = IECENC_PACKING_GREEDY;
+  config->outputFormat = IEC61937_PCM_FORMAT_S16_BE;
+}
+
+// Checks the configuration and determines the rate factor, the frame length code and the number
+// of MPEG-H frames which can be stored. Returns false for an unsupported configuration.
+static bool checkConfig(const IEC61937_ENC_CONFIG* config, uint8_t* pRateFactor,
+                        uint8_t* pFrameLengthCode, uint32_t* pMaxFramesStored) {
+  if (config == NULL) {
+    return false;
+  }
+
+  // check the frame length
+  int32_t frameLengthCode = getFrameLengthCode(config->audioFrameLength);
+  if (frameLengthCode < 0) {
+    return false;
+  }
+
+  // check the packing policy
+  if (config->packing != IECENC_PACKING_GREEDY && config->packing != IECENC_PACKING_LOOKAHEAD) {
+    return false;
+  }
+
+  // check the output format
+  if (iec61937::getPcmContainerSize(config->outputFormat) == 0) {
+    return false;
+  }
+
+  // select the rate factor
+  uint8_t rateFactor = config->rateFactor;
+  if (rateFactor == 0) {
+    rateFactor = iec61937_encode_get_min_rate_factor(config->audioFrameLength, config->maxAuSize,
+                                                     config->auDuration);
+  }
+  if (getRateFactorCode(rateFactor) < 0) {
+    return false;
+  }
+
+  // check the latency bound
+  uint8_t audioMode = (rateFactor == 1) ? 0 : 1;
+  uint32_t tailCapacity = getTailCapacity(
+      iec61937::getBurstRepetitionPeriod(audioMode, (uint8_t)getRateFactorCode(rateFactor),
+                                         config->audioFrameLength),
+      (audioMode == 0) ? 6 : 8);
+  uint32_t maxTailSize = (config->maxAuSize > 0) ? config->maxAuSize : tailCapacity;
+  uint32_t maxLatency = getMaxLatency(config->audioFrameLength, config->auDuration, maxTailSize,
+                                      tailCapacity, config->packing, config->lowLatency);
+  if (config->maxLatency > 0 && maxLatency > config->maxLatency) {
+    return false;
+  }
+
+  // determine the number of MPEG-H frames to be stored: all frames of one IEC frame plus a split
+  // one and the frame completing the IEC frame duration
+  uint32_t maxFramesStored = config->maxQueuedAus;
+  if (maxFramesStored == 0) {
+    maxFramesStored = DEFAULT_NUM_MPEGH_FRAMES;
+    if (config->auDuration > 0) {
+      uint32_t numFramesPerIecFrame =
+          (config->audioFrameLength + config->auDuration - 1) / config->auDuration;
+      if (numFramesPerIecFrame + 2 > maxFramesStored) {
+        maxFramesStored = numFramesPerIecFrame + 2;
+      }
+    }
+  }
+  if (maxFramesStored > MAX_NUM_MPEGH_FRAMES) {
+    return false;
+  }
+
+  *pRateFactor = rateFactor;
+  *pFrameLengthCode = (uint8_t)frameLengthCode;
+  *pMaxFramesStored = maxFramesStored;
+  return true;
+}
+
+static uint32_t getStateSize(void) {
+  uint32_t stateSize = sizeof(iec61937_encoder_state);
+  return (stateSize + ENCODER_MEMORY_ALIGNMENT - 1) & ~(uint32_t)(ENCODER_MEMORY_ALIGNMENT - 1);
+}
+
+static uint32_t getWorkBufferAuSize(const IEC61937_ENC_CONFIG* config) {
+  uint32_t maxAuSize = (config->maxAuSize > 0) ? config->maxAuSize : MAX_MPEGH_FRAME_SIZE;
+  return (maxAuSize < MAX_MPEGH_FRAME_SIZE) ? maxAuSize : MAX_MPEGH_FRAME_SIZE;
+}
+
+static uint32_t getWorkBufferSize(const IEC61937_ENC_CONFIG* config, uint32_t maxFramesStored) {
+  // the work buffer is only needed if the MPEG-H frames are copied
+  if (config->borrowFrames) {
+    return 0;
+  }
+  // besides the stored frames, the circular work buffer holds the unused space at its end left by
+  // a frame which did not fit there; it is smaller than one frame
+  return getWorkBufferAuSize(config) * (maxFramesStored + 1);
+}
+
+uint32_t iec61937_encode_get_memory_size(const IEC61937_ENC_CONFIG* config) {
+  uint8_t rateFactor = 0;
+  uint8_t frameLengthCode = 0;
+  uint32_t maxFramesStored = 0;
+  if (!checkConfig(config, &rateFactor, &frameLengthCode, &maxFramesStored)) {
+    return 0;
+  }
+  return getStateSize() + getWorkBufferSize(config, maxFramesStored);
+}
+
+HANDLE_IEC61937_ENCODER iec61937_encode_open_in_place(const IEC61937_ENC_CONFIG* config,
+                                                      void* memory, uint32_t memorySize) {
   HANDLE_IEC61937_ENCODER h;
 
-  h = (HANDLE_IEC61937_ENCODER)calloc(1, sizeof(iec61937_encoder_state));
-  if (h == NULL) {
+  uint8_t rateFactor = 0;
+  uint8_t frameLengthCode = 0;
+  uint32_t maxFramesStored = 0;
+  if (!checkConfig(config, &rateFactor, &frameLengthCode, &maxFramesStored)) {
+    return NULL;
+  }
+  // the state holds 64-bit counters, which pointer alignment does not cover on 32-bit targets
+  if (memory == NULL || ((uintptr_t)memory % alignof(max_align_t)) != 0) {
+    return NULL;
+  }
+  uint32_t workBufferSize = getWorkBufferSize(config, maxFramesStored);
+  if (memorySize < getStateSize() + workBufferSize) {
     return NULL;
   }
 
-  h->pcmOffset = 0;
-  h->overallDuration = 0;
+  // only the state is initialized; the work buffer is left untouched until it is used
+  h = (HANDLE_IEC61937_ENCODER)memory;
+  memset(h, 0, sizeof(iec61937_encoder_state));
+  h->ownsMemory = false;
+  h->workBuffer = (workBufferSize > 0) ? (uint8_t*)memory + getStateSize() : NULL;
+  h->workBufferSize = workBufferSize;
+  h->maxAuSize = getWorkBufferAuSize(config);
+  h->maxStoredBytes = h->maxAuSize * maxFramesStored;
+  h->borrowFrames = config->borrowFrames;
+  h->releaseCallback = config->releaseCallback;
+  h->releaseUserData = config->releaseUserData;
+  h->lowLatency = config->lowLatency;
+  h->packing = config->packing;
+  h->maxFramesStored = maxFramesStored;
 
   resetBufferState(h);
 
   // set rate factor and corresponding audio mode
   // 0 = MPEG-H 3D Audio
   // 1 = MPEG-H 3D Audio HBR
-  switch (rateFactor) {
-    case 4:
-      h->audioMode = 1;
-      h->rateFactor = 1;
-      break;
-    case 16:
-      h->audioMode = 1;
-      h->rateFactor = 3;
-      break;
-    default:
-      free(h);
-      return NULL;
-  }
+  h->audioMode = (rateFactor == 1) ? 0 : 1;
+  h->rateFactor = (uint8_t)getRateFactorCode(rateFactor);
+  h->frameLengthCode = frameLengthCode;
 
   // determine the size of a payload header
   h->payloadHeaderSize = (h->audioMode == 0) ? 6 : 8;
 
   // determine the burst repetition period
-  h->audioFrameLength = IEC61937_AUDIOFRAME_LENGTH;
-  h->burstRepetitionPeriod = h->audioFrameLength * IEC60958_FRAME_SIZE_BYTES;
-  if (h->audioMode == 1) {
-    h->burstRepetitionPeriod = h->burstRepetitionPeriod << (h->rateFactor + 1);
-  }
+  h->audioFrameLength = config->audioFrameLength;
+  h->burstRepetitionPeriod =
+      iec61937::getBurstRepetitionPeriod(h->audioMode, h->rateFactor, h->audioFrameLength);
+  h->frameWriter = getFrameWriter(h->audioMode, h->rateFactor, h->frameLengthCode);
+  h->outputFormat = config->outputFormat;
+  h->outputFrameSize =
+      h->burstRepetitionPeriod / 2 * iec61937::getPcmContainerSize(h->outputFormat);
+
+  uint32_t tailCapacity = getTailCapacity(h->burstRepetitionPeriod, h->payloadHeaderSize);
+  h->maxLatencyAuSize = (config->maxAuSize > 0) ? config->maxAuSize : tailCapacity;
+  h->maxLatencyAuDuration = config->auDuration;
+  h->maxLatency = getMaxLatency(h->audioFrameLength, config->auDuration, h->maxLatencyAuSize,
+                                tailCapacity, h->packing, h->lowLatency);
+  h->latencyLimit = config->maxLatency;
+
+  resetTimeline(h);
+
+  return h;
+}
 
+HANDLE_IEC61937_ENCODER iec61937_encode_open_config(const IEC61937_ENC_CONFIG* config) {
+  uint32_t memorySize = iec61937_encode_get_memory_size(config);
+  if (memorySize == 0) {
+    return NULL;
+  }
+  void* memory = malloc(memorySize);
+  if (memory == NULL) {
+    return NULL;
+  }
+  HANDLE_IEC61937_ENCODER h = iec61937_encode_open_in_place(config, memory, memorySize);
+  if (h == NULL) {
+    free(memory);
+    return NULL;
+  }
+  h->ownsMemory = true;
   return h;
 }
 
+IECENC_RESULT iec61937_encode_reset(HANDLE_IEC61937_ENCODER h) {
+  if (h == NULL) {
+    return IECENC_NULLPTR_ERROR;
+  }
+  // hand back all MPEG-H frames which are still queued
+  releaseFrames(h, h->framesStoredCount);
+  resetTimeline(h);
+  resetBufferState(h);
+  memset(&h->stats, 0, sizeof(IEC61937_ENC_STATS));
+  return IECENC_OK;
+}
+
+HANDLE_IEC61937_ENCODER iec61937_encode_open(uint8_t rateFactor) {
+  IEC61937_ENC_CONFIG config;
+  if (rateFactor == 0) {
+    return NULL;
+  }
+  iec61937_encode_config_init(&config);
+  config.rateFactor = rateFactor;
+  return iec61937_encode_open_config(&config);
+}
+
+HANDLE_IEC61937_ENCODER iec61937_encode_open_borrowed(uint8_t rateFactor,
+                                                      IEC61937_ENC_RELEASE_CALLBACK releaseCallback,
+                                                      void* userData) {
+  IEC61937_ENC_CONFIG config;
+  if (rateFactor == 0) {
+    return NULL;
+  }
+  iec61937_encode_config_init(&config);
+  config.rateFactor = rateFactor;
+  config.borrowFrames = true;
+  config.releaseCallback = releaseCallback;
+  config.releaseUserData = userData;
+  return iec61937_encode_open_config(&config);
+}
+
+uint32_t iec61937_encode_get_max_latency(HANDLE_IEC61937_ENCODER h) {
+  if (h == NULL) {
+    return 0;
+  }
+  return h->maxLatency;
+}
+
+IECENC_RESULT iec61937_encode_get_stats(HANDLE_IEC61937_ENCODER h, IEC61937_ENC_STATS* stats) {
+  if (h == NULL || stats == NULL) {
+    return IECENC_NULLPTR_ERROR;
+  }
+  *stats = h->stats;
+  stats->maxFramesStored = h->maxFramesStored;
+  stats->workBufferSize = h->borrowFrames ? 0 : h->workBufferSize;
+  return IECENC_OK;
+}
+
+#if defined(IEC61937_ENABLE_TRACING)
+IECENC_RESULT iec61937_encode_set_trace(HANDLE_IEC61937_ENCODER h,
+                                        IEC61937_TRACE_CALLBACK callback, void* userData) {
+  if (h == NULL) {
+    return IECENC_NULLPTR_ERROR;
+  }
+  h->traceCallback = callback;
+  h->traceUserData = userData;
+  return IECENC_OK;
+}
+#endif
+
+uint32_t iec61937_encode_get_frame_size(HANDLE_IEC61937_ENCODER h) {
+  if (h == NULL) {
+    return 0;
+  }
+  return h->outputFrameSize;
+}
+
 void iec61937_encode_close(HANDLE_IEC61937_ENCODER h) {
   if (h == NULL) {
     return;
   }
-  free(h);
+  // hand back all MPEG-H frames which are still queued
+  releaseFrames(h, h->framesStoredCount);
+  if (h->ownsMemory) {
+    free(h);
+  }
 }
 
-static uint32_t getNumBuffersToWrite(HANDLE_IEC61937_ENCODER h) {
+// Determines how many stored frames are written to the next IEC frame. Frames are added as long as
+// there is payload space left and their start lies within maxDuration. pPayloadComplete (optional)
+// signals that the payload space is exhausted, i.e. further input does not change the IEC frame.
+// pAuDeferred (optional) signals that lookahead packing moved the last frame to the next IEC frame.
+static uint32_t getNumBuffersToWrite(HANDLE_IEC61937_ENCODER h, int32_t maxDuration,
+                                     bool* pPayloadComplete, bool* pAuDeferred) {
   uint32_t i = 0;
   uint32_t availableBytes = h->burstRepetitionPeriod;
   availableBytes -= (IEC_HEADER_SIZE_BYTES + IEC_BURST_SPACING_SIZE_BYTES);
@@ -185,103 +680,278 @@ static uint32_t getNumBuffersToWrite(HANDLE_IEC61937_ENCODER h) {
 
   int32_t duration = 0;
   uint32_t writeLength = 0;
-  while ((writeLength < availableBytes) && (duration <= h->overallDuration) &&
+  while ((writeLength < availableBytes) && (duration <= maxDuration) &&
          (i != h->framesStoredCount)) {
     writeLength += h->frameLength[i] + h->payloadHeaderSize;
     duration += h->frameDuration[i];
     i++;
   }
+  if (pPayloadComplete != NULL) {
+    *pPayloadComplete = (writeLength >= availableBytes);
+  }
+
+  // Lookahead packing: instead of splitting the last frame, it is moved to the next IEC frame if
+  // it fits there completely and it does not start before the next IEC frame (PCM offset >= 0).
+  // A split of the first frame cannot be avoided.
+  bool auDeferred = false;
+  if (h->packing == IECENC_PACKING_LOOKAHEAD && writeLength > availableBytes && i > 1) {
+    uint32_t last = i - 1;
+    int32_t nextPcmOffset =
+        h->pcmOffset + duration - (int32_t)h->frameDuration[last] - h->audioFrameLength;
+    uint32_t nextAvailableBytes = h->burstRepetitionPeriod -
+                                  (IEC_HEADER_SIZE_BYTES + IEC_BURST_SPACING_SIZE_BYTES) -
+                                  2 * h->payloadHeaderSize;
+    if (nextPcmOffset >= 0 && h->frameLength[last] <= nextAvailableBytes) {
+      auDeferred = true;
+      i--;
+    }
+  }
+  if (pAuDeferred != NULL) {
+    *pAuDeferred = auDeferred;
+  }
   return i;
 }
 
-// IEC frame writer. Introduces headers, trailers and includes the payload data.
-static uint32_t writeIecFrame(HANDLE_IEC61937_ENCODER h, uint8_t* outputBuffer,
-                              uint32_t payloadLength, uint32_t numAvailableBytes,
-                              uint32_t numBuffersToWrite) {
-  // write frame header
-  *outputBuffer++ = SYNC_PREAMBLE_0;             // Pa
-  *outputBuffer++ = SYNC_PREAMBLE_1;             // Pa
-  *outputBuffer++ = SYNC_PREAMBLE_2;             // Pb
-  *outputBuffer++ = SYNC_PREAMBLE_3;             // Pb
-  *outputBuffer++ = (h->rateFactor << 3);        // bits 11 - 12 of Pc
-  *outputBuffer++ = (h->audioMode << 5) | (25);  // bits  5 -  6 of Pc
+// Returns true if the content of the next IEC frame is known: the stored frames reach beyond the
+// end of the IEC frame or, in low latency mode, its payload space is exhausted.
+static bool isIecFrameReady(HANDLE_IEC61937_ENCODER h, uint32_t numBuffersToWrite,
+                            bool payloadComplete) {
+  return (h->overallDuration >= h->audioFrameLength) ||
+         (h->lowLatency && payloadComplete && numBuffersToWrite > 0);
+}
 
-  uint32_t numPayloadHeaders = numBuffersToWrite;
-  if (h->auPending) {
-    numPayloadHeaders--;
+// Returns false if an MPEG-H frame exceeds the duration or size which the worst-case latency was
+// derived for, i.e. storing it could exceed the latency limit.
+static bool checkLatencyLimit(HANDLE_IEC61937_ENCODER h, uint32_t length, uint32_t duration) {
+  if (h->latencyLimit == 0) {
+    return true;
   }
+  return (duration == 0 || duration == h->maxLatencyAuDuration) && length <= h->maxLatencyAuSize;
+}
 
-  uint32_t dataBurstLengthBytes =
-      numAvailableBytes + (numPayloadHeaders + 1) * h->payloadHeaderSize;
-  uint32_t payloadDataLength = numAvailableBytes;
-  if (payloadLength < numAvailableBytes) {
-    dataBurstLengthBytes = payloadLength + (numPayloadHeaders + 1) * h->payloadHeaderSize;
-    payloadDataLength = payloadLength;
+// Returns the number of bytes of all stored frames which have not been written yet.
+static uint32_t getStoredBytes(HANDLE_IEC61937_ENCODER h) {
+  uint32_t storedBytes = 0;
+  for (uint32_t i = 0; i < h->framesStoredCount; i++) {
+    storedBytes += h->frameLength[i];
   }
+  return storedBytes;
+}
 
-  uint32_t dataBurstLength = dataBurstLengthBytes;
-  if (h->audioMode == 1) {
-    // divided by 8
-    dataBurstLength = (dataBurstLengthBytes + 7) >> 3;
+// Returns the position in the circular work buffer to store a frame of length bytes at, given the
+// first byte still to be written (NULL if no stored frame is in the work buffer): after the last
+// stored frame or, if the frame does not fit before the end of the work buffer, at its beginning.
+// Since the stored frames are limited to maxFramesStored frames of at most maxAuSize bytes each,
+// the work buffer size of maxFramesStored + 1 frames always leaves enough contiguous space.
+static uint8_t* getWritePosition(HANDLE_IEC61937_ENCODER h, const uint8_t* readPosition,
+                                 uint32_t length) {
+  if (readPosition == NULL) {
+    return h->workBuffer;
+  }
+  uint8_t* workBufferEnd = h->workBuffer + h->workBufferSize;
+  if (readPosition < h->pWorkBufferWrite &&
+      (uint32_t)(workBufferEnd - h->pWorkBufferWrite) < length) {
+    // the stored data does not wrap around yet but the frame does not fit before the end
+    return h->workBuffer;
   }
+  return h->pWorkBufferWrite;
+}
 
-  *outputBuffer++ = (uint8_t)(dataBurstLength >> 8);  // Pd
-  *outputBuffer++ = (uint8_t)dataBurstLength;         // Pd
+static IECENC_RESULT storeFrame(HANDLE_IEC61937_ENCODER h, const uint8_t* inputBuffer,
+                                uint32_t inputBufferLength, uint32_t duration) {
+  if (h->framesStoredCount >= h->maxFramesStored) {
+    h->stats.numBufferErrors++;
+    IEC61937_TRACE(h, IEC61937_TRACE_ENC_BUFFER_ERROR, inputBufferLength, h->framesStoredCount);
+    return IECENC_BUFFER_ERROR;
+  }
+  if (h->audioMode == 0 && inputBufferLength > MAX_MPEGH_FRAME_SIZE_AUDIOMODE_0) {
+    return IECENC_BUFFER_ERROR;
+  }
+  uint32_t storedBytes = getStoredBytes(h);
+  if (!h->borrowFrames &&
+      (inputBufferLength > h->maxAuSize || storedBytes + inputBufferLength > h->maxStoredBytes)) {
+    h->stats.numBufferErrors++;
+    IEC61937_TRACE(h, IEC61937_TRACE_ENC_BUFFER_ERROR, inputBufferLength, h->framesStoredCount);
+    return IECENC_BUFFER_ERROR;
+  }
 
-  // write payload headers
-  uint32_t dataOffset = 8;
-  dataOffset += (numPayloadHeaders + 1) * h->payloadHeaderSize;
+  h->overallDuration += duration;
+
+  if (h->borrowFrames) {
+    // keep a reference only; the frame is released after it has been written completely
+    h->frameBuffer[h->framesStoredCount] = inputBuffer;
+    h->frameData[h->framesStoredCount] = inputBuffer;
+  } else if (h->framePlan != NULL) {
+    // the frame is read from the input while filling and copied after the planning pass if needed
+    h->frameData[h->framesStoredCount] = inputBuffer;
+  } else {
+    uint8_t* writePosition = getWritePosition(
+        h, (h->framesStoredCount > 0) ? h->frameData[0] : NULL, inputBufferLength);
+    memcpy(writePosition, inputBuffer, inputBufferLength);
+    h->frameData[h->framesStoredCount] = writePosition;
+    h->pWorkBufferWrite = writePosition + inputBufferLength;
+  }
+  h->frameLength[h->framesStoredCount] = inputBufferLength;
+  h->frameDuration[h->framesStoredCount] = duration;
+  h->frameStoreIndex[h->framesStoredCount] = h->stats.numIecFrames;
+  h->framesStoredCount++;
+
+  // update the queue statistics
+  storedBytes += inputBufferLength;
+  if (h->framesStoredCount > h->stats.peakFramesStored) {
+    h->stats.peakFramesStored = h->framesStoredCount;
+  }
+  if (storedBytes > h->stats.peakStoredBytes) {
+    h->stats.peakStoredBytes = storedBytes;
+  }
+  if (h->framesStoredCount == h->maxFramesStored ||
+      (!h->borrowFrames && storedBytes + inputBufferLength > h->maxStoredBytes)) {
+    h->stats.numNearOverflows++;
+  }
 
-  uint32_t i = 0;
-  if (h->auPending) {
-    dataOffset += h->frameLength[i];
-    i++;
+  return IECENC_OK;
+}
+
+// Completes an IEC frame of which the first numBytes have been written as 16-bit big-endian words:
+// only these are converted to the output format and the zero padding is written in the output
+// format directly. Returns the size of the IEC frame in the output format.
+static uint32_t finishIecFrame(HANDLE_IEC61937_ENCODER h, uint8_t* outputBuffer,
+                               uint32_t numBytes) {
+  if (numBytes % 2 != 0) {
+    // the padding starts within the last word
+    outputBuffer[numBytes++] = 0;
   }
+  uint32_t lengthConverted =
+      iec61937::convertToPcmFormat(h->outputFormat, outputBuffer, numBytes / 2);
+  memset(outputBuffer + lengthConverted, 0, h->outputFrameSize - lengthConverted);
+  return h->outputFrameSize;
+}
 
-  for (uint32_t j = 0; j < numPayloadHeaders; j++) {
-    // write data offset field
-    if (h->audioMode == 1) {
-      *outputBuffer++ = (uint8_t)(dataOffset >> 16);
-    }
-    *outputBuffer++ = (uint8_t)(dataOffset >> 8);
-    *outputBuffer++ = (uint8_t)dataOffset;
-    // write data size field
-    if (h->audioMode == 1) {
-      *outputBuffer++ = (uint8_t)(h->frameLength[i] >> 16);
-    }
-    *outputBuffer++ = (uint8_t)((h->frameLength[i]) >> 8);
-    *outputBuffer++ = (uint8_t)h->frameLength[i];
-    // write PCM offset field
-    *outputBuffer++ = (uint8_t)(h->pcmOffset >> 8);
-    *outputBuffer++ = (uint8_t)(h->pcmOffset);
-
-    h->pcmOffset += h->frameDuration[i];
-    dataOffset += h->frameLength[i];
-    i++;
+// Writes one IEC61937-13 frame containing the first numBuffersToWrite stored frames and removes
+// the written frames from the stored frames; the work buffer data is not moved. auDeferred is the
+// packing decision of getNumBuffersToWrite() and is only used for the statistics.
+static uint32_t encodeIecFrame(HANDLE_IEC61937_ENCODER h, uint8_t* outputBuffer,
+                               uint32_t numBuffersToWrite, bool auDeferred) {
+  // calculate the number of bytes available for the payload data in the IEC frame to be written
+  uint32_t numAvailableBytes = h->burstRepetitionPeriod;
+  numAvailableBytes -= (IEC_HEADER_SIZE_BYTES + IEC_BURST_SPACING_SIZE_BYTES);
+  if (!h->auPending) {
+    numAvailableBytes -= h->payloadHeaderSize;
+  }
+
+  uint32_t payloadDataLength = 0;
+  for (uint32_t i = 0; i < numBuffersToWrite; i++) {
+    payloadDataLength += h->frameLength[i];
+    numAvailableBytes -= h->payloadHeaderSize;
   }
 
-  uint32_t j;
-  // write last payload header with zeroes as list terminator
-  for (j = 0; j < h->payloadHeaderSize; j++) {
-    *outputBuffer++ = 0;
+  // write an IEC61937-13 frame
+  iec61937::SIecFramePayload payload;
+  payload.frameData = h->frameData;
+  payload.frameLength = h->frameLength;
+  payload.frameDuration = h->frameDuration;
+  payload.numBuffersToWrite = numBuffersToWrite;
+  payload.auPending = h->auPending;
+  payload.payloadLength = payloadDataLength;
+  payload.numAvailableBytes = numAvailableBytes;
+  uint32_t lengthWritten = h->outputFrameSize;
+  if (h->framePlan != NULL) {
+    // record the IEC frame; it is written after the planning pass
+    SIecFramePlan* plan = &h->framePlan[h->numFramesPlanned++];
+    plan->outputBuffer = outputBuffer;
+    plan->pcmOffset = h->pcmOffset;
+    plan->numFramesToRelease = 0;
+    for (uint32_t i = 0; i < numBuffersToWrite; i++) {
+      plan->frameData[i] = h->frameData[i];
+      plan->frameLength[i] = h->frameLength[i];
+      plan->frameDuration[i] = h->frameDuration[i];
+      // the duration of a pending split frame is zero
+      h->pcmOffset += h->frameDuration[i];
+    }
+    plan->payload = payload;
+    plan->payload.frameData = plan->frameData;
+    plan->payload.frameLength = plan->frameLength;
+    plan->payload.frameDuration = plan->frameDuration;
+  } else {
+    lengthWritten =
+        finishIecFrame(h, outputBuffer, h->frameWriter(outputBuffer, payload, &h->pcmOffset));
   }
+  h->overallDuration -= h->audioFrameLength;
+  h->pcmOffset -= h->audioFrameLength;
 
-  // write payload data
-  for (j = 0; j < payloadDataLength; j++) {
-    *outputBuffer++ = *h->pWorkBufferRead++;
+  // update the statistics
+  h->stats.numIecFrames++;
+  uint32_t payloadSpace =
+      h->burstRepetitionPeriod - IEC_HEADER_SIZE_BYTES - IEC_BURST_SPACING_SIZE_BYTES;
+  uint32_t paddingLength =
+      (payloadDataLength < numAvailableBytes) ? numAvailableBytes - payloadDataLength : 0;
+  h->stats.payloadBytes += numAvailableBytes - paddingLength;
+  h->stats.paddingBytes += paddingLength;
+  uint32_t utilizationBin = (uint32_t)((uint64_t)(payloadSpace - paddingLength) *
+                                       IEC61937_ENC_NUM_UTILIZATION_BINS / payloadSpace);
+  if (utilizationBin >= IEC61937_ENC_NUM_UTILIZATION_BINS) {
+    utilizationBin = IEC61937_ENC_NUM_UTILIZATION_BINS - 1;
+  }
+  h->stats.payloadUtilization[utilizationBin]++;
+  IEC61937_TRACE(h, IEC61937_TRACE_ENC_BURST_WRITTEN, numAvailableBytes - paddingLength,
+                 numBuffersToWrite);
+  if (h->auPending) {
+    h->stats.splitLatency += h->audioFrameLength;
+  }
+  if (auDeferred) {
+    h->stats.numDeferredAus++;
   }
 
-  // write padding
-  for (j = payloadLength; j < numAvailableBytes; j++) {
-    *outputBuffer++ = 0;
+  // adjust the written data
+  uint32_t buffersToDelete = 0;
+  for (uint32_t i = 0; i < numBuffersToWrite; i++) {
+    if (i == numBuffersToWrite - 1 && payloadDataLength > numAvailableBytes) {
+      uint32_t frameBytesLeft = payloadDataLength - numAvailableBytes;
+      if (i > 0 || !h->auPending) {
+        h->stats.numSplitAus++;
+      }
+      h->auPending = true;
+      h->frameData[i] += h->frameLength[i] - frameBytesLeft;
+      h->frameLength[i] = frameBytesLeft;
+      h->frameDuration[i] = 0;
+    } else {
+      h->auPending = false;
+      h->frameLength[i] = 0;
+      h->frameDuration[i] = 0;
+      h->stats.numAus++;
+      uint64_t latencyBin = h->stats.numIecFrames - 1 - h->frameStoreIndex[i];
+      if (latencyBin >= IEC61937_ENC_NUM_LATENCY_BINS) {
+        latencyBin = IEC61937_ENC_NUM_LATENCY_BINS - 1;
+      }
+      h->stats.auLatency[latencyBin]++;
+      buffersToDelete++;
+    }
   }
 
-  // write burst spacing
-  for (j = 0; j < IEC_BURST_SPACING_SIZE_BYTES; j++) {
-    *outputBuffer++ = 0;
+  // remove/adjust processed frame info
+  if (buffersToDelete > 0) {
+    if (h->framePlan == NULL) {
+      releaseFrames(h, buffersToDelete);
+    } else if (h->borrowFrames) {
+      // the frames are still read while filling
+      SIecFramePlan* plan = &h->framePlan[h->numFramesPlanned - 1];
+      memcpy(plan->frameToRelease, h->frameBuffer, buffersToDelete * sizeof(const uint8_t*));
+      plan->numFramesToRelease = buffersToDelete;
+    }
+    h->framesStoredCount -= buffersToDelete;
+    memmove(&h->frameBuffer[0], &h->frameBuffer[buffersToDelete],
+            h->framesStoredCount * sizeof(const uint8_t*));
+    memmove(&h->frameData[0], &h->frameData[buffersToDelete],
+            h->framesStoredCount * sizeof(const uint8_t*));
+    memmove(&h->frameLength[0], &h->frameLength[buffersToDelete],
+            h->framesStoredCount * sizeof(uint32_t));
+    memmove(&h->frameDuration[0], &h->frameDuration[buffersToDelete],
+            h->framesStoredCount * sizeof(uint32_t));
+    memmove(&h->frameStoreIndex[0], &h->frameStoreIndex[buffersToDelete],
+            h->framesStoredCount * sizeof(uint64_t));
   }
 
-  return h->burstRepetitionPeriod;
+  return lengthWritten;
 }
 
 IECENC_RESULT iec61937_encode_process(HANDLE_IEC61937_ENCODER h, const uint8_t* inputBuffer,
@@ -292,12 +962,13 @@ IECENC_RESULT iec61937_encode_process(HANDLE_IEC61937_ENCODER h, const uint8_t*
       pOutputBufferLength == NULL) {
     return IECENC_NULLPTR_ERROR;
   }
-  if (*pOutputBufferLength < h->burstRepetitionPeriod) {
+  if (*pOutputBufferLength < h->outputFrameSize) {
     return IECENC_BUFFER_ERROR;
   }
   if (duration > MAX_MPEGH_FRAME_DURATION) {
     return IECENC_DURATION_ERROR;
   }
+  uint32_t outputBufferSize = *pOutputBufferLength;
   *pOutputBufferLength = 0;
 
   // Process accumulated data first
@@ -307,101 +978,292 @@ IECENC_RESULT iec61937_encode_process(HANDLE_IEC61937_ENCODER h, const uint8_t*
   }
 
   uint32_t numBuffersToWrite = 0;
-  bool numBuffersToWriteObtained = false;
+  bool auDeferred = false;
 
   // Accumulate new data
   if (inputBufferLength != 0) {
-    if (h->framesStoredCount + 1 >= MAX_NUM_MPEGH_FRAMES) {
-      return IECENC_BUFFER_ERROR;
+    if (!checkLatencyLimit(h, inputBufferLength, duration)) {
+      return IECENC_LATENCY_ERROR;
     }
-    if (h->pWorkBufferWrite + inputBufferLength > h->workBuffer + sizeof(h->workBuffer)) {
-      return IECENC_BUFFER_ERROR;
+    IECENC_RESULT err = storeFrame(h, inputBuffer, inputBufferLength, duration);
+    if (err != IECENC_OK) {
+      return err;
     }
-
     *fInputBufferProcessed = true;
-    h->overallDuration += duration;
-
-    memcpy(h->pWorkBufferWrite, inputBuffer, inputBufferLength);
-    h->pWorkBufferWrite += inputBufferLength;
-    h->frameLength[h->framesStoredCount] = inputBufferLength;
-    h->frameDuration[h->framesStoredCount] = duration;
-    h->framesStoredCount++;
 
     // determine how many stored frames can be written to the IEC frame
-    numBuffersToWrite = getNumBuffersToWrite(h);
-    numBuffersToWriteObtained = true;
+    bool payloadComplete = false;
+    numBuffersToWrite =
+        getNumBuffersToWrite(h, h->overallDuration, &payloadComplete, &auDeferred);
 
-    // check if there is enough data available to be written to the IEC frame
-    if ((h->overallDuration < h->audioFrameLength) || numBuffersToWrite == 0) {
+    // check if the content of the IEC frame is known
+    if (!isIecFrameReady(h, numBuffersToWrite, payloadComplete) || numBuffersToWrite == 0) {
       return IECENC_OK;
     }
+  } else {
+    // determine how many stored frames can be written to the IEC frame
+    numBuffersToWrite = getNumBuffersToWrite(h, h->overallDuration, NULL, &auDeferred);
   }
 
-  if (!numBuffersToWriteObtained) {
-    // determine how many stored frames can be written to the IEC frame
-    numBuffersToWrite = getNumBuffersToWrite(h);
+  // write an IEC61937-13 frame
+  uint32_t lengthWritten = encodeIecFrame(h, outputBuffer, numBuffersToWrite, auDeferred);
+
+  // in low latency mode, the following IEC frames are written right away if their content is
+  // already known (e.g. MPEG-H frames longer than the IEC frame) and the output buffer holds them
+  while (h->lowLatency && outputBufferSize - lengthWritten >= h->outputFrameSize) {
+    bool payloadComplete = false;
+    numBuffersToWrite =
+        getNumBuffersToWrite(h, h->overallDuration, &payloadComplete, &auDeferred);
+    if (!isIecFrameReady(h, numBuffersToWrite, payloadComplete)) {
+      break;
+    }
+    lengthWritten +=
+        encodeIecFrame(h, outputBuffer + lengthWritten, numBuffersToWrite, auDeferred);
+  }
+  *pOutputBufferLength = lengthWritten;
+
+  return IECENC_OK;
+}
+
+IECENC_RESULT iec61937_encode_process_batch(HANDLE_IEC61937_ENCODER h, const IEC61937_ENC_AU* aus,
+                                            uint32_t numAus, uint32_t* pNumAusConsumed,
+                                            uint8_t* outputBuffer, uint32_t outputBufferLength,
+                                            uint32_t* burstOffsets, uint32_t* pNumBursts) {
+  if (h == NULL || (aus == NULL && numAus > 0) || pNumAusConsumed == NULL ||
+      outputBuffer == NULL || pNumBursts == NULL) {
+    return IECENC_NULLPTR_ERROR;
   }
+  if (outputBufferLength < h->outputFrameSize) {
+    return IECENC_BUFFER_ERROR;
+  }
+  uint32_t maxNumBursts = *pNumBursts;
+  uint32_t outputOffset = 0;
+  *pNumAusConsumed = 0;
+  *pNumBursts = 0;
+
+  while (outputBufferLength - outputOffset >= h->outputFrameSize &&
+         (burstOffsets == NULL || *pNumBursts < maxNumBursts)) {
+    bool payloadComplete = false;
+    bool auDeferred = false;
+    uint32_t numBuffersToWrite =
+        getNumBuffersToWrite(h, h->overallDuration, &payloadComplete, &auDeferred);
+    if (isIecFrameReady(h, numBuffersToWrite, payloadComplete)) {
+      // write an IEC61937-13 frame
+      uint32_t lengthWritten =
+          encodeIecFrame(h, outputBuffer + outputOffset, numBuffersToWrite, auDeferred);
+      if (burstOffsets != NULL) {
+        burstOffsets[*pNumBursts] = outputOffset;
+      }
+      (*pNumBursts)++;
+      outputOffset += lengthWritten;
+      continue;
+    }
+    if (*pNumAusConsumed == numAus) {
+      break;
+    }
 
-  // calculate the number of bytes available in the work buffer
-  uint32_t currentWorkbufferBytes = 0;
+    // Accumulate new data
+    const IEC61937_ENC_AU* au = &aus[*pNumAusConsumed];
+    if (au->data == NULL) {
+      return IECENC_NULLPTR_ERROR;
+    }
+    if (au->duration > MAX_MPEGH_FRAME_DURATION) {
+      return IECENC_DURATION_ERROR;
+    }
+    if (au->length != 0) {
+      if (!checkLatencyLimit(h, au->length, au->duration)) {
+        return IECENC_LATENCY_ERROR;
+      }
+      IECENC_RESULT err = storeFrame(h, au->data, au->length, au->duration);
+      if (err != IECENC_OK) {
+        return err;
+      }
+    }
+    (*pNumAusConsumed)++;
+  }
+
+  return IECENC_OK;
+}
+
+// Writes the planned IEC frames [first, last).
+static void fillIecFrames(HANDLE_IEC61937_ENCODER h, SIecFramePlan* plans, uint32_t first,
+                          uint32_t last) {
+  for (uint32_t i = first; i < last; i++) {
+    int32_t pcmOffset = plans[i].pcmOffset;
+    uint32_t lengthWritten = h->frameWriter(plans[i].outputBuffer, plans[i].payload, &pcmOffset);
+    finishIecFrame(h, plans[i].outputBuffer, lengthWritten);
+  }
+}
+
+// Copies the stored frames which are still read from the input into the work buffer like
+// storeFrame() does. Frames stored before the planning pass precede them and stay in place.
+static void copyInputFrames(HANDLE_IEC61937_ENCODER h) {
+  uint8_t* workBufferEnd = h->workBuffer + h->workBufferSize;
+  const uint8_t* readPosition = NULL;
   for (uint32_t i = 0; i < h->framesStoredCount; i++) {
-    currentWorkbufferBytes += h->frameLength[i];
+    if (h->frameData[i] < h->workBuffer || h->frameData[i] >= workBufferEnd) {
+      uint8_t* writePosition = getWritePosition(h, readPosition, h->frameLength[i]);
+      memcpy(writePosition, h->frameData[i], h->frameLength[i]);
+      h->frameData[i] = writePosition;
+      h->pWorkBufferWrite = writePosition + h->frameLength[i];
+    }
+    if (readPosition == NULL) {
+      readPosition = h->frameData[i];
+    }
   }
+}
 
-  // calculate the number of bytes available for the payload data in the IEC frame to be written
-  uint32_t numAvailableBytes = h->burstRepetitionPeriod;
-  numAvailableBytes -= (IEC_HEADER_SIZE_BYTES + IEC_BURST_SPACING_SIZE_BYTES);
-  if (!h->auPending) {
-    numAvailableBytes -= h->payloadHeaderSize;
+IECENC_RESULT iec61937_encode_process_parallel(HANDLE_IEC61937_ENCODER h,
+                                               const IEC61937_ENC_AU* aus, uint32_t numAus,
+                                               uint32_t* pNumAusConsumed, uint8_t* outputBuffer,
+                                               uint32_t outputBufferLength, uint32_t* burstOffsets,
+                                               uint32_t* pNumBursts, uint32_t numThreads) {
+  if (h == NULL || pNumBursts == NULL) {
+    return IECENC_NULLPTR_ERROR;
+  }
+  uint32_t maxNumPlans = outputBufferLength / h->outputFrameSize;
+  if (burstOffsets != NULL && *pNumBursts < maxNumPlans) {
+    maxNumPlans = *pNumBursts;
   }
 
-  uint32_t payloadDataLength = 0;
-  for (uint32_t i = 0; i < numBuffersToWrite; i++) {
-    payloadDataLength += h->frameLength[i];
-    numAvailableBytes -= h->payloadHeaderSize;
+  // estimate the number of IEC frames from the frame durations; calls which cannot give at least
+  // two threads enough IEC frames are encoded sequentially without planning memory and threads
+  if (numThreads == 0) {
+    numThreads = std::thread::hardware_concurrency();
+  }
+  uint32_t minFramesPerThread = PARALLEL_MIN_BYTES_PER_THREAD / h->outputFrameSize;
+  if (minFramesPerThread == 0) {
+    minFramesPerThread = 1;
+  }
+  uint64_t duration = (h->overallDuration > 0) ? (uint64_t)h->overallDuration : 0;
+  for (uint32_t i = 0; i < numAus && aus != NULL; i++) {
+    duration += aus[i].duration;
+  }
+  uint64_t numFramesEstimate = duration / (uint32_t)h->audioFrameLength;
+  if (numFramesEstimate > maxNumPlans) {
+    numFramesEstimate = maxNumPlans;
+  }
+  if (numFramesEstimate / minFramesPerThread < numThreads) {
+    numThreads = (uint32_t)(numFramesEstimate / minFramesPerThread);
+  }
+  if (numThreads <= 1) {
+    return iec61937_encode_process_batch(h, aus, numAus, pNumAusConsumed, outputBuffer,
+                                         outputBufferLength, burstOffsets, pNumBursts);
   }
 
-  // write an IEC61937-13 frame
-  uint32_t lengthWritten =
-      writeIecFrame(h, outputBuffer, payloadDataLength, numAvailableBytes, numBuffersToWrite);
-  *pOutputBufferLength += lengthWritten;
-  outputBuffer += lengthWritten;
-  h->overallDuration -= h->audioFrameLength;
-  h->pcmOffset -= h->audioFrameLength;
+  SIecFramePlan* plans = NULL;
+  if (maxNumPlans > 0) {
+    plans = (SIecFramePlan*)malloc(maxNumPlans * sizeof(SIecFramePlan));
+    if (plans == NULL) {
+      return IECENC_BUFFER_ERROR;
+    }
+  }
 
-  // adjust the written data
-  uint32_t buffersToDelete = 0;
-  for (uint32_t i = 0; i < numBuffersToWrite; i++) {
-    if (i == numBuffersToWrite - 1 && payloadDataLength > numAvailableBytes) {
-      h->auPending = true;
-      h->frameLength[i] = payloadDataLength - numAvailableBytes;
-      h->frameDuration[i] = 0;
-    } else {
-      h->auPending = false;
-      h->frameLength[i] = 0;
-      h->frameDuration[i] = 0;
-      buffersToDelete++;
+  // planning pass: determine the layout of all IEC frames
+  h->framePlan = plans;
+  h->numFramesPlanned = 0;
+  IECENC_RESULT err = iec61937_encode_process_batch(h, aus, numAus, pNumAusConsumed, outputBuffer,
+                                                    outputBufferLength, burstOffsets, pNumBursts);
+  uint32_t numPlans = h->numFramesPlanned;
+  h->framePlan = NULL;
+  h->numFramesPlanned = 0;
+
+  // filling pass: write the IEC frames in parallel
+  if (numThreads > numPlans / minFramesPerThread) {
+    numThreads = numPlans / minFramesPerThread;
+  }
+  std::vector<std::thread> workers;
+  uint32_t first = 0;
+  for (uint32_t t = 1; t < numThreads; t++) {
+    uint32_t last = (uint32_t)((uint64_t)numPlans * t / numThreads);
+    try {
+      workers.push_back(std::thread(fillIecFrames, h, plans, first, last));
+    } catch (...) {
+      // no further thread available; the remaining IEC frames are written by this thread
+      break;
     }
+    first = last;
+  }
+  fillIecFrames(h, plans, first, numPlans);
+  for (size_t t = 0; t < workers.size(); t++) {
+    workers[t].join();
   }
 
-  // remove/adjust processed frame info
-  if (buffersToDelete > 0) {
-    h->framesStoredCount -= buffersToDelete;
-    memmove(&h->frameLength[0], &h->frameLength[buffersToDelete],
-            h->framesStoredCount * sizeof(uint32_t));
-    memmove(&h->frameDuration[0], &h->frameDuration[buffersToDelete],
-            h->framesStoredCount * sizeof(uint32_t));
+  // hand back the completely written borrowed frames in the order of the sequential encoder
+  for (uint32_t i = 0; i < numPlans; i++) {
+    for (uint32_t j = 0; j < plans[i].numFramesToRelease && h->releaseCallback != NULL; j++) {
+      h->releaseCallback(h->releaseUserData, plans[i].frameToRelease[j]);
+    }
+  }
+  if (!h->borrowFrames) {
+    copyInputFrames(h);
+  }
+
+  free(plans);
+  return err;
+}
+
+IECENC_RESULT iec61937_encode_fill(HANDLE_IEC61937_ENCODER h, IECENC_FILL fill,
+                                   uint8_t* outputBuffer, uint32_t* pOutputBufferLength) {
+  if (h == NULL || outputBuffer == NULL || pOutputBufferLength == NULL) {
+    return IECENC_NULLPTR_ERROR;
+  }
+  if (*pOutputBufferLength < h->outputFrameSize) {
+    return IECENC_BUFFER_ERROR;
+  }
+  if (fill != IECENC_FILL_EMPTY && fill != IECENC_FILL_PAUSE) {
+    return IECENC_CONFIG_ERROR;
+  }
+
+  if (h->framesStoredCount > 0) {
+    // the deadline has passed; write the stored frames regardless of their duration
+    bool auDeferred = false;
+    uint32_t numBuffersToWrite = getNumBuffersToWrite(h, INT32_MAX, NULL, &auDeferred);
+    *pOutputBufferLength = encodeIecFrame(h, outputBuffer, numBuffersToWrite, auDeferred);
+  } else if (fill == IECENC_FILL_PAUSE) {
+    uint32_t lengthWritten =
+        iec61937::writePauseBurst(outputBuffer, (uint16_t)h->audioFrameLength);
+    *pOutputBufferLength = finishIecFrame(h, outputBuffer, lengthWritten);
+    h->overallDuration -= h->audioFrameLength;
+    h->pcmOffset -= h->audioFrameLength;
+    h->stats.numPauseBursts++;
+    IEC61937_TRACE(h, IEC61937_TRACE_ENC_PAUSE_WRITTEN, h->audioFrameLength, 0);
+  } else {
+    // IEC frame with an empty payload header list
+    *pOutputBufferLength = encodeIecFrame(h, outputBuffer, 0, false);
+  }
+
+  // The underrun is a gap in the time line: MPEG-H frames which are stored later continue right
+  // after the frames already written but never start before the next IEC frame.
+  int32_t timelineStart = getTimelineStart(h);
+  if (h->pcmOffset < timelineStart) {
+    h->overallDuration += timelineStart - h->pcmOffset;
+    h->pcmOffset = timelineStart;
   }
-  uint32_t payloadDataToDelete = payloadDataLength;
-  if (payloadDataLength > numAvailableBytes) {
-    payloadDataToDelete = numAvailableBytes;
+
+  return IECENC_OK;
+}
+
+IECENC_RESULT iec61937_encode_flush(HANDLE_IEC61937_ENCODER h, uint8_t* outputBuffer,
+                                    uint32_t* pOutputBufferLength) {
+  if (h == NULL || outputBuffer == NULL || pOutputBufferLength == NULL) {
+    return IECENC_NULLPTR_ERROR;
   }
-  uint32_t payloadDataToKeep = currentWorkbufferBytes - payloadDataToDelete;
-  if (payloadDataToKeep > 0) {
-    memmove(&h->workBuffer[0], h->pWorkBufferRead, payloadDataToKeep * sizeof(uint8_t));
+  if (*pOutputBufferLength < h->outputFrameSize) {
+    return IECENC_BUFFER_ERROR;
   }
-  h->pWorkBufferRead = h->workBuffer;
-  h->pWorkBufferWrite = &h->workBuffer[payloadDataToKeep];
+  *pOutputBufferLength = 0;
+
+  if (h->framesStoredCount == 0) {
+    // everything has been written; restart the time line for a following stream
+    resetTimeline(h);
+    return IECENC_OK;
+  }
+
+  // write all stored frames which fit into the IEC frame regardless of their duration
+  bool auDeferred = false;
+  uint32_t numBuffersToWrite = getNumBuffersToWrite(h, INT32_MAX, NULL, &auDeferred);
+  *pOutputBufferLength = encodeIecFrame(h, outputBuffer, numBuffersToWrite, auDeferred);
 
   return IECENC_OK;
 }
@@ -0,0 +1,226 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+#include "iec61937_enc.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Alignment of the pool memory sections
+#define POOL_MEMORY_ALIGNMENT 64
+
+struct iec61937_encoder_pool {
+  bool ownsMemory;
+  uint8_t* instanceMemory;
+  uint32_t instanceSize;
+  uint32_t numEncoders;
+
+  // Stack of the indices of the available instances
+  uint32_t* freeList;
+  uint32_t numFree;
+
+  // Flags of the acquired instances, to reject releasing an instance twice
+  bool* inUse;
+} iec61937_encoder_pool;
+
+static uint32_t alignSize(uint32_t size) {
+  return (size + POOL_MEMORY_ALIGNMENT - 1) & ~(uint32_t)(POOL_MEMORY_ALIGNMENT - 1);
+}
+
+static uint64_t getPoolMemorySize(uint32_t instanceSize, uint32_t numEncoders) {
+  return (uint64_t)alignSize(sizeof(iec61937_encoder_pool)) +
+         alignSize(numEncoders * sizeof(uint32_t)) + alignSize(numEncoders * sizeof(bool)) +
+         (uint64_t)instanceSize * numEncoders;
+}
+
+uint32_t iec61937_encode_pool_get_memory_size(const IEC61937_ENC_CONFIG* config,
+                                              uint32_t numEncoders) {
+  uint32_t instanceSize = alignSize(iec61937_encode_get_memory_size(config));
+  if (instanceSize == 0 || numEncoders == 0) {
+    return 0;
+  }
+  uint64_t memorySize = getPoolMemorySize(instanceSize, numEncoders);
+  if (memorySize > UINT32_MAX) {
+    return 0;
+  }
+  return (uint32_t)memorySize;
+}
+
+HANDLE_IEC61937_ENCODER_POOL iec61937_encode_pool_create(const IEC61937_ENC_CONFIG* config,
+                                                         uint32_t numEncoders, void* memory,
+                                                         uint32_t memorySize) {
+  uint32_t requiredMemorySize = iec61937_encode_pool_get_memory_size(config, numEncoders);
+  if (requiredMemorySize == 0) {
+    return NULL;
+  }
+
+  bool ownsMemory = false;
+  if (memory == NULL) {
+    memory = malloc(requiredMemorySize);
+    if (memory == NULL) {
+      return NULL;
+    }
+    ownsMemory = true;
+  } else if (memorySize < requiredMemorySize || ((uintptr_t)memory % alignof(max_align_t)) != 0) {
+    return NULL;
+  }
+
+  // touch all pages once so that acquiring an instance does not cause page faults
+  memset(memory, 0, requiredMemorySize);
+
+  HANDLE_IEC61937_ENCODER_POOL pool = (HANDLE_IEC61937_ENCODER_POOL)memory;
+  pool->ownsMemory = ownsMemory;
+  pool->freeList = (uint32_t*)((uint8_t*)memory + alignSize(sizeof(iec61937_encoder_pool)));
+  pool->inUse = (bool*)((uint8_t*)pool->freeList + alignSize(numEncoders * sizeof(uint32_t)));
+  pool->instanceMemory = (uint8_t*)pool->inUse + alignSize(numEncoders * sizeof(bool));
+  pool->instanceSize = alignSize(iec61937_encode_get_memory_size(config));
+  pool->numEncoders = numEncoders;
+  pool->numFree = numEncoders;
+
+  for (uint32_t i = 0; i < numEncoders; i++) {
+    HANDLE_IEC61937_ENCODER h = iec61937_encode_open_in_place(
+        config, pool->instanceMemory + (uint64_t)i * pool->instanceSize, pool->instanceSize);
+    if (h == NULL) {
+      if (ownsMemory) {
+        free(memory);
+      }
+      return NULL;
+    }
+    // hand out the instances in ascending order
+    pool->freeList[i] = numEncoders - 1 - i;
+  }
+
+  return pool;
+}
+
+HANDLE_IEC61937_ENCODER iec61937_encode_pool_acquire(HANDLE_IEC61937_ENCODER_POOL pool) {
+  if (pool == NULL || pool->numFree == 0) {
+    return NULL;
+  }
+  pool->numFree--;
+  uint32_t index = pool->freeList[pool->numFree];
+  pool->inUse[index] = true;
+  return (HANDLE_IEC61937_ENCODER)(pool->instanceMemory + (uint64_t)index * pool->instanceSize);
+}
+
+IECENC_RESULT iec61937_encode_pool_release(HANDLE_IEC61937_ENCODER_POOL pool,
+                                           HANDLE_IEC61937_ENCODER h) {
+  if (pool == NULL || h == NULL) {
+    return IECENC_NULLPTR_ERROR;
+  }
+  uint8_t* instance = (uint8_t*)h;
+  if (instance < pool->instanceMemory ||
+      instance >= pool->instanceMemory + (uint64_t)pool->numEncoders * pool->instanceSize ||
+      (instance - pool->instanceMemory) % pool->instanceSize != 0) {
+    return IECENC_BUFFER_ERROR;
+  }
+  uint32_t index = (uint32_t)((instance - pool->instanceMemory) / pool->instanceSize);
+  if (!pool->inUse[index]) {
+    // the instance is already available
+    return IECENC_BUFFER_ERROR;
+  }
+
+  // the instance is reset here so that it is ready for the next session
+  iec61937_encode_reset(h);
+#if defined(IEC61937_ENABLE_TRACING)
+  // the trace callback belongs to the session
+  iec61937_encode_set_trace(h, NULL, NULL);
+#endif
+  pool->inUse[index] = false;
+  pool->freeList[pool->numFree] = index;
+  pool->numFree++;
+  return IECENC_OK;
+}
+
+void iec61937_encode_pool_destroy(HANDLE_IEC61937_ENCODER_POOL pool) {
+  if (pool == NULL) {
+    return;
+  }
+  for (uint32_t i = 0; i < pool->numEncoders; i++) {
+    iec61937_encode_close(
+        (HANDLE_IEC61937_ENCODER)(pool->instanceMemory + (uint64_t)i * pool->instanceSize));
+  }
+  if (pool->ownsMemory) {
+    free(pool);
+  }
+}
@@ -0,0 +1,357 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+#include "iec61937_link_sim.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Growth of the received data per fed byte in the worst case: the burst is duplicated and every
+// byte is followed by a slip and a repeated PCM sample frame byte.
+#define LINK_MAX_EXPANSION 6
+#define LINK_BUFFER_SIZE (8 * IEC61937_LINK_MAX_FEED_SIZE)
+
+struct iec61937_link_state {
+  IEC61937_LINK_CONFIG config;
+  uint32_t randomState;
+  uint8_t* buffer;              /* received data which has not been obtained yet */
+  uint32_t numBufferBytes;
+  uint32_t chunkSize;           /* size of the next chunk, 0 until the next burst is fed */
+  uint64_t bytesSent;           /* position in the transmitted stream */
+  uint64_t bytesBuffered;       /* position in the received stream */
+  uint64_t nextBitFlip;         /* bit position in the transmitted stream */
+  uint64_t nextSlip;            /* byte position in the transmitted stream */
+  uint64_t nextDropout;         /* byte position in the transmitted stream */
+  uint64_t nextDuplicate;       /* index of the next duplicated burst */
+  uint64_t driftInterval;       /* bytes from one clock drift event to the next */
+  uint64_t nextDrift;           /* byte position in the transmitted stream */
+  uint32_t numLostBytesPending; /* remaining bytes of a dropout or a lost sample frame */
+  // last transmitted PCM sample frame
+  uint8_t sampleFrame[IEC61937_LINK_MAX_SAMPLE_FRAME_SIZE];
+  IEC61937_LINK_STATS stats;
+} iec61937_link_state;
+
+// Small deterministic generator, so the same configuration always results in the same stream.
+static uint32_t nextRandom(HANDLE_IEC61937_LINK h) {
+  h->randomState = h->randomState * 1664525u + 1013904223u;
+  return h->randomState >> 8;
+}
+
+// Returns an exponentially distributed interval of at least 1 with the given mean.
+static uint64_t drawInterval(HANDLE_IEC61937_LINK h, uint64_t mean) {
+  double interval = -(double)mean * log((nextRandom(h) + 1.0) / (double)((1u << 24) + 1));
+  return interval < 1.0 ? 1 : (uint64_t)(interval + 0.5);
+}
+
+static void drawChunkSize(HANDLE_IEC61937_LINK h) {
+  const IEC61937_LINK_CONFIG* config = &h->config;
+  h->chunkSize = config->maxChunkSize;
+  if (config->maxChunkSize > config->minChunkSize) {
+    h->chunkSize = config->minChunkSize +
+                   nextRandom(h) % (config->maxChunkSize - config->minChunkSize + 1);
+  }
+}
+
+static void reportImpairment(HANDLE_IEC61937_LINK h, IECLINK_IMPAIRMENT impairment) {
+  if (h->config.impairmentCallback != NULL) {
+    h->config.impairmentCallback(h->config.impairmentUserData, impairment, h->bytesBuffered);
+  }
+}
+
+static void receiveByte(HANDLE_IEC61937_LINK h, uint8_t value) {
+  h->buffer[h->numBufferBytes++] = value;
+  h->bytesBuffered++;
+}
+
+// Transmits one byte and applies the impairments which occur at its position.
+static void transmitByte(HANDLE_IEC61937_LINK h, uint8_t value) {
+  const IEC61937_LINK_CONFIG* config = &h->config;
+  uint64_t position = h->bytesSent++;
+
+  // the receiver clock drifts by one PCM sample frame at a sample frame boundary
+  uint32_t sampleFrameIndex = (uint32_t)(position % config->sampleFrameSize);
+  if (h->driftInterval > 0 && position == h->nextDrift) {
+    h->nextDrift += h->driftInterval;
+    h->stats.numDriftFrames++;
+    reportImpairment(h, IECLINK_IMPAIRMENT_CLOCK_DRIFT);
+    if (config->clockDrift > 0) {
+      // the previous sample frame is received twice
+      for (uint32_t i = 0; i < config->sampleFrameSize; i++) {
+        receiveByte(h, h->sampleFrame[i]);
+      }
+      h->stats.bytesInserted += config->sampleFrameSize;
+    } else {
+      h->numLostBytesPending += config->sampleFrameSize;
+    }
+  }
+  h->sampleFrame[sampleFrameIndex] = value;
+
+  if (config->dropoutInterval > 0 && position == h->nextDropout) {
+    h->nextDropout = position + config->dropoutLength + drawInterval(h, config->dropoutInterval);
+    h->stats.numDropouts++;
+    reportImpairment(h, IECLINK_IMPAIRMENT_DROPOUT);
+    h->numLostBytesPending += config->dropoutLength;
+  }
+  if (h->numLostBytesPending > 0) {
+    h->numLostBytesPending--;
+    h->stats.bytesLost++;
+    return;
+  }
+
+  // bit flips scheduled for lost bytes hit the next received byte
+  while (config->bitErrorInterval > 0 && h->nextBitFlip < (position + 1) * 8) {
+    value ^= (uint8_t)(0x80 >> (h->nextBitFlip % 8));
+    h->nextBitFlip += drawInterval(h, config->bitErrorInterval);
+    h->stats.numBitFlips++;
+    reportImpairment(h, IECLINK_IMPAIRMENT_BIT_FLIP);
+  }
+
+  // a slip scheduled for a lost byte hits the next received byte
+  if (config->slipInterval > 0 && position >= h->nextSlip) {
+    h->nextSlip = position + drawInterval(h, config->slipInterval);
+    h->stats.numSlips++;
+    reportImpairment(h, IECLINK_IMPAIRMENT_SLIP);
+    if (nextRandom(h) & 1) {
+      h->stats.bytesLost++;
+      return;
+    }
+    receiveByte(h, value);
+    h->stats.bytesInserted++;
+  }
+  receiveByte(h, value);
+}
+
+// Writes numBytes of the received data into outputBuffer.
+static void removeBytes(HANDLE_IEC61937_LINK h, uint8_t* outputBuffer, uint32_t numBytes) {
+  memcpy(outputBuffer, h->buffer, numBytes);
+  h->numBufferBytes -= numBytes;
+  memmove(h->buffer, h->buffer + numBytes, h->numBufferBytes);
+  h->stats.bytesReceived += numBytes;
+}
+
+void iec61937_link_config_init(IEC61937_LINK_CONFIG* config) {
+  if (config == NULL) {
+    return;
+  }
+  memset(config, 0, sizeof(IEC61937_LINK_CONFIG));
+  config->sampleFrameSize = 4;
+}
+
+HANDLE_IEC61937_LINK iec61937_link_open(const IEC61937_LINK_CONFIG* config) {
+  if (config == NULL) {
+    return NULL;
+  }
+  if (config->sampleFrameSize == 0 ||
+      config->sampleFrameSize > IEC61937_LINK_MAX_SAMPLE_FRAME_SIZE ||
+      config->clockDrift > IEC61937_LINK_MAX_CLOCK_DRIFT ||
+      config->clockDrift < -IEC61937_LINK_MAX_CLOCK_DRIFT ||
+      (config->dropoutInterval > 0 && config->dropoutLength == 0) ||
+      config->maxChunkSize > IEC61937_LINK_MAX_FEED_SIZE ||
+      (config->maxChunkSize > 0 &&
+       (config->minChunkSize == 0 || config->minChunkSize > config->maxChunkSize))) {
+    return NULL;
+  }
+
+  HANDLE_IEC61937_LINK h = (HANDLE_IEC61937_LINK)calloc(1, sizeof(iec61937_link_state));
+  if (h == NULL) {
+    return NULL;
+  }
+  h->buffer = (uint8_t*)malloc(LINK_BUFFER_SIZE);
+  if (h->buffer == NULL) {
+    free(h);
+    return NULL;
+  }
+  h->config = *config;
+  h->randomState = config->seed;
+  if (config->bitErrorInterval > 0) {
+    h->nextBitFlip = drawInterval(h, config->bitErrorInterval);
+  }
+  if (config->slipInterval > 0) {
+    h->nextSlip = drawInterval(h, config->slipInterval);
+  }
+  if (config->dropoutInterval > 0) {
+    h->nextDropout = drawInterval(h, config->dropoutInterval);
+  }
+  if (config->duplicateInterval > 0) {
+    h->nextDuplicate = drawInterval(h, config->duplicateInterval);
+  }
+  if (config->clockDrift != 0) {
+    h->driftInterval = (uint64_t)config->sampleFrameSize *
+                       (1000000 / (uint32_t)abs(config->clockDrift));
+    h->nextDrift = h->driftInterval;
+  }
+  drawChunkSize(h);
+  return h;
+}
+
+void iec61937_link_close(HANDLE_IEC61937_LINK h) {
+  if (h != NULL) {
+    free(h->buffer);
+    free(h);
+  }
+}
+
+IECLINK_RESULT iec61937_link_feed(HANDLE_IEC61937_LINK h, const uint8_t* inputBuffer,
+                                  uint32_t inputBufferLength) {
+  if (h == NULL || inputBuffer == NULL) {
+    return IECLINK_NULLPTR_ERROR;
+  }
+  if (inputBufferLength > IEC61937_LINK_MAX_FEED_SIZE ||
+      h->numBufferBytes + (uint64_t)LINK_MAX_EXPANSION * inputBufferLength +
+              IEC61937_LINK_MAX_SAMPLE_FRAME_SIZE >
+          LINK_BUFFER_SIZE) {
+    return IECLINK_BUFFER_ERROR;
+  }
+
+  uint32_t numCopies = 1;
+  if (h->config.duplicateInterval > 0 && h->stats.numBursts == h->nextDuplicate) {
+    h->nextDuplicate += drawInterval(h, h->config.duplicateInterval);
+    numCopies = 2;
+  }
+  for (uint32_t copy = 0; copy < numCopies; copy++) {
+    if (copy > 0) {
+      h->stats.numDuplicates++;
+      h->stats.bytesInserted += inputBufferLength;
+      reportImpairment(h, IECLINK_IMPAIRMENT_DUPLICATE);
+    }
+    for (uint32_t i = 0; i < inputBufferLength; i++) {
+      transmitByte(h, inputBuffer[i]);
+    }
+  }
+  h->stats.numBursts++;
+  h->stats.bytesFed += inputBufferLength;
+  if (h->config.maxChunkSize == 0) {
+    // one chunk per fed burst
+    h->chunkSize = h->numBufferBytes;
+  }
+  return IECLINK_OK;
+}
+
+IECLINK_RESULT iec61937_link_process(HANDLE_IEC61937_LINK h, uint8_t* outputBuffer,
+                                     uint32_t* pOutputBufferLength) {
+  if (h == NULL || outputBuffer == NULL || pOutputBufferLength == NULL) {
+    return IECLINK_NULLPTR_ERROR;
+  }
+  uint32_t outputBufferLength = *pOutputBufferLength;
+  *pOutputBufferLength = 0;
+  if (h->chunkSize == 0 || h->numBufferBytes < h->chunkSize) {
+    return IECLINK_FEED_MORE_DATA;
+  }
+  if (outputBufferLength < h->chunkSize) {
+    return IECLINK_BUFFER_ERROR;
+  }
+  removeBytes(h, outputBuffer, h->chunkSize);
+  *pOutputBufferLength = h->chunkSize;
+  if (h->config.maxChunkSize == 0) {
+    h->chunkSize = 0;
+  } else {
+    drawChunkSize(h);
+  }
+  return IECLINK_OK;
+}
+
+IECLINK_RESULT iec61937_link_flush(HANDLE_IEC61937_LINK h, uint8_t* outputBuffer,
+                                   uint32_t* pOutputBufferLength) {
+  if (h == NULL || outputBuffer == NULL || pOutputBufferLength == NULL) {
+    return IECLINK_NULLPTR_ERROR;
+  }
+  uint32_t outputBufferLength = *pOutputBufferLength;
+  *pOutputBufferLength = 0;
+  if (outputBufferLength < h->numBufferBytes) {
+    return IECLINK_BUFFER_ERROR;
+  }
+  *pOutputBufferLength = h->numBufferBytes;
+  removeBytes(h, outputBuffer, h->numBufferBytes);
+  if (h->config.maxChunkSize == 0) {
+    h->chunkSize = 0;
+  }
+  return IECLINK_OK;
+}
+
+IECLINK_RESULT iec61937_link_get_stats(HANDLE_IEC61937_LINK h, IEC61937_LINK_STATS* stats) {
+  if (h == NULL || stats == NULL) {
+    return IECLINK_NULLPTR_ERROR;
+  }
+  *stats = h->stats;
+  return IECLINK_OK;
+}
@@ -0,0 +1,240 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+#if !defined(IEC61937_PCM_H)
+#define IEC61937_PCM_H
+
+/**
+ * @file   iec61937_pcm.h
+ * @brief  Header-only conversion of IEC61937-13 data between packed 16-bit big-endian words and
+ *         the PCM container formats of IEC61937_PCM_FORMAT.
+ *
+ * The conversions use SSE2 if available (8 words per step) and a scalar loop otherwise and for
+ * the remaining words.
+ */
+
+#include "iec61937_pcm_format.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define IEC61937_PCM_SSE2 1
+#else
+#define IEC61937_PCM_SSE2 0
+#endif
+
+namespace iec61937 {
+
+// Number of bytes per 16-bit IEC word in a PCM container or 0 for an unsupported format
+inline uint32_t getPcmContainerSize(IEC61937_PCM_FORMAT format) {
+  switch (format) {
+    case IEC61937_PCM_FORMAT_S16_BE:
+    case IEC61937_PCM_FORMAT_S16_LE:
+      return 2;
+    case IEC61937_PCM_FORMAT_S32_LE:
+    case IEC61937_PCM_FORMAT_S24_LE:
+      return 4;
+    default:
+      return 0;
+  }
+}
+
+#if IEC61937_PCM_SSE2
+// Swaps the bytes of the eight 16-bit words
+inline __m128i swapWordBytes(__m128i words) {
+  return _mm_or_si128(_mm_slli_epi16(words, 8), _mm_srli_epi16(words, 8));
+}
+#endif
+
+// Converts numWords packed 16-bit big-endian words in place into the PCM container format. The
+// buffer has to hold numWords * getPcmContainerSize(format) bytes. Returns the converted length
+// in bytes.
+inline uint32_t convertToPcmFormat(IEC61937_PCM_FORMAT format, uint8_t* buffer,
+                                   uint32_t numWords) {
+  uint32_t i = 0;
+  switch (format) {
+    case IEC61937_PCM_FORMAT_S16_LE:
+#if IEC61937_PCM_SSE2
+      for (; i + 8 <= numWords; i += 8) {
+        __m128i words = _mm_loadu_si128((const __m128i*)(buffer + 2 * i));
+        _mm_storeu_si128((__m128i*)(buffer + 2 * i), swapWordBytes(words));
+      }
+#endif
+      for (; i < numWords; i++) {
+        uint8_t msb = buffer[2 * i];
+        buffer[2 * i] = buffer[2 * i + 1];
+        buffer[2 * i + 1] = msb;
+      }
+      return numWords * 2;
+    case IEC61937_PCM_FORMAT_S32_LE:
+    case IEC61937_PCM_FORMAT_S24_LE: {
+      // the data expands, so it is converted from the end to the start: a word is read before
+      // its 32-bit slot (at twice the offset) is written
+      uint32_t shift = (format == IEC61937_PCM_FORMAT_S32_LE) ? 16 : 8;
+      uint32_t numVectorWords = 0;
+#if IEC61937_PCM_SSE2
+      numVectorWords = numWords & ~7u;
+#endif
+      for (i = numWords; i > numVectorWords; i--) {
+        uint32_t word = ((uint32_t)buffer[2 * (i - 1)] << 8) | buffer[2 * (i - 1) + 1];
+        uint32_t slot = word << shift;
+        buffer[4 * (i - 1) + 0] = (uint8_t)slot;
+        buffer[4 * (i - 1) + 1] = (uint8_t)(slot >> 8);
+        buffer[4 * (i - 1) + 2] = (uint8_t)(slot >> 16);
+        buffer[4 * (i - 1) + 3] = (uint8_t)(slot >> 24);
+      }
+#if IEC61937_PCM_SSE2
+      const __m128i zero = _mm_setzero_si128();
+      for (i = numVectorWords; i > 0; i -= 8) {
+        __m128i words = swapWordBytes(_mm_loadu_si128((const __m128i*)(buffer + 2 * (i - 8))));
+        // 16-bit words in the upper half of the 32-bit slots
+        __m128i slotsLow = _mm_unpacklo_epi16(zero, words);
+        __m128i slotsHigh = _mm_unpackhi_epi16(zero, words);
+        if (format == IEC61937_PCM_FORMAT_S24_LE) {
+          slotsLow = _mm_srli_epi32(slotsLow, 8);
+          slotsHigh = _mm_srli_epi32(slotsHigh, 8);
+        }
+        _mm_storeu_si128((__m128i*)(buffer + 4 * (i - 8)), slotsLow);
+        _mm_storeu_si128((__m128i*)(buffer + 4 * (i - 8) + 16), slotsHigh);
+      }
+#endif
+      return numWords * 4;
+    }
+    default:
+      return numWords * 2;
+  }
+}
+
+// Converts numWords 16-bit IEC words in the PCM container format from input into packed 16-bit
+// big-endian words in output. The buffers must not overlap.
+inline void convertFromPcmFormat(IEC61937_PCM_FORMAT format, uint8_t* output, const uint8_t* input,
+                                 uint32_t numWords) {
+  uint32_t i = 0;
+  switch (format) {
+    case IEC61937_PCM_FORMAT_S16_LE:
+#if IEC61937_PCM_SSE2
+      for (; i + 8 <= numWords; i += 8) {
+        __m128i words = _mm_loadu_si128((const __m128i*)(input + 2 * i));
+        _mm_storeu_si128((__m128i*)(output + 2 * i), swapWordBytes(words));
+      }
+#endif
+      for (; i < numWords; i++) {
+        output[2 * i] = input[2 * i + 1];
+        output[2 * i + 1] = input[2 * i];
+      }
+      break;
+    case IEC61937_PCM_FORMAT_S32_LE:
+    case IEC61937_PCM_FORMAT_S24_LE: {
+      // byte offset of the most significant byte of the 16-bit word within the 32-bit slot
+      uint32_t msbOffset = (format == IEC61937_PCM_FORMAT_S32_LE) ? 3 : 2;
+#if IEC61937_PCM_SSE2
+      for (; i + 8 <= numWords; i += 8) {
+        __m128i slotsLow = _mm_loadu_si128((const __m128i*)(input + 4 * i));
+        __m128i slotsHigh = _mm_loadu_si128((const __m128i*)(input + 4 * i + 16));
+        if (format == IEC61937_PCM_FORMAT_S24_LE) {
+          slotsLow = _mm_slli_epi32(slotsLow, 8);
+          slotsHigh = _mm_slli_epi32(slotsHigh, 8);
+        }
+        // the arithmetic shift keeps the words in the signed 16-bit range, so the saturating pack
+        // does not change them
+        __m128i words =
+            _mm_packs_epi32(_mm_srai_epi32(slotsLow, 16), _mm_srai_epi32(slotsHigh, 16));
+        _mm_storeu_si128((__m128i*)(output + 2 * i), swapWordBytes(words));
+      }
+#endif
+      for (; i < numWords; i++) {
+        output[2 * i] = input[4 * i + msbOffset];
+        output[2 * i + 1] = input[4 * i + msbOffset - 1];
+      }
+      break;
+    }
+    default:
+      memcpy(output, input, numWords * 2);
+      break;
+  }
+}
+
+}  // namespace iec61937
+
+#endif /* !defined(IEC61937_PCM_H) */
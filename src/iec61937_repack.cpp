@@ -0,0 +1,291 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+#include "iec61937_repack.h"
+#include "iec61937_dec.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Maximum MPEG-H frame duration accepted by the encoder
+#define MAX_MPEGH_FRAME_DURATION 4096
+
+struct iec61937_repacketizer_state {
+  HANDLE_IEC61937_DECODER decoder;
+  HANDLE_IEC61937_ENCODER encoder;
+  uint32_t outputFrameSize;
+
+  // Input time line
+  int64_t iecFrameStart;     /* PTS of the current input IEC frame */
+  uint32_t iecFrameLength;   /* audio frame length of the last input IEC frame */
+
+  // The two MPEG-H frame buffers are swapped instead of copying the MPEG-H frames: one holds the
+  // last decoded MPEG-H frame until its duration is known, the other one is passed to the encoder
+  // and receives the next decoded MPEG-H frame afterwards.
+  uint8_t auBuffer[2][MAX_MPEGH_FRAME_SIZE];
+  uint32_t heldAuIndex;
+  bool auHeld;
+  uint32_t heldAuLength;
+  int64_t heldAuPts;
+  bool auPending; /* the MPEG-H frame in the other buffer has not been taken by the encoder yet */
+  uint32_t pendingAuLength;
+  uint32_t pendingAuDuration;
+  uint32_t lastAuDuration;
+} iec61937_repacketizer_state;
+
+// Derives the duration of the held MPEG-H frame from the PTS of the following MPEG-H frame. Gaps
+// and discontinuities of the input time line fall back to the previous duration.
+static uint32_t getHeldAuDuration(HANDLE_IEC61937_REPACKETIZER h, int64_t nextPts) {
+  int64_t duration = nextPts - h->heldAuPts;
+  if (duration > 0 && duration <= MAX_MPEGH_FRAME_DURATION) {
+    return (uint32_t)duration;
+  }
+  return (h->lastAuDuration > 0) ? h->lastAuDuration : h->iecFrameLength;
+}
+
+// Moves the held MPEG-H frame to the encoder input by swapping the buffers
+static void passHeldAu(HANDLE_IEC61937_REPACKETIZER h, uint32_t duration) {
+  h->pendingAuLength = h->heldAuLength;
+  h->pendingAuDuration = duration;
+  h->auPending = true;
+  h->auHeld = false;
+  h->lastAuDuration = duration;
+  h->heldAuIndex ^= 1;
+}
+
+// Passes the pending MPEG-H frame to the encoder and obtains at most one output IEC frame
+static IECREPACK_RESULT encodePendingAu(HANDLE_IEC61937_REPACKETIZER h, uint8_t* outputBuffer,
+                                        uint32_t* pOutputBufferLength) {
+  bool auProcessed = false;
+  IECENC_RESULT err =
+      iec61937_encode_process(h->encoder, h->auBuffer[h->heldAuIndex ^ 1], h->pendingAuLength,
+                              &auProcessed, h->pendingAuDuration, outputBuffer,
+                              pOutputBufferLength);
+  if (err != IECENC_OK) {
+    return IECREPACK_ENCODE_ERROR;
+  }
+  if (auProcessed) {
+    h->auPending = false;
+  }
+  return IECREPACK_OK;
+}
+
+HANDLE_IEC61937_REPACKETIZER iec61937_repack_open(const IEC61937_ENC_CONFIG* outputConfig) {
+  if (outputConfig == NULL) {
+    return NULL;
+  }
+  HANDLE_IEC61937_REPACKETIZER h;
+
+  h = (HANDLE_IEC61937_REPACKETIZER)calloc(1, sizeof(iec61937_repacketizer_state));
+  if (h == NULL) {
+    return NULL;
+  }
+  h->decoder = iec61937_decode_open();
+  h->encoder = iec61937_encode_open_config(outputConfig);
+  if (h->decoder == NULL || h->encoder == NULL) {
+    iec61937_repack_close(h);
+    return NULL;
+  }
+  h->outputFrameSize = iec61937_encode_get_frame_size(h->encoder);
+
+  return h;
+}
+
+void iec61937_repack_close(HANDLE_IEC61937_REPACKETIZER h) {
+  if (h == NULL) {
+    return;
+  }
+  if (h->decoder != NULL) {
+    iec61937_decode_close(h->decoder);
+  }
+  if (h->encoder != NULL) {
+    iec61937_encode_close(h->encoder);
+  }
+  free(h);
+}
+
+uint32_t iec61937_repack_get_frame_size(HANDLE_IEC61937_REPACKETIZER h) {
+  if (h == NULL) {
+    return 0;
+  }
+  return h->outputFrameSize;
+}
+
+IECREPACK_RESULT iec61937_repack_feed(HANDLE_IEC61937_REPACKETIZER h, const uint8_t* inputBuffer,
+                                      uint32_t inputBufferLength) {
+  if (h == NULL || inputBuffer == NULL) {
+    return IECREPACK_NULLPTR_ERROR;
+  }
+  IECDEC_RESULT err = iec61937_decode_feed(h->decoder, inputBuffer, inputBufferLength);
+  if (err == IECDEC_BUFFER_ERROR) {
+    return IECREPACK_BUFFER_ERROR;
+  }
+  return (err == IECDEC_OK) ? IECREPACK_OK : IECREPACK_NULLPTR_ERROR;
+}
+
+IECREPACK_RESULT iec61937_repack_process(HANDLE_IEC61937_REPACKETIZER h, uint8_t* outputBuffer,
+                                         uint32_t* pOutputBufferLength) {
+  if (h == NULL || outputBuffer == NULL || pOutputBufferLength == NULL) {
+    return IECREPACK_NULLPTR_ERROR;
+  }
+  if (*pOutputBufferLength < h->outputFrameSize) {
+    return IECREPACK_BUFFER_ERROR;
+  }
+  uint32_t outputBufferLength = *pOutputBufferLength;
+  *pOutputBufferLength = 0;
+
+  while (true) {
+    // the pending MPEG-H frame has to be taken by the encoder before the next one is decoded
+    if (h->auPending) {
+      *pOutputBufferLength = outputBufferLength;
+      IECREPACK_RESULT err = encodePendingAu(h, outputBuffer, pOutputBufferLength);
+      if (err != IECREPACK_OK || *pOutputBufferLength > 0) {
+        return err;
+      }
+      continue;
+    }
+
+    // decode the next MPEG-H frame into the free buffer
+    uint8_t* auBuffer = h->auBuffer[h->heldAuIndex ^ 1];
+    uint32_t auLength = MAX_MPEGH_FRAME_SIZE;
+    int32_t pcmOffset = 0;
+    uint32_t iecFrameLength = 0;
+    bool iecFrameProcessed = false;
+    IECDEC_RESULT err = iec61937_decode_process(h->decoder, auBuffer, &auLength, &pcmOffset,
+                                                &iecFrameLength, &iecFrameProcessed);
+    if (err == IECDEC_FEED_MORE_DATA) {
+      return IECREPACK_FEED_MORE_DATA;
+    }
+    if (err != IECDEC_OK) {
+      return IECREPACK_DECODE_ERROR;
+    }
+
+    if (auLength > 0) {
+      int64_t pts = h->iecFrameStart + pcmOffset;
+      // the decoded MPEG-H frame is held back; if an MPEG-H frame is already held, the PTS of the
+      // new one completes it and it is passed on to the encoder
+      if (h->auHeld) {
+        passHeldAu(h, getHeldAuDuration(h, pts));
+      } else {
+        h->heldAuIndex ^= 1;
+      }
+      h->auHeld = true;
+      h->heldAuLength = auLength;
+      h->heldAuPts = pts;
+    }
+    if (iecFrameProcessed) {
+      // update the input time line
+      h->iecFrameStart += iecFrameLength;
+      h->iecFrameLength = iecFrameLength;
+    }
+  }
+}
+
+IECREPACK_RESULT iec61937_repack_flush(HANDLE_IEC61937_REPACKETIZER h, uint8_t* outputBuffer,
+                                       uint32_t* pOutputBufferLength) {
+  if (h == NULL || outputBuffer == NULL || pOutputBufferLength == NULL) {
+    return IECREPACK_NULLPTR_ERROR;
+  }
+  if (*pOutputBufferLength < h->outputFrameSize) {
+    return IECREPACK_BUFFER_ERROR;
+  }
+  uint32_t outputBufferLength = *pOutputBufferLength;
+  *pOutputBufferLength = 0;
+
+  while (h->auPending || h->auHeld) {
+    if (!h->auPending) {
+      // the duration of the last MPEG-H frame is unknown
+      passHeldAu(h, getHeldAuDuration(h, h->heldAuPts));
+    }
+    *pOutputBufferLength = outputBufferLength;
+    IECREPACK_RESULT err = encodePendingAu(h, outputBuffer, pOutputBufferLength);
+    if (err != IECREPACK_OK || *pOutputBufferLength > 0) {
+      return err;
+    }
+  }
+
+  *pOutputBufferLength = outputBufferLength;
+  if (iec61937_encode_flush(h->encoder, outputBuffer, pOutputBufferLength) != IECENC_OK) {
+    return IECREPACK_ENCODE_ERROR;
+  }
+  return IECREPACK_OK;
+}
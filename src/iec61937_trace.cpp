@@ -0,0 +1,165 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+#include "iec61937_trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+// Number of records collected before they are written to the file
+#define TRACE_SINK_NUM_RECORDS 4096
+// Number of bits of a record's first word holding the event
+#define TRACE_EVENT_BITS 8
+
+struct iec61937_trace_sink {
+  FILE* file;
+  std::chrono::steady_clock::time_point start;
+  uint32_t numRecords;
+  uint8_t records[TRACE_SINK_NUM_RECORDS * IEC61937_TRACE_RECORD_SIZE];
+} iec61937_trace_sink;
+
+static void writeLittleEndian(uint8_t* data, uint64_t value, uint32_t numBytes) {
+  for (uint32_t i = 0; i < numBytes; i++) {
+    data[i] = (uint8_t)(value >> (8 * i));
+  }
+}
+
+static void flushRecords(HANDLE_IEC61937_TRACE_SINK h) {
+  fwrite(h->records, IEC61937_TRACE_RECORD_SIZE, h->numRecords, h->file);
+  h->numRecords = 0;
+}
+
+HANDLE_IEC61937_TRACE_SINK iec61937_trace_sink_open(const char* fileName) {
+  if (fileName == NULL) {
+    return NULL;
+  }
+  HANDLE_IEC61937_TRACE_SINK h =
+      (HANDLE_IEC61937_TRACE_SINK)calloc(1, sizeof(iec61937_trace_sink));
+  if (h == NULL) {
+    return NULL;
+  }
+  h->file = fopen(fileName, "wb");
+  if (h->file == NULL) {
+    free(h);
+    return NULL;
+  }
+
+  // write the file header
+  uint8_t header[sizeof(IEC61937_TRACE_MAGIC) - 1 + 4];
+  memcpy(header, IEC61937_TRACE_MAGIC, sizeof(IEC61937_TRACE_MAGIC) - 1);
+  writeLittleEndian(header + sizeof(IEC61937_TRACE_MAGIC) - 1, IEC61937_TRACE_VERSION, 4);
+  fwrite(header, 1, sizeof(header), h->file);
+
+  h->start = std::chrono::steady_clock::now();
+  return h;
+}
+
+void iec61937_trace_sink_callback(void* userData, IEC61937_TRACE_EVENT event, uint32_t arg0,
+                                  int32_t arg1) {
+  HANDLE_IEC61937_TRACE_SINK h = (HANDLE_IEC61937_TRACE_SINK)userData;
+  if (h == NULL) {
+    return;
+  }
+  uint64_t timestamp = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now() - h->start)
+                           .count();
+  uint8_t* record = h->records + h->numRecords * IEC61937_TRACE_RECORD_SIZE;
+  writeLittleEndian(record, (timestamp << TRACE_EVENT_BITS) | (uint8_t)event, 8);
+  writeLittleEndian(record + 8, arg0, 4);
+  writeLittleEndian(record + 12, (uint32_t)arg1, 4);
+  h->numRecords++;
+  if (h->numRecords == TRACE_SINK_NUM_RECORDS) {
+    flushRecords(h);
+  }
+}
+
+void iec61937_trace_sink_close(HANDLE_IEC61937_TRACE_SINK h) {
+  if (h == NULL) {
+    return;
+  }
+  flushRecords(h);
+  fclose(h->file);
+  free(h);
+}
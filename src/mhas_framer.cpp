@@ -0,0 +1,316 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+#include "mhas_framer.h"
+#include "mhas_common.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+struct mhas_framer_state {
+  uint8_t workBuffer[MHAS_WORKBUFFER_SIZE_BYTES];
+  uint32_t workBufferBytesAvailable;
+  uint32_t auStartIndex; /* start of the MPEG-H frame currently being collected */
+  uint32_t parseIndex;   /* start of the next MHAS packet to be parsed */
+
+  // Sync state
+  bool syncFound;
+
+  // Configuration state
+  uint32_t frameDuration; /* 0 as long as no valid MPEGH3DACFG packet was found */
+} mhas_framer_state;
+
+typedef struct SBitReader {
+  const uint8_t* data;
+  uint32_t numBits;
+  uint32_t bitIndex;
+} SBitReader;
+
+static bool readBits(SBitReader* reader, uint32_t numBits, uint32_t* value) {
+  if (reader->bitIndex + numBits > reader->numBits) {
+    return false;
+  }
+  uint32_t result = 0;
+  for (uint32_t i = 0; i < numBits; i++) {
+    uint32_t bit = (reader->data[reader->bitIndex >> 3] >> (7 - (reader->bitIndex & 7))) & 1;
+    result = (result << 1) | bit;
+    reader->bitIndex++;
+  }
+  *value = result;
+  return true;
+}
+
+// escapedValue() according to ISO/IEC 23008-3 Table 5
+static bool readEscapedValue(SBitReader* reader, uint32_t nBits1, uint32_t nBits2,
+                             uint32_t nBits3, uint64_t* value) {
+  uint32_t valueAdd = 0;
+  if (!readBits(reader, nBits1, &valueAdd)) {
+    return false;
+  }
+  *value = valueAdd;
+  if (valueAdd == (1u << nBits1) - 1) {
+    if (!readBits(reader, nBits2, &valueAdd)) {
+      return false;
+    }
+    *value += valueAdd;
+    if (valueAdd == (1u << nBits2) - 1) {
+      if (!readBits(reader, nBits3, &valueAdd)) {
+        return false;
+      }
+      *value += valueAdd;
+    }
+  }
+  return true;
+}
+
+// Parses the MHAS packet header at parseIndex. Returns false if not enough data is available.
+static bool parsePacketHeader(HANDLE_MHAS_FRAMER h, uint32_t* packetType, uint64_t* packetLength,
+                              uint32_t* headerLength) {
+  uint32_t bytesAvailable = h->workBufferBytesAvailable - h->parseIndex;
+  if (bytesAvailable > MHAS_MAX_PACKET_HEADER_SIZE) {
+    bytesAvailable = MHAS_MAX_PACKET_HEADER_SIZE;
+  }
+  SBitReader reader = {&h->workBuffer[h->parseIndex], bytesAvailable * 8, 0};
+  uint64_t type = 0;
+  uint64_t label = 0;
+  if (!readEscapedValue(&reader, 3, 8, 8, &type) || !readEscapedValue(&reader, 2, 8, 32, &label) ||
+      !readEscapedValue(&reader, 11, 24, 24, packetLength)) {
+    return false;
+  }
+  *packetType = (uint32_t)type;
+  *headerLength = (reader.bitIndex + 7) / 8;
+  return true;
+}
+
+// Returns the output frame length signaled in mpegh3daConfig() or 0 if it is not supported.
+static uint32_t parseConfig(const uint8_t* data, uint64_t length) {
+  // Output frame length per coreSbrFrameLengthIndex according to ISO/IEC 23008-3 Table 73
+  static const uint32_t frameLengths[] = {768, 1024, 2048, 2048, 4096};
+
+  SBitReader reader = {data, (uint32_t)((length < 8) ? length * 8 : 64), 0};
+  uint32_t profileLevelIndication = 0;
+  uint32_t samplingFrequencyIndex = 0;
+  uint32_t samplingFrequency = 0;
+  uint32_t coreSbrFrameLengthIndex = 0;
+  if (!readBits(&reader, 8, &profileLevelIndication) ||
+      !readBits(&reader, 5, &samplingFrequencyIndex)) {
+    return 0;
+  }
+  if (samplingFrequencyIndex == 0x1f && !readBits(&reader, 24, &samplingFrequency)) {
+    return 0;
+  }
+  if (!readBits(&reader, 3, &coreSbrFrameLengthIndex) ||
+      coreSbrFrameLengthIndex >= sizeof(frameLengths) / sizeof(frameLengths[0])) {
+    return 0;
+  }
+  return frameLengths[coreSbrFrameLengthIndex];
+}
+
+// Searches the next MHAS SYNC packet. Returns false if more data is needed.
+static bool findSync(HANDLE_MHAS_FRAMER h) {
+  for (uint32_t i = h->auStartIndex; i + 3 <= h->workBufferBytesAvailable; i++) {
+    // MHAS SYNC packet: type 6, label 0, length 1, followed by the sync word
+    if (h->workBuffer[i] == 0xC0 && h->workBuffer[i + 1] == 0x01 &&
+        h->workBuffer[i + 2] == MHAS_SYNC_WORD) {
+      h->auStartIndex = i;
+      h->parseIndex = i;
+      h->syncFound = true;
+      return true;
+    }
+  }
+  // keep the bytes which might be the start of a SYNC packet
+  if (h->workBufferBytesAvailable > h->auStartIndex + 2) {
+    h->auStartIndex = h->workBufferBytesAvailable - 2;
+  }
+  h->parseIndex = h->auStartIndex;
+  return false;
+}
+
+static void loseSync(HANDLE_MHAS_FRAMER h) {
+  // restart the search right after the start of the broken MPEG-H frame
+  h->syncFound = false;
+  h->auStartIndex++;
+  h->parseIndex = h->auStartIndex;
+}
+
+HANDLE_MHAS_FRAMER mhas_framer_open(void) {
+  HANDLE_MHAS_FRAMER h;
+
+  h = (HANDLE_MHAS_FRAMER)calloc(1, sizeof(mhas_framer_state));
+  if (h == NULL) {
+    return NULL;
+  }
+  // the stream is expected to start at an MHAS packet boundary
+  h->syncFound = true;
+
+  return h;
+}
+
+void mhas_framer_close(HANDLE_MHAS_FRAMER h) {
+  free(h);
+}
+
+MHAS_RESULT mhas_framer_feed(HANDLE_MHAS_FRAMER h, const uint8_t* inputBuffer,
+                             uint32_t inputBufferLength) {
+  if (h == NULL || inputBuffer == NULL) {
+    return MHAS_NULLPTR_ERROR;
+  }
+  if (inputBufferLength > MHAS_WORKBUFFER_SIZE_BYTES - h->workBufferBytesAvailable) {
+    // move the data of the current MPEG-H frame to the start of the work buffer; this only happens
+    // once per work buffer fill instead of once per MPEG-H frame
+    uint32_t bytesToKeep = h->workBufferBytesAvailable - h->auStartIndex;
+    memmove(h->workBuffer, h->workBuffer + h->auStartIndex, bytesToKeep);
+    h->parseIndex -= h->auStartIndex;
+    h->auStartIndex = 0;
+    h->workBufferBytesAvailable = bytesToKeep;
+    if (inputBufferLength > MHAS_WORKBUFFER_SIZE_BYTES - h->workBufferBytesAvailable) {
+      return MHAS_BUFFER_ERROR;
+    }
+  }
+
+  memcpy(h->workBuffer + h->workBufferBytesAvailable, inputBuffer, inputBufferLength);
+  h->workBufferBytesAvailable += inputBufferLength;
+  return MHAS_OK;
+}
+
+MHAS_RESULT mhas_framer_process(HANDLE_MHAS_FRAMER h, uint8_t* outputBuffer,
+                                uint32_t* pOutputBufferLength, uint32_t* pFrameDuration) {
+  if (h == NULL || outputBuffer == NULL || pOutputBufferLength == NULL || pFrameDuration == NULL) {
+    return MHAS_NULLPTR_ERROR;
+  }
+  uint32_t outputBufferLength = *pOutputBufferLength;
+  *pOutputBufferLength = 0;
+  *pFrameDuration = 0;
+
+  while (true) {
+    if (!h->syncFound && !findSync(h)) {
+      return MHAS_FEED_MORE_DATA;
+    }
+
+    uint32_t packetType = 0;
+    uint64_t packetLength = 0;
+    uint32_t headerLength = 0;
+    if (!parsePacketHeader(h, &packetType, &packetLength, &headerLength)) {
+      return MHAS_FEED_MORE_DATA;
+    }
+
+    // an MPEG-H frame exceeding the maximum size indicates a broken packet structure
+    uint64_t packetEnd = (uint64_t)h->parseIndex + headerLength + packetLength;
+    if (packetEnd - h->auStartIndex > MHAS_MAX_AU_SIZE) {
+      loseSync(h);
+      continue;
+    }
+    if (packetEnd > h->workBufferBytesAvailable) {
+      return MHAS_FEED_MORE_DATA;
+    }
+
+    const uint8_t* payload = &h->workBuffer[h->parseIndex + headerLength];
+    if (packetType == MHAS_PACTYP_SYNC && (packetLength != 1 || payload[0] != MHAS_SYNC_WORD)) {
+      loseSync(h);
+      continue;
+    }
+
+    if (packetType == MHAS_PACTYP_MPEGH3DAFRAME) {
+      uint32_t auLength = (uint32_t)packetEnd - h->auStartIndex;
+      if (h->frameDuration > 0) {
+        if (auLength > outputBufferLength) {
+          return MHAS_BUFFER_ERROR;
+        }
+        memcpy(outputBuffer, h->workBuffer + h->auStartIndex, auLength);
+        *pOutputBufferLength = auLength;
+        *pFrameDuration = h->frameDuration;
+      }
+      // MPEG-H frames without a preceding configuration are skipped
+      h->auStartIndex = (uint32_t)packetEnd;
+      h->parseIndex = (uint32_t)packetEnd;
+      if (*pOutputBufferLength > 0) {
+        return MHAS_OK;
+      }
+      continue;
+    }
+
+    if (packetType == MHAS_PACTYP_MPEGH3DACFG) {
+      h->frameDuration = parseConfig(payload, packetLength);
+    }
+    h->parseIndex = (uint32_t)packetEnd;
+  }
+}
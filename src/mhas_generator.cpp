@@ -0,0 +1,350 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+#include "mhas_generator.h"
+#include "mhas_common.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Packet label of the MPEGH3DACFG and MPEGH3DAFRAME packets
+#define MHAS_GEN_PACKET_LABEL 1
+// usacSamplingFrequencyIndex of 48 kHz according to ISO/IEC 23003-3 Table 68
+#define MHAS_GEN_SAMPLING_FREQUENCY_INDEX 3
+#define MHAS_GEN_SAMPLE_RATE 48000
+// CICPspeakerLayoutIdx of the configuration (mono)
+#define MHAS_GEN_SPEAKER_LAYOUT 1
+// Size of the mpegh3daConfig() payload of the MPEGH3DACFG packet
+#define MHAS_GEN_CONFIG_PAYLOAD_SIZE 8
+// Size of the SYNC packet and the MPEGH3DACFG packet preceding the frame packet of a RAP frame
+#define MHAS_GEN_RAP_OVERHEAD (3 + 2 + MHAS_GEN_CONFIG_PAYLOAD_SIZE)
+// Largest MHAS packet length which can be signaled with an 11 bit packet length field
+#define MHAS_GEN_MAX_SHORT_PACKET_LENGTH 2046
+// Size of an MHAS packet header with a short and an escaped packet length
+#define MHAS_GEN_SHORT_HEADER_SIZE 2
+#define MHAS_GEN_LONG_HEADER_SIZE 5
+// Smallest supported value of maxAuSize
+#define MHAS_GEN_MIN_MAX_AU_SIZE 64
+
+struct mhas_generator_state {
+  MHAS_GEN_CONFIG config;
+  uint32_t maxAuSize;
+  uint32_t randomState;
+  uint64_t frameIndex;
+  uint32_t durationIndex;
+} mhas_generator_state;
+
+typedef struct SBitWriter {
+  uint8_t* data;
+  uint32_t bitIndex;
+} SBitWriter;
+
+// Writes numBits of value MSB first; the written bytes have to be zero-initialized.
+static void writeBits(SBitWriter* writer, uint32_t numBits, uint32_t value) {
+  for (uint32_t i = 0; i < numBits; i++) {
+    uint32_t bit = (value >> (numBits - 1 - i)) & 1;
+    writer->data[writer->bitIndex >> 3] |= (uint8_t)(bit << (7 - (writer->bitIndex & 7)));
+    writer->bitIndex++;
+  }
+}
+
+// escapedValue() according to ISO/IEC 23008-3 Table 5
+static void writeEscapedValue(SBitWriter* writer, uint32_t nBits1, uint32_t nBits2,
+                              uint32_t nBits3, uint32_t value) {
+  uint32_t escape1 = (1u << nBits1) - 1;
+  if (value < escape1) {
+    writeBits(writer, nBits1, value);
+    return;
+  }
+  writeBits(writer, nBits1, escape1);
+  value -= escape1;
+  uint32_t escape2 = (1u << nBits2) - 1;
+  if (value < escape2) {
+    writeBits(writer, nBits2, value);
+    return;
+  }
+  writeBits(writer, nBits2, escape2);
+  writeBits(writer, nBits3, value - escape2);
+}
+
+// Writes an MHAS packet header and returns its size in bytes.
+static uint32_t writePacketHeader(uint8_t* data, uint32_t packetType, uint32_t packetLabel,
+                                  uint32_t packetLength) {
+  uint8_t header[MHAS_MAX_PACKET_HEADER_SIZE] = {0};
+  SBitWriter writer = {header, 0};
+  writeEscapedValue(&writer, 3, 8, 8, packetType);
+  writeEscapedValue(&writer, 2, 8, 32, packetLabel);
+  writeEscapedValue(&writer, 11, 24, 24, packetLength);
+  uint32_t headerLength = (writer.bitIndex + 7) / 8;
+  memcpy(data, header, headerLength);
+  return headerLength;
+}
+
+// Returns the coreSbrFrameLengthIndex according to ISO/IEC 23008-3 Table 73 or -1 for unsupported
+// frame durations.
+static int32_t getCoreSbrFrameLengthIndex(uint32_t frameDuration) {
+  switch (frameDuration) {
+    case 768:
+      return 0;
+    case 1024:
+      return 1;
+    case 2048:
+      // 2:1 SBR
+      return 3;
+    case 4096:
+      return 4;
+    default:
+      return -1;
+  }
+}
+
+// Small deterministic generator, so the same configuration always results in the same stream.
+static uint32_t nextRandom(HANDLE_MHAS_GENERATOR h) {
+  h->randomState = h->randomState * 1664525u + 1013904223u;
+  return h->randomState >> 8;
+}
+
+// Returns the size of the next MPEG-H frame including all MHAS packets.
+static uint32_t drawFrameSize(HANDLE_MHAS_GENERATOR h, uint32_t frameDuration, bool isRap) {
+  const MHAS_GEN_CONFIG* config = &h->config;
+  double mean = (double)config->bitrate * frameDuration / (8.0 * MHAS_GEN_SAMPLE_RATE);
+  double size = mean;
+  switch (config->sizes) {
+    case MHAS_GEN_SIZES_CBR:
+      break;
+    case MHAS_GEN_SIZES_UNIFORM: {
+      // uniform within mean +/- deviation; nextRandom() provides 24 bits
+      double deviation = mean * config->variation / 100.0;
+      size = mean - deviation + 2.0 * deviation * nextRandom(h) / (double)(1u << 24);
+      break;
+    }
+    case MHAS_GEN_SIZES_EXPONENTIAL:
+      size = -mean * log((nextRandom(h) + 1.0) / (double)((1u << 24) + 1));
+      break;
+    case MHAS_GEN_SIZES_PEAK:
+      size = h->maxAuSize;
+      break;
+  }
+  if (isRap && config->sizes != MHAS_GEN_SIZES_PEAK) {
+    size = size * config->rapSizeFactor / 100.0;
+  }
+
+  uint32_t minSize = (isRap ? MHAS_GEN_RAP_OVERHEAD : 0) + MHAS_GEN_SHORT_HEADER_SIZE + 1;
+  uint32_t frameSize = (size > h->maxAuSize) ? h->maxAuSize : (uint32_t)(size + 0.5);
+  if (frameSize < minSize) {
+    frameSize = minSize;
+  }
+
+  // frame packets of 2047 to 2051 bytes cannot be built: the payload length needs an escaped
+  // packet length field from 2047 bytes on
+  uint32_t framePacketSize = frameSize - (isRap ? MHAS_GEN_RAP_OVERHEAD : 0);
+  uint32_t maxShortPacketSize = MHAS_GEN_SHORT_HEADER_SIZE + MHAS_GEN_MAX_SHORT_PACKET_LENGTH;
+  uint32_t minLongPacketSize = MHAS_GEN_LONG_HEADER_SIZE + MHAS_GEN_MAX_SHORT_PACKET_LENGTH + 1;
+  if (framePacketSize > maxShortPacketSize && framePacketSize < minLongPacketSize) {
+    if (frameSize + (minLongPacketSize - framePacketSize) <= h->maxAuSize) {
+      frameSize += minLongPacketSize - framePacketSize;
+    } else {
+      frameSize -= framePacketSize - maxShortPacketSize;
+    }
+  }
+  return frameSize;
+}
+
+void mhas_generator_config_init(MHAS_GEN_CONFIG* config) {
+  if (config == NULL) {
+    return;
+  }
+  memset(config, 0, sizeof(MHAS_GEN_CONFIG));
+  config->bitrate = 256000;
+  config->sizes = MHAS_GEN_SIZES_CBR;
+  config->variation = 50;
+  config->maxAuSize = MHAS_MAX_AU_SIZE;
+  config->rapInterval = 32;
+  config->rapSizeFactor = 100;
+  config->frameDurations[0] = 1024;
+  config->numFrameDurations = 1;
+  config->profileLevelIndication = MHAS_GEN_DEFAULT_PROFILE_LEVEL;
+  config->seed = 0;
+}
+
+HANDLE_MHAS_GENERATOR mhas_generator_open(const MHAS_GEN_CONFIG* config) {
+  if (config == NULL) {
+    return NULL;
+  }
+  uint32_t maxAuSize = (config->maxAuSize == 0) ? MHAS_MAX_AU_SIZE : config->maxAuSize;
+  if (maxAuSize > MHAS_MAX_AU_SIZE || maxAuSize < MHAS_GEN_MIN_MAX_AU_SIZE ||
+      config->variation > 100 || config->sizes > MHAS_GEN_SIZES_PEAK ||
+      config->numFrameDurations == 0 ||
+      config->numFrameDurations > MHAS_GEN_MAX_FRAME_DURATIONS) {
+    return NULL;
+  }
+  for (uint32_t i = 0; i < config->numFrameDurations; i++) {
+    if (getCoreSbrFrameLengthIndex(config->frameDurations[i]) < 0) {
+      return NULL;
+    }
+  }
+
+  HANDLE_MHAS_GENERATOR h = (HANDLE_MHAS_GENERATOR)calloc(1, sizeof(mhas_generator_state));
+  if (h == NULL) {
+    return NULL;
+  }
+  h->config = *config;
+  h->maxAuSize = maxAuSize;
+  h->randomState = config->seed;
+  return h;
+}
+
+void mhas_generator_close(HANDLE_MHAS_GENERATOR h) {
+  free(h);
+}
+
+MHAS_RESULT mhas_generator_process(HANDLE_MHAS_GENERATOR h, uint8_t* outputBuffer,
+                                   uint32_t* pOutputBufferLength, uint32_t* pFrameDuration,
+                                   bool* pIsRap) {
+  if (h == NULL || outputBuffer == NULL || pOutputBufferLength == NULL ||
+      pFrameDuration == NULL || pIsRap == NULL) {
+    return MHAS_NULLPTR_ERROR;
+  }
+  uint32_t outputBufferLength = *pOutputBufferLength;
+  *pOutputBufferLength = 0;
+  *pFrameDuration = 0;
+  *pIsRap = false;
+
+  bool isRap = (h->frameIndex == 0) ||
+               (h->config.rapInterval > 0 && h->frameIndex % h->config.rapInterval == 0);
+  uint32_t durationIndex = h->durationIndex;
+  if (isRap && h->frameIndex > 0) {
+    // the frame duration can only change with a new configuration
+    durationIndex = (durationIndex + 1) % h->config.numFrameDurations;
+  }
+  uint32_t frameDuration = h->config.frameDurations[durationIndex];
+
+  // the random state is restored if the frame does not fit into the output buffer
+  uint32_t randomState = h->randomState;
+  uint32_t frameSize = drawFrameSize(h, frameDuration, isRap);
+  if (frameSize > outputBufferLength) {
+    h->randomState = randomState;
+    return MHAS_BUFFER_ERROR;
+  }
+
+  uint8_t* data = outputBuffer;
+  if (isRap) {
+    // SYNC packet
+    data += writePacketHeader(data, MHAS_PACTYP_SYNC, 0, 1);
+    *data++ = MHAS_SYNC_WORD;
+
+    // MPEGH3DACFG packet; mpegh3daConfig() up to the speaker configuration
+    data += writePacketHeader(data, MHAS_PACTYP_MPEGH3DACFG, MHAS_GEN_PACKET_LABEL,
+                              MHAS_GEN_CONFIG_PAYLOAD_SIZE);
+    memset(data, 0, MHAS_GEN_CONFIG_PAYLOAD_SIZE);
+    SBitWriter writer = {data, 0};
+    writeBits(&writer, 8, h->config.profileLevelIndication);
+    writeBits(&writer, 5, MHAS_GEN_SAMPLING_FREQUENCY_INDEX);
+    writeBits(&writer, 3, (uint32_t)getCoreSbrFrameLengthIndex(frameDuration));
+    writeBits(&writer, 1, 0);  // cfg_reserved
+    writeBits(&writer, 1, 0);  // receiverDelayCompensation
+    writeBits(&writer, 2, 0);  // speakerLayoutType
+    writeBits(&writer, 6, MHAS_GEN_SPEAKER_LAYOUT);
+    data += MHAS_GEN_CONFIG_PAYLOAD_SIZE;
+  }
+
+  // MPEGH3DAFRAME packet
+  uint32_t framePacketSize = frameSize - (uint32_t)(data - outputBuffer);
+  uint32_t payloadLength = framePacketSize - MHAS_GEN_SHORT_HEADER_SIZE;
+  if (payloadLength > MHAS_GEN_MAX_SHORT_PACKET_LENGTH) {
+    payloadLength = framePacketSize - MHAS_GEN_LONG_HEADER_SIZE;
+  }
+  data += writePacketHeader(data, MHAS_PACTYP_MPEGH3DAFRAME, MHAS_GEN_PACKET_LABEL, payloadLength);
+  for (uint32_t i = 0; i < payloadLength; i++) {
+    data[i] = (uint8_t)(nextRandom(h) >> 16);
+  }
+  // usacIndependencyFlag
+  data[0] = (uint8_t)((data[0] & 0x7F) | (isRap ? 0x80 : 0x00));
+
+  h->durationIndex = durationIndex;
+  h->frameIndex++;
+  *pOutputBufferLength = frameSize;
+  *pFrameDuration = frameDuration;
+  *pIsRap = isRap;
+  return MHAS_OK;
+}
@@ -0,0 +1,329 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// system includes
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// project includes
+#include "iec61937_dec.h"
+#include "iec61937_enc.h"
+
+/*
+ * Round trip tests of audio mode 0 (rate factor 1, 6-byte payload headers, Pd in bytes): MPEG-H
+ * frames are encoded with every IEC frame length and decoded again, once with frames fitting into
+ * an IEC frame and once with frames spread over several IEC frames. The frame sizes follow the peak
+ * bit rate of iec61937_encode_get_min_rate_factor(). The decoded frames and their reconstructed PTS
+ * have to match the encoded ones. MPEG-H frames larger than 65535 bytes cannot be signaled in audio
+ * mode 0 and have to be rejected. Exits with 1 if a test fails.
+ */
+
+// Number of MPEG-H frames per round trip.
+#define NUM_AUS 200
+
+// Size in bytes of the chunks fed into the decoder; not a multiple of any IEC frame size.
+#define FEED_CHUNK_SIZE 1111
+
+// Largest MPEG-H frame which can be signaled in audio mode 0.
+#define MAX_AU_SIZE_AUDIOMODE_0 65535
+
+// Largest MPEG-H frame duration accepted by the encoder.
+#define MAX_MPEGH_FRAME_DURATION 4096
+
+static const uint32_t frameLengths[] = {768, 1024, 1536, 2048, 3072, 4096};
+
+// MPEG-H frame durations; every IEC frame length is not a multiple of at least one of them.
+static const uint32_t durations[] = {1024, 1536};
+
+static uint32_t g_random = 1;
+
+static uint32_t getRandom() {
+  g_random = g_random * 1664525u + 1013904223u;
+  return g_random >> 8;
+}
+
+static std::vector<uint8_t> createAu(uint32_t size) {
+  std::vector<uint8_t> au(size);
+  for (uint32_t i = 0; i < size; i++) {
+    au[i] = (uint8_t)getRandom();
+  }
+  return au;
+}
+
+static bool encode(HANDLE_IEC61937_ENCODER encoder, const std::vector<std::vector<uint8_t>>& aus,
+                   uint32_t duration, std::vector<uint8_t>& stream) {
+  std::vector<uint8_t> iecFrame(MAX_IEC61937_FRAME_SIZE_BYTES);
+  for (size_t i = 0; i < aus.size(); i++) {
+    bool processed = false;
+    while (!processed) {
+      uint32_t length = (uint32_t)iecFrame.size();
+      if (iec61937_encode_process(encoder, aus[i].data(), (uint32_t)aus[i].size(), &processed,
+                                  duration, iecFrame.data(), &length) != IECENC_OK) {
+        fprintf(stderr, "encoding MPEG-H frame %zu failed\n", i);
+        return false;
+      }
+      stream.insert(stream.end(), iecFrame.begin(), iecFrame.begin() + length);
+    }
+  }
+  while (true) {
+    uint32_t length = (uint32_t)iecFrame.size();
+    if (iec61937_encode_flush(encoder, iecFrame.data(), &length) != IECENC_OK) {
+      fprintf(stderr, "flushing the encoder failed\n");
+      return false;
+    }
+    if (length == 0) {
+      return true;
+    }
+    stream.insert(stream.end(), iecFrame.begin(), iecFrame.begin() + length);
+  }
+}
+
+static bool decode(const std::vector<uint8_t>& stream,
+                   const std::vector<std::vector<uint8_t>>& aus, uint32_t duration) {
+  HANDLE_IEC61937_DECODER decoder = iec61937_decode_open();
+  if (decoder == NULL) {
+    fprintf(stderr, "opening the decoder failed\n");
+    return false;
+  }
+  std::vector<uint8_t> au(MAX_MPEGH_FRAME_SIZE);
+  size_t numDecoded = 0;
+  int64_t iecFramePts = 0;
+  int64_t firstPts = 0;
+  bool success = true;
+  size_t position = 0;
+  while (success && position < stream.size()) {
+    uint32_t chunkLength = (uint32_t)std::min<size_t>(FEED_CHUNK_SIZE, stream.size() - position);
+    if (iec61937_decode_feed(decoder, stream.data() + position, chunkLength) != IECDEC_OK) {
+      fprintf(stderr, "feeding the decoder failed\n");
+      success = false;
+      break;
+    }
+    position += chunkLength;
+    while (true) {
+      uint32_t length = (uint32_t)au.size();
+      int32_t pcmOffset = 0;
+      uint32_t iecFrameLength = 0;
+      bool iecFrameProcessed = false;
+      IECDEC_RESULT result = iec61937_decode_process(decoder, au.data(), &length, &pcmOffset,
+                                                     &iecFrameLength, &iecFrameProcessed);
+      if (result == IECDEC_FEED_MORE_DATA) {
+        break;
+      }
+      if (result != IECDEC_OK) {
+        fprintf(stderr, "decoding failed with %d\n", (int)result);
+        success = false;
+        break;
+      }
+      if (length > 0) {
+        if (numDecoded == 0) {
+          firstPts = iecFramePts + pcmOffset;
+        }
+        if (numDecoded >= aus.size() || length != aus[numDecoded].size() ||
+            memcmp(au.data(), aus[numDecoded].data(), length) != 0) {
+          fprintf(stderr, "MPEG-H frame %zu differs\n", numDecoded);
+          success = false;
+          break;
+        }
+        if (iecFramePts + pcmOffset - firstPts != (int64_t)(numDecoded * duration)) {
+          fprintf(stderr, "PTS of MPEG-H frame %zu differs\n", numDecoded);
+          success = false;
+          break;
+        }
+        numDecoded++;
+      }
+      if (iecFrameProcessed) {
+        iecFramePts += iecFrameLength;
+      }
+    }
+  }
+  iec61937_decode_close(decoder);
+  if (success && numDecoded != aus.size()) {
+    fprintf(stderr, "decoded %zu of %zu MPEG-H frames\n", numDecoded, aus.size());
+    success = false;
+  }
+  return success;
+}
+
+// Largest MPEG-H frame for which rate factor 1 (audio mode 0) still carries the peak bit rate.
+static uint32_t getMaxAuSize(uint32_t audioFrameLength, uint32_t duration) {
+  uint32_t low = 0;
+  uint32_t high = audioFrameLength * IEC60958_FRAME_SIZE_BYTES;
+  while (low < high) {
+    uint32_t size = (low + high + 1) / 2;
+    if (iec61937_encode_get_min_rate_factor(audioFrameLength, size, duration) == 1) {
+      low = size;
+    } else {
+      high = size - 1;
+    }
+  }
+  return low;
+}
+
+// Round trip of MPEG-H frames with the given duration. Large frames have random sizes between half
+// and all of the peak size; they are split if the duration does not divide the IEC frame length.
+// Small frames are at most a quarter of the peak size and are never split.
+static bool testRoundTrip(uint32_t audioFrameLength, uint32_t duration, bool largeFrames) {
+  uint32_t maxAuSize = getMaxAuSize(audioFrameLength, duration);
+  uint32_t minAuSize = largeFrames ? maxAuSize / 2 : 1;
+  if (!largeFrames) {
+    maxAuSize /= 4;
+  }
+  printf("round trip: frame length %u, duration %u, MPEG-H frames of %u to %u bytes\n",
+         audioFrameLength, duration, minAuSize, maxAuSize);
+  IEC61937_ENC_CONFIG config;
+  iec61937_encode_config_init(&config);
+  config.rateFactor = 1;
+  config.audioFrameLength = audioFrameLength;
+  HANDLE_IEC61937_ENCODER encoder = iec61937_encode_open_config(&config);
+  if (encoder == NULL) {
+    fprintf(stderr, "opening the encoder failed\n");
+    return false;
+  }
+  std::vector<std::vector<uint8_t>> aus;
+  for (uint32_t i = 0; i < NUM_AUS; i++) {
+    aus.push_back(createAu(minAuSize + getRandom() % (maxAuSize - minAuSize + 1)));
+  }
+  std::vector<uint8_t> stream;
+  bool success = encode(encoder, aus, duration, stream);
+  IEC61937_ENC_STATS stats;
+  iec61937_encode_get_stats(encoder, &stats);
+  iec61937_encode_close(encoder);
+  bool expectSplit = largeFrames && (audioFrameLength % duration) != 0;
+  if (success && (stats.numSplitAus > 0) != expectSplit) {
+    fprintf(stderr, "%llu MPEG-H frames were split\n", (unsigned long long)stats.numSplitAus);
+    success = false;
+  }
+  return success && decode(stream, aus, duration);
+}
+
+static bool testOversizedAu() {
+  printf("rejection of MPEG-H frames larger than %u bytes\n", MAX_AU_SIZE_AUDIOMODE_0);
+  if (iec61937_encode_get_min_rate_factor(IEC61937_AUDIOFRAME_LENGTH, MAX_AU_SIZE_AUDIOMODE_0 + 1,
+                                          MAX_MPEGH_FRAME_DURATION) == 1) {
+    fprintf(stderr, "audio mode 0 selected for oversized MPEG-H frames\n");
+    return false;
+  }
+  HANDLE_IEC61937_ENCODER encoder = iec61937_encode_open(1);
+  if (encoder == NULL) {
+    fprintf(stderr, "opening the encoder failed\n");
+    return false;
+  }
+  std::vector<uint8_t> iecFrame(MAX_IEC61937_FRAME_SIZE_BYTES);
+  std::vector<uint8_t> au = createAu(MAX_AU_SIZE_AUDIOMODE_0 + 1);
+  bool processed = false;
+  uint32_t length = (uint32_t)iecFrame.size();
+  IECENC_RESULT oversizedResult =
+      iec61937_encode_process(encoder, au.data(), (uint32_t)au.size(), &processed,
+                              IEC61937_AUDIOFRAME_LENGTH, iecFrame.data(), &length);
+  // the largest MPEG-H frame which can be signaled is still accepted
+  length = (uint32_t)iecFrame.size();
+  IECENC_RESULT largestResult =
+      iec61937_encode_process(encoder, au.data(), MAX_AU_SIZE_AUDIOMODE_0, &processed,
+                              IEC61937_AUDIOFRAME_LENGTH, iecFrame.data(), &length);
+  iec61937_encode_close(encoder);
+  if (oversizedResult != IECENC_BUFFER_ERROR) {
+    fprintf(stderr, "oversized MPEG-H frame not rejected (result %d)\n", (int)oversizedResult);
+    return false;
+  }
+  if (largestResult != IECENC_OK || !processed) {
+    fprintf(stderr, "MPEG-H frame of %u bytes rejected (result %d)\n", MAX_AU_SIZE_AUDIOMODE_0,
+            (int)largestResult);
+    return false;
+  }
+  return true;
+}
+
+int main() {
+  uint32_t numFailed = 0;
+  for (size_t i = 0; i < sizeof(frameLengths) / sizeof(frameLengths[0]); i++) {
+    for (size_t j = 0; j < sizeof(durations) / sizeof(durations[0]); j++) {
+      numFailed += testRoundTrip(frameLengths[i], durations[j], false) ? 0 : 1;
+      numFailed += testRoundTrip(frameLengths[i], durations[j], true) ? 0 : 1;
+    }
+  }
+  numFailed += testOversizedAu() ? 0 : 1;
+
+  printf("%u tests failed\n", numFailed);
+  return (numFailed > 0) ? 1 : 0;
+}
@@ -0,0 +1,183 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2018 - 2023 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// system includes
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+// project includes
+#include "sparse_file_writer.h"
+
+/*
+ * Read back test of the sparse output file writer of the encoder demo: data with zero runs of
+ * various lengths and alignments, including a trailing zero run, is written in chunks of random
+ * sizes, once in sparse mode and once regularly. Both files have to read back byte-identical to
+ * the written data, and the sparse file has to skip the zero blocks. Exits with 1 if a test fails.
+ */
+
+// Number of data and zero runs of the written data.
+#define NUM_RUNS 64
+
+// Largest chunk passed to a single write() call.
+#define MAX_CHUNK_SIZE (3 * SPARSE_FILE_BLOCK_SIZE)
+
+static uint32_t g_random = 1;
+
+static uint32_t getRandom() {
+  g_random = g_random * 1664525u + 1013904223u;
+  return g_random >> 8;
+}
+
+static std::vector<uint8_t> createData() {
+  std::vector<uint8_t> data;
+  for (uint32_t run = 0; run < NUM_RUNS; run++) {
+    // zero runs from a few bytes to several blocks, at any alignment
+    uint32_t length = 1 + getRandom() % (4 * SPARSE_FILE_BLOCK_SIZE);
+    for (uint32_t i = 0; i < length; i++) {
+      data.push_back((run % 2 == 0) ? (uint8_t)(1 + getRandom() % 255) : 0);
+    }
+  }
+  // a trailing hole has to be created by setting the file size
+  data.insert(data.end(), 2 * SPARSE_FILE_BLOCK_SIZE + 100, 0);
+  return data;
+}
+
+static bool writeFile(const std::string& filename, bool sparse, const std::vector<uint8_t>& data,
+                      uint64_t* pHoleBytes) {
+  CSparseFileWriter writer(filename, sparse);
+  if (!writer.good()) {
+    fprintf(stderr, "cannot open %s\n", filename.c_str());
+    return false;
+  }
+  size_t position = 0;
+  while (position < data.size()) {
+    size_t length = std::min<size_t>(1 + getRandom() % MAX_CHUNK_SIZE, data.size() - position);
+    writer.write(data.data() + position, length);
+    position += length;
+  }
+  *pHoleBytes = writer.holeBytes();
+  if (!writer.close()) {
+    fprintf(stderr, "cannot close %s\n", filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+static bool testReadBack(bool sparse) {
+  const std::string filename = sparse ? "sparse_file_writer_sparse.bin"
+                                      : "sparse_file_writer_regular.bin";
+  printf("read back: %s file\n", sparse ? "sparse" : "regular");
+  std::vector<uint8_t> data = createData();
+  uint64_t holeBytes = 0;
+  bool success = writeFile(filename, sparse, data, &holeBytes);
+  if (success) {
+    std::ifstream file(filename, std::ios::in | std::ios::binary);
+    std::vector<uint8_t> readData((std::istreambuf_iterator<char>(file)),
+                                  std::istreambuf_iterator<char>());
+    if (readData != data) {
+      fprintf(stderr, "read %zu bytes which differ from the %zu written bytes\n", readData.size(),
+              data.size());
+      success = false;
+    }
+  }
+  // only POSIX systems support sparse files
+  bool expectHoles = sparse && SPARSE_FILE_POSIX;
+  if (success && (holeBytes > 0) != expectHoles) {
+    fprintf(stderr, "%llu bytes skipped as file holes\n", (unsigned long long)holeBytes);
+    success = false;
+  }
+  std::remove(filename.c_str());
+  return success;
+}
+
+int main() {
+  uint32_t numFailed = 0;
+  numFailed += testReadBack(true) ? 0 : 1;
+  numFailed += testReadBack(false) ? 0 : 1;
+
+  printf("%u tests failed\n", numFailed);
+  return (numFailed > 0) ? 1 : 0;
+}